@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BITBANG_H
+#define MBED_BITBANG_H
+
+#include "platform.h"
+#include "DigitalIn.h"
+#include "DigitalOut.h"
+#include "DigitalInOut.h"
+
+namespace mbed {
+
+/** A calibrated busy-wait delay with sub-microsecond resolution, for bit-banged buses
+ *
+ * wait_us() has a resolution of a microsecond and the overhead of reading the ticker, which is too coarse for the
+ * 1.25us half period of a 400kHz I2C clock. BitBangDelay spins a loop instead; the loop is timed against the
+ * us_ticker the first time it is used, so that the delays are right whatever the core clock. Converting nanoseconds to
+ * loops takes a 64-bit divide, which is slow on cores without a divider, so the bit-banged engines convert their half
+ * period once, with loops(), when the frequency is set, and only spin() while clocking bits.
+ */
+class BitBangDelay {
+public:
+    /** Wait for at least ns nanoseconds
+     */
+    static void ns(uint32_t ns) {
+        spin(loops(ns));
+    }
+
+    /** The number of loops of spin() that take at least ns nanoseconds; at least 1
+     */
+    static uint32_t loops(uint32_t ns) {
+        if (!_loops_per_ms) {
+            calibrate();
+        }
+        uint32_t n = (uint32_t)(((uint64_t)ns * _loops_per_ms) / 1000000);
+        return n ? n : 1;
+    }
+
+    /** Spin for a number of loops from loops()
+     */
+    static void spin(uint32_t loops) {
+        for (volatile uint32_t i = loops; i; i--) {
+        }
+    }
+
+    /** Time the delay loop against the us_ticker
+     */
+    static void calibrate();
+
+protected:
+    static uint32_t _loops_per_ms;
+};
+
+/** The lines of a bit-banged I2C bus on GPIO
+ *
+ * The lines are open drain: a low level is driven, and a high level is produced by releasing the line to its
+ * pull-up, so that a slave can stretch the clock and drive SDA.
+ */
+class BitBangI2CPins {
+public:
+    BitBangI2CPins(PinName sda, PinName scl) : _sda(sda, PIN_INPUT, PullUp, 0), _scl(scl, PIN_INPUT, PullUp, 0) {
+        // Only the direction changes from now on; the output latch stays low
+        _sda.write(0);
+        _scl.write(0);
+    }
+
+    void sda(int level) {
+        if (level) {
+            _sda.input();
+        } else {
+            _sda.output();
+        }
+    }
+
+    int sda() {
+        return _sda.read();
+    }
+
+    void scl(int level) {
+        if (level) {
+            _scl.input();
+        } else {
+            _scl.output();
+        }
+    }
+
+    int scl() {
+        return _scl.read();
+    }
+
+    uint32_t delay_count(uint32_t ns) {
+        return BitBangDelay::loops(ns);
+    }
+
+    void delay(uint32_t count) {
+        BitBangDelay::spin(count);
+    }
+
+protected:
+    DigitalInOut _sda;
+    DigitalInOut _scl;
+};
+
+/** The lines of a bit-banged SPI bus on GPIO
+ *
+ * Either of mosi and miso may be NC.
+ */
+class BitBangSPIPins {
+public:
+    BitBangSPIPins(PinName mosi, PinName miso, PinName sclk) : _mosi(mosi), _miso(miso), _sclk(sclk) {}
+
+    void mosi(int level) {
+        _mosi.write(level);
+    }
+
+    int miso() {
+        return _miso.read();
+    }
+
+    void sclk(int level) {
+        _sclk.write(level);
+    }
+
+    uint32_t delay_count(uint32_t ns) {
+        return BitBangDelay::loops(ns);
+    }
+
+    void delay(uint32_t count) {
+        BitBangDelay::spin(count);
+    }
+
+protected:
+    DigitalOut _mosi;
+    DigitalIn _miso;
+    DigitalOut _sclk;
+};
+
+} // namespace mbed
+
+#endif
@@ -78,6 +78,17 @@ public:
         return _full;
     }
 
+    /** Get the number of elements in the buffer
+     *
+     * @return The number of elements pushed and not yet popped
+     */
+    CounterType size() {
+        if (_full) {
+            return BufferSize;
+        }
+        return (_head >= _tail) ? _head - _tail : BufferSize + _head - _tail;
+    }
+
     /** Reset the buffer
      *
      */
@@ -20,6 +20,7 @@
 typedef int FILEHANDLE;
 
 #include <stdio.h>
+#include <stdint.h>
 
 #if defined(__ARMCC_VERSION) || defined(__ICCARM__)
 #    define O_RDONLY 0
@@ -50,6 +51,25 @@ typedef enum {
     FileSystemPathType
 } PathType;
 
+class FileBase;
+
+/** A position in the list of named FileBase objects
+ *
+ *  Each named object receives a unique, monotonically increasing id when it
+ *  is created. A cursor remembers the id of the last object it returned and
+ *  a pointer to the next one; the pointer is only trusted while no object
+ *  has been removed from the list since it was taken (tracked by the list
+ *  generation). Iteration is therefore O(1) per step, and objects created
+ *  or destroyed during an iteration are never returned twice.
+ *
+ *  A zero-initialised cursor is positioned at the start of the list.
+ */
+struct FileBaseCursor {
+    FileBase *next;         /**< The object to return next, valid while generation matches */
+    uint32_t  id;           /**< The id of the last object returned, or 0 at the start */
+    uint32_t  generation;   /**< The list generation at which next was taken */
+};
+
 class FileBase {
 public:
     FileBase(const char *name, PathType t);
@@ -63,12 +83,34 @@ public:
 
     static FileBase *get(int n);
 
+    /** Return the next named object and advance the cursor
+     *
+     *  Objects are returned newest first. Objects created after the cursor
+     *  was started are not returned.
+     *
+     *  @param cursor The iteration state
+     *
+     *  @returns
+     *    the next object, or NULL at the end of the list
+     */
+    static FileBase *iterate(FileBaseCursor &cursor);
+
+    /** Get the unique id of this object
+     *
+     *  @returns
+     *    the id of a named object, or 0 if the object is not named
+     */
+    uint32_t getId(void);
+
 protected:
     static FileBase *_head;
+    static uint32_t  _last_id;
+    static uint32_t  _generation;
 
     FileBase   *_next;
     const char *_name;
     PathType    _path_type;
+    uint32_t    _id;
 
     /* disallow copy constructor and assignment operators */
 private:
@@ -29,6 +29,17 @@ typedef long off_t;
 #   include <sys/types.h>
 #endif
 
+#include "Buffer.h"
+#include "core-util/FunctionPointer.h"
+
+#ifndef POLLIN
+#   define POLLIN   0x0001  /**< Data may be read without blocking */
+#   define POLLOUT  0x0004  /**< Data may be written without blocking */
+#   define POLLERR  0x0008  /**< An error has occurred */
+#   define POLLHUP  0x0010  /**< The device has been disconnected */
+#   define POLLNVAL 0x0020  /**< The file descriptor is not open */
+#endif
+
 namespace mbed {
 
 /** An OO equivalent of the internal FILEHANDLE variable
@@ -43,6 +54,12 @@ namespace mbed {
 class FileHandle {
 
 public:
+    /** Completion callback for read_async and write_async; it is called with
+     *  the buffer that was passed in and the result the synchronous call
+     *  would have returned.
+     */
+    typedef mbed::util::FunctionPointer2<void, Buffer, ssize_t> io_callback_t;
+
     /** Write the contents of a buffer to the file
      *
      *  @param buffer the buffer to write from
@@ -112,6 +129,96 @@ public:
         return res;
     }
 
+    /** Map a region of the file into memory for reading
+     *
+     *  Backends that keep their contents in addressable memory may return a
+     *  pointer directly into it. The default implementation reads the
+     *  region into a heap-allocated window, leaving the file position
+     *  unchanged.
+     *
+     *  @param offset The offset of the region in the file
+     *  @param length The length of the region in bytes
+     *
+     *  @returns
+     *    a pointer to the contents of the region on success,
+     *    NULL on failure or unsupported
+     */
+    virtual const void *mmap(off_t offset, size_t length);
+
+    /** Release a region returned by mmap
+     *
+     *  @param addr The pointer returned by mmap
+     *  @param length The length passed to mmap
+     *
+     *  @returns
+     *    0 on success,
+     *   -1 on error
+     */
+    virtual int munmap(const void *addr, size_t length);
+
+    /** Start reading the contents of the file into a buffer
+     *
+     *  The callback is posted to the scheduler when the read completes. The
+     *  default implementation performs a synchronous read and posts its
+     *  result; backends on slow devices override this to overlap the
+     *  transfer with other work.
+     *
+     *  @param buffer the buffer to read in to; it must remain valid until
+     *    the callback is called
+     *  @param length the number of characters to read
+     *  @param callback the completion callback
+     *
+     *  @returns
+     *    0 if the read was started,
+     *   -1 if it could not be started, in which case the callback is not called
+     */
+    virtual int read_async(void *buffer, size_t length, const io_callback_t &callback);
+
+    /** Start writing the contents of a buffer to the file
+     *
+     *  @param buffer the buffer to write from; it must remain valid until
+     *    the callback is called
+     *  @param length the number of characters to write
+     *  @param callback the completion callback
+     *
+     *  @returns
+     *    0 if the write was started,
+     *   -1 if it could not be started, in which case the callback is not called
+     */
+    virtual int write_async(const void *buffer, size_t length, const io_callback_t &callback);
+
+    /** Check which of the requested events are ready, without blocking
+     *
+     *  Handles that can always be read and written, like ordinary files,
+     *  use the default implementation, which reports every requested
+     *  event as ready.
+     *
+     *  @param events a mask of POLLIN and POLLOUT
+     *
+     *  @returns
+     *    the mask of ready events, which may also include POLLERR and POLLHUP
+     */
+    virtual short poll(short events) {
+        return events & (POLLIN | POLLOUT);
+    }
+
+    /** Register a callback for changes in readiness
+     *
+     *  The callback may be called from interrupt context whenever poll()
+     *  might return a different result; it is a hint, so the new state must
+     *  be read with poll(). There is one callback per handle: registering
+     *  one replaces the last, and an empty FunctionPointer removes it.
+     *
+     *  @param func the callback
+     *
+     *  @returns
+     *    the callback that was replaced, so that it can be put back
+     */
+    virtual mbed::util::FunctionPointer sigio(const mbed::util::FunctionPointer &func) {
+        (void) func;
+        return mbed::util::FunctionPointer();
+    }
+
     virtual ~FileHandle();
 };
 
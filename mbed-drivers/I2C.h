@@ -26,8 +26,18 @@
 #if DEVICE_I2C_ASYNCH
 #include "CThunk.h"
 #include "dma_api.h"
+#include "CircularBuffer.h"
 #include "core-util/FunctionPointer.h"
 #include "Transaction.h"
+#include "mbed_stats.h"
+
+#ifndef YOTTA_CFG_MBED_DRIVERS_I2C_TRANSACTION_QUEUE
+#   define YOTTA_CFG_MBED_DRIVERS_I2C_TRANSACTION_QUEUE 4
+#endif
+// backwards compatible guard for definition in `mbed-hal-<chip>/target_config.h`
+#ifndef TRANSACTION_QUEUE_SIZE_I2C
+#   define TRANSACTION_QUEUE_SIZE_I2C     YOTTA_CFG_MBED_DRIVERS_I2C_TRANSACTION_QUEUE
+#endif
 #endif
 
 namespace mbed {
@@ -155,7 +165,8 @@ public:
      * @param event     The logical OR of events to modify
      * @param callback  The event callback function
      * @param repeated Repeated start, true - do not send stop at end
-     * @return Zero if the transfer has started, or -1 if I2C peripheral is busy
+     * @return Zero if the transfer has started or was queued, or -1 if the queue is full or another I2C object is
+     *         using the peripheral
      */
     int transfer(int address, char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
 
@@ -167,21 +178,61 @@ public:
      * @param event     The logical OR of events to modify
      * @param callback  The event callback function
      * @param repeated Repeated start, true - do not send stop at end
-     * @return Zero if the transfer has started, or -1 if I2C peripheral is busy
+     * @return Zero if the transfer has started or was queued, or -1 if the queue is full or another I2C object is
+     *         using the peripheral
      */
     int transfer(int address, const Buffer& tx_buffer, const Buffer& rx_buffer, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
 
-    /** Abort the on-going I2C transfer
+    /** Abort the on-going I2C transfer, and continue with transfers in the queue if any.
      */
     void abort_transfer();
+
+    /** Clear the transaction buffer
+     */
+    void clear_transfer_buffer();
+
+    /** Clear the transaction buffer and abort on-going transfer.
+     */
+    void abort_all_transfers();
 protected:
-    typedef TwoWayTransaction<event_callback_t> transaction_data_t;
+    /** An I2C transfer: the buffers, events and callback, plus the slave address and stop condition
+     */
+    struct transaction_data_t : public TwoWayTransaction<event_callback_t> {
+        int address;                /**< 8/10 bit I2C slave address */
+        bool repeated;              /**< Repeated start, true - do not send stop at end */
+    };
     typedef Transaction<I2C, transaction_data_t> transaction_t;
 
     void irq_handler_asynch(void);
+
+    /** Add a transfer to the queue
+     * @param td Transaction data
+     * @return Zero if a transfer was added to the queue, or -1 if the queue is full
+    */
+    int queue_transfer(const transaction_data_t &td);
+
+    /** Configures a callback, i2c peripheral and initiate a new transfer
+     *
+     * @param td Transaction data
+    */
+    void start_transfer(const transaction_data_t &td);
+
+    /** Start the next queued transfer, if any
+     *
+     * Called from irq_handler_asynch(), so the next transfer starts as soon as the previous one completes.
+    */
+    void dequeue_transaction();
+
+#if TRANSACTION_QUEUE_SIZE_I2C
+    CircularBuffer<transaction_data_t, TRANSACTION_QUEUE_SIZE_I2C> _transaction_buffer;
+#endif
     transaction_data_t _current_transaction;
     CThunk<I2C> _irq;
     DMAUsage _usage;
+    bool _busy;
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    uint32_t _stats_start;
+#endif
 #endif
 
 protected:
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_POLLER_H
+#define MBED_POLLER_H
+
+#include "platform.h"
+#include "FileHandle.h"
+#include "core-util/FunctionPointer.h"
+
+#include <stdint.h>
+
+#ifndef YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES
+#   define YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES 8
+#endif
+
+typedef unsigned int nfds_t;
+
+struct pollfd {
+    int fd;         /**< The file descriptor to poll */
+    short events;   /**< The events to wait for */
+    short revents;  /**< The events that are ready */
+};
+
+/** Wait for one of a set of file descriptors to become ready
+ *
+ *  The caller sleeps between readiness notifications from the file handles.
+ *
+ *  @param fds the file descriptors and the events to wait for
+ *  @param nfds the number of entries in fds
+ *  @param timeout the timeout in milliseconds, 0 to return immediately or
+ *    -1 to wait forever
+ *
+ *  @returns
+ *    the number of entries with a non-zero revents,
+ *    0 on timeout
+ */
+extern "C" int poll(struct pollfd fds[], nfds_t nfds, int timeout);
+
+namespace mbed {
+
+/** Dispatch readiness events for a set of FileHandles from the scheduler
+ *
+ *  This is the event-driven counterpart of poll(): rather than blocking,
+ *  the Poller posts a callback to minar for each registered handle that is
+ *  ready. Dispatch is edge triggered: a handle is checked when it is added
+ *  and after each of its sigio() notifications, so a callback should consume
+ *  all the data that is waiting, as a handle that stays ready is not
+ *  reported again until its next notification.
+ *
+ * Example:
+ * @code
+ * Poller poller;
+ *
+ * void on_uart(FileHandle *fh, short revents) {
+ *     char c;
+ *     fh->read(&c, 1);
+ * }
+ *
+ * void app_start(int, char**) {
+ *     poller.add(&uart, POLLIN, Poller::event_callback_t(on_uart));
+ * }
+ * @endcode
+ */
+class Poller {
+public:
+    typedef mbed::util::FunctionPointer2<void, FileHandle *, short> event_callback_t;
+
+    Poller();
+    ~Poller();
+
+    /** Start watching a FileHandle
+     *
+     *  The Poller registers itself with the handle's sigio().
+     *
+     *  @param fh the handle to watch
+     *  @param events the events to wait for
+     *  @param callback called from the scheduler with the handle and the
+     *    ready events
+     *
+     *  @returns
+     *    0 on success,
+     *   -1 if the Poller is full
+     */
+    int add(FileHandle *fh, short events, const event_callback_t &callback);
+
+    /** Stop watching a FileHandle
+     *
+     *  @param fh the handle to stop watching
+     *
+     *  @returns
+     *    0 on success,
+     *   -1 if the handle was not being watched
+     */
+    int remove(FileHandle *fh);
+
+protected:
+    void notify();
+    void dispatch();
+
+    struct Entry {
+        FileHandle *fh;
+        short events;
+        event_callback_t callback;
+    };
+
+    Entry _entries[YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES];
+    volatile uint32_t _pending;
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_RAMFILESYSTEM_H
+#define MBED_RAMFILESYSTEM_H
+
+#include "platform.h"
+
+#include "FileSystemLike.h"
+#include "FileHandle.h"
+#include "DirHandle.h"
+
+#include <stdint.h>
+
+/* Extents start pointer aligned, and stay so if this is a multiple of the pointer size */
+#ifndef YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE
+#   define YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE 128
+#endif
+#ifndef YOTTA_CFG_MBED_DRIVERS_RAMFS_MAX_OPEN
+#   define YOTTA_CFG_MBED_DRIVERS_RAMFS_MAX_OPEN 4
+#endif
+#ifndef YOTTA_CFG_MBED_DRIVERS_RAMFS_NAME_MAX
+#   define YOTTA_CFG_MBED_DRIVERS_RAMFS_NAME_MAX 15
+#endif
+
+namespace mbed {
+
+class RamFileSystem;
+
+/** The on-arena record describing one ramfs file
+ */
+struct RamInode {
+    char     name[YOTTA_CFG_MBED_DRIVERS_RAMFS_NAME_MAX + 1];
+    size_t   size;          /**< Length of the file in bytes */
+    uint16_t first;         /**< First extent of the file */
+    uint16_t last;          /**< Last extent of the file, for O(1) growth */
+    uint16_t extents;       /**< Number of extents allocated to the file */
+    uint8_t  used;          /**< Non-zero if this inode holds a file */
+    uint8_t  open_count;    /**< Number of open handles to this file */
+};
+
+/** An open file on a RamFileSystem
+ *
+ *  Handles are taken from a fixed pool inside the RamFileSystem, so the
+ *  filesystem itself takes nothing from the heap to open and close files;
+ *  only opendir() allocates, for the DirHandle.
+ */
+class RamFileHandle : public FileHandle {
+    friend class RamFileSystem;
+
+public:
+    RamFileHandle();
+
+    virtual ssize_t write(const void* buffer, size_t length);
+    virtual ssize_t read(void* buffer, size_t length);
+    virtual int close();
+    virtual int isatty();
+    virtual off_t lseek(off_t offset, int whence);
+    virtual int fsync();
+    virtual off_t flen();
+
+    /** Map a region of the file into memory for reading
+     *
+     *  A region within a single extent is returned in place; one that
+     *  spans extents is copied into a window, as for FileHandle::mmap.
+     */
+    virtual const void *mmap(off_t offset, size_t length);
+    virtual int munmap(const void *addr, size_t length);
+
+    /** Get a pointer to the file contents, without copying
+     *
+     *  Files are stored in extents of YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE
+     *  bytes, so the contents are only contiguous up to the end of the extent
+     *  containing offset.
+     *
+     *  @param offset The offset into the file
+     *  @param length The number of bytes wanted; on return, the number of
+     *    contiguous bytes available at the returned pointer
+     *
+     *  @returns
+     *    A pointer into the filesystem arena, or NULL if offset is at or
+     *    beyond the end of the file.
+     */
+    const void *map(off_t offset, size_t *length);
+
+protected:
+    /* Find the extent containing pos, using and updating the cached extent */
+    uint8_t *locate(off_t pos, size_t *avail);
+
+    RamFileSystem *_fs;
+    RamInode      *_inode;
+    off_t          _pos;
+    int            _flags;
+    uint16_t       _extent;         /**< Cached extent, to make sequential access O(1) */
+    off_t          _extent_base;    /**< File offset of the start of _extent */
+    bool           _in_use;
+};
+
+/** A RAM-backed filesystem
+ *
+ *  All storage, including the file table, is carved from an arena supplied
+ *  by the caller; files grow in extents of
+ *  YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE bytes taken from it. The
+ *  namespace is flat: file names may not contain '/'.
+ *
+ * Example:
+ * @code
+ * static uint32_t arena[1024];
+ * RamFileSystem ramfs("ram", arena, sizeof(arena));
+ *
+ * void app_start(int, char**) {
+ *     FILE *f = fopen("/ram/scratch.bin", "w+");
+ *     fwrite(data, 1, sizeof(data), f);
+ *     fclose(f);
+ * }
+ * @endcode
+ */
+class RamFileSystem : public FileSystemLike {
+    friend class RamFileHandle;
+    friend class RamDirHandle;
+
+public:
+    /** Create a RamFileSystem
+     *
+     *  @param name The name to use for the filesystem
+     *  @param arena The memory to store files in
+     *  @param size The size of the arena in bytes
+     *  @param max_files The number of files the filesystem can hold
+     */
+    RamFileSystem(const char *name, void *arena, size_t size, unsigned max_files = 8);
+
+    virtual ~RamFileSystem();
+
+    virtual FileHandle *open(const char *filename, int flags);
+    virtual int remove(const char *filename);
+    virtual int rename(const char *oldname, const char *newname);
+    virtual DirHandle *opendir(const char *name);
+
+    /** Get a pointer to the contents of a file, without copying
+     *
+     *  @param filename The name of the file
+     *  @param offset The offset into the file
+     *  @param length The number of bytes wanted; on return, the number of
+     *    contiguous bytes available at the returned pointer
+     *
+     *  @returns
+     *    A pointer into the filesystem arena, or NULL if the file does not
+     *    exist or offset is at or beyond its end.
+     */
+    const void *map(const char *filename, off_t offset, size_t *length);
+
+    /** Get the number of bytes left for file contents
+     *
+     *  @returns
+     *    The free space, in bytes
+     */
+    size_t free_space();
+
+protected:
+    RamInode *find(const char *filename);
+    uint8_t  *extent(uint16_t index);
+    uint16_t  alloc_extent();
+    void      free_extents(RamInode *inode);
+    size_t    reserve(RamInode *inode, size_t start, size_t size);
+    uint16_t  walk(RamInode *inode, off_t pos, uint16_t hint, off_t *base);
+
+    RamInode     *_inodes;
+    uint16_t     *_links;
+    uint8_t      *_extents;
+    unsigned      _max_files;
+    uint16_t      _nextents;
+    uint16_t      _free;
+    uint16_t      _nfree;
+    RamFileHandle _handles[YOTTA_CFG_MBED_DRIVERS_RAMFS_MAX_OPEN];
+};
+
+} // namespace mbed
+
+#endif
@@ -29,6 +29,7 @@
 #include "CircularBuffer.h"
 #include "core-util/FunctionPointer.h"
 #include "Transaction.h"
+#include "mbed_stats.h"
 
 #ifndef YOTTA_CFG_MBED_DRIVERS_SPI_TRANSACTION_QUEUE
 #   define YOTTA_CFG_MBED_DRIVERS_SPI_TRANSACTION_QUEUE 16
@@ -40,6 +41,21 @@
 
 #endif
 
+extern "C" {
+/** Transfer a block of frames on an SPI master
+ *
+ * The drivers provide a weak definition, which calls spi_master_write() for each frame. A target can replace it
+ * with one that keeps the FIFO full or uses DMA, which matters most for short frames at high clock rates.
+ *
+ * @param obj The SPI object, already formatted
+ * @param tx Frames to send, or NULL to send SPI_FILL_WORD
+ * @param rx Buffer for the responses, or NULL to discard them
+ * @param frames The number of frames to transfer
+ * @param width The size of a frame in the buffers: 1, 2 or 4 bytes; the buffers need not be aligned to it
+ */
+void spi_master_write_block(spi_t *obj, const void *tx, void *rx, size_t frames, size_t width);
+}
+
 namespace mbed {
 
 /** A SPI Master, used for communicating with SPI slave devices
@@ -110,6 +126,22 @@ public:
     */
     virtual int write(int value);
 
+    /** Write a block of frames to the SPI Slave and read the responses
+     *
+     *  The bus is acquired once for the whole block, rather than once per frame as with write(int), and the
+     *  frames are moved by spi_master_write_block(), which targets may implement with their FIFO or DMA.
+     *  Frames are packed by the current format: one byte each for up to 8 bits, two for up to 16 bits and four
+     *  above that, in native byte order.
+     *
+     *  @param tx Frames to send, or NULL to send SPI_FILL_WORD
+     *  @param rx Buffer for the responses, or NULL to discard them
+     *  @param length Length of each buffer in bytes, a multiple of the frame size
+     *
+     *  @returns
+     *    The number of frames transferred, or -1 if length is not a multiple of the frame size
+    */
+    int write(const void *tx, void *rx, size_t length);
+
 #if DEVICE_SPI_ASYNCH
     class SPITransferAdder {
         friend SPI;
@@ -243,6 +275,9 @@ protected:
     CThunk<SPI> _irq;
     transaction_data_t _current_transaction;
     DMAUsage _usage;
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    uint32_t _stats_start;
+#endif
 #endif
 
     void aquire(void);
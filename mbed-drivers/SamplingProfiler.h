@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SAMPLINGPROFILER_H
+#define MBED_SAMPLINGPROFILER_H
+
+#include "platform.h"
+#include "TimerEvent.h"
+#include "minar/minar.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// The default number of samples held before they are streamed out
+#ifndef YOTTA_CFG_MBED_DRIVERS_SAMPLING_PROFILER_SIZE
+#define YOTTA_CFG_MBED_DRIVERS_SAMPLING_PROFILER_SIZE 256
+#endif
+
+/// The default interval in milliseconds at which samples are streamed out
+#ifndef YOTTA_CFG_MBED_DRIVERS_SAMPLING_PROFILER_STREAM_INTERVAL
+#define YOTTA_CFG_MBED_DRIVERS_SAMPLING_PROFILER_STREAM_INTERVAL 100
+#endif
+
+namespace mbed {
+
+/** A statistical profiler, which samples the program counter from a periodic ticker interrupt
+ *
+ * On each tick the profiler pends PendSV at the lowest priority, so the sample is taken when every other interrupt
+ * has finished, from the exception frame of the code that was running: the PC, and the LR when it is asked for.
+ * Samples are kept in a ring and streamed to stdout from minar in batches, as lines of hex
+ *
+ *     prof:<pc> <pc> ...            or, with the LR,       prof:<pc>/<lr> <pc>/<lr> ...
+ *
+ * which scripts/profile_symbolize.py turns into a flat profile or folded stacks for a flame graph, using the ELF.
+ *
+ * Time spent with interrupts disabled is attributed to where they are enabled again. Only one profiler can run at a
+ * time, as it owns the PendSV vector while it runs; it needs GCC.
+ *
+ * Example:
+ * @code
+ * SamplingProfiler profiler;
+ *
+ * void app_start(int, char**) {
+ *     profiler.start(1000);
+ * }
+ * @endcode
+ */
+class SamplingProfiler : protected TimerEvent {
+public:
+    /** Create a profiler
+     *
+     *  @param capacity The number of samples to hold between batches
+     *  @param with_lr Sample the LR as well as the PC
+     */
+    SamplingProfiler(size_t capacity = YOTTA_CFG_MBED_DRIVERS_SAMPLING_PROFILER_SIZE, bool with_lr = false);
+
+    virtual ~SamplingProfiler();
+
+    /** Start sampling
+     *
+     *  @param period_us The sampling period in microseconds
+     *  @param stream_ms The interval at which samples are streamed to stdout, or 0 to leave them to read()
+     *  @returns
+     *    0 on success,
+     *    -1 if a profiler is already running, there is no buffer or the toolchain is not supported
+     */
+    int start(uint32_t period_us, uint32_t stream_ms = YOTTA_CFG_MBED_DRIVERS_SAMPLING_PROFILER_STREAM_INTERVAL);
+
+    /** Stop sampling. Samples not yet streamed can still be read. */
+    void stop();
+
+    /** Change the sampling period, from the next sample
+     *
+     *  @param period_us The sampling period in microseconds
+     */
+    void set_period(uint32_t period_us);
+
+    /** Change the number of samples held, dropping any held now
+     *
+     *  @param capacity The number of samples to hold between batches
+     *  @returns
+     *    0 on success,
+     *    -1 if the profiler is running or the buffer cannot be allocated
+     */
+    int set_capacity(size_t capacity);
+
+    /** Remove samples from the ring
+     *
+     *  @param samples Buffer for the samples; each takes two words, PC then LR, when the LR is sampled
+     *  @param count The number of samples the buffer can hold
+     *  @returns The number of samples read
+     */
+    size_t read(uint32_t *samples, size_t count);
+
+    /** The number of samples dropped because the ring was full */
+    uint32_t dropped() const {
+        return _dropped;
+    }
+
+    /** Called from PendSV with the exception frame of the code that was interrupted
+     */
+    static void sample(const uint32_t *frame);
+
+protected:
+    virtual void handler();
+
+    /// Print a batch of samples, from minar
+    void stream();
+
+    uint32_t *_buffer;
+    size_t _capacity;
+    volatile uint32_t _head;
+    volatile uint32_t _tail;
+    volatile uint32_t _dropped;
+    /// The dropped count last streamed
+    uint32_t _reported;
+    uint32_t _period;
+    timestamp_t _next;
+    bool _lr;
+    bool _running;
+    minar::callback_handle_t _stream;
+    uint32_t _saved_vector;
+    uint32_t _saved_priority;
+
+    static SamplingProfiler * volatile _active;
+};
+
+} // namespace mbed
+
+#endif
@@ -63,9 +63,49 @@ public:
      */
     Serial(PinName tx, PinName rx, const char *name=NULL);
 
+    /** Check whether the port can be read or written without blocking
+     */
+    virtual short poll(short events);
+
+    /** Register a callback for received data
+     *
+     *  The callback is called from interrupt context when data arrives,
+     *  after any function attached to RxIrq. Unless one is attached, the
+     *  receive interrupt stays masked from then until poll() finds no data
+     *  waiting, so a callback that does not read the data is not called
+     *  repeatedly.
+     */
+    virtual mbed::util::FunctionPointer sigio(const mbed::util::FunctionPointer &func);
+
+#if DEVICE_SERIAL_ASYNCH
+    /** Start an asynchronous read, using the serial asynch API
+     *
+     *  The callback is given -1 if the transfer ends with an error event.
+     */
+    virtual int read_async(void *buffer, size_t length, const io_callback_t &callback);
+
+    /** Start an asynchronous write, using the serial asynch API
+     *
+     *  The callback is given -1 if the transfer ends with an error event.
+     */
+    virtual int write_async(const void *buffer, size_t length, const io_callback_t &callback);
+#endif
+
 protected:
     virtual int _getc();
     virtual int _putc(int c);
+
+    void sigio_irq();
+
+    mbed::util::FunctionPointer _sigio;
+
+#if DEVICE_SERIAL_ASYNCH
+    void read_async_done(Buffer buffer, int event);
+    void write_async_done(Buffer buffer, int event);
+
+    io_callback_t _read_async_callback;
+    io_callback_t _write_async_callback;
+#endif
 };
 
 /** Get the stdio Serial object, which is lazy instantiated.
@@ -25,6 +25,7 @@
 #include "core-util/FunctionPointer.h"
 #include "serial_api.h"
 #include "Transaction.h"
+#include "mbed_stats.h"
 
 #if DEVICE_SERIAL_ASYNCH
 #include "CThunk.h"
@@ -218,10 +219,15 @@ protected:
     transaction_data_t _current_rx_transaction;
     DMAUsage _tx_usage;
     DMAUsage _rx_usage;
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    uint32_t _stats_tx_start;
+#endif
 #endif
 
     serial_t                    _serial;
     mbed::util::FunctionPointer _irq[2];
+    /* Called on RxIrq after _irq[RxIrq], for Serial::sigio() */
+    mbed::util::FunctionPointer _rx_notify;
     int                         _baud;
 
 };
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SOFTI2C_H
+#define MBED_SOFTI2C_H
+
+#include "platform.h"
+#include "BitBang.h"
+
+/// How many half clock periods a slave may stretch the clock for before the master carries on
+#ifndef YOTTA_CFG_MBED_DRIVERS_SOFT_I2C_STRETCH_LIMIT
+#define YOTTA_CFG_MBED_DRIVERS_SOFT_I2C_STRETCH_LIMIT 1000
+#endif
+
+namespace mbed {
+
+/** A bit-banged I2C master
+ *
+ * The engine drives an I2C bus through a Pins class, which provides open-drain ```sda(level)``` and
+ * ```scl(level)```, their reads ```sda()``` and ```scl()```, ```delay_count(ns)```, which converts a delay to a count
+ * once per frequency, and ```delay(count)```, which waits for it. SoftI2C uses BitBangI2CPins on GPIO; a simulated
+ * Pins class can be used to check the waveforms.
+ *
+ * The blocking API is that of I2C. Slaves may stretch the clock.
+ */
+template <typename Pins>
+class SoftI2CEngine {
+public:
+    /** Create a bit-banged I2C master and release both lines
+     *
+     *  @param sda I2C data line pin
+     *  @param scl I2C clock line pin
+     */
+    SoftI2CEngine(PinName sda, PinName scl) : _pins(sda, scl), _half_ns(5000), _half(0) {
+        _pins.sda(1);
+        _pins.scl(1);
+    }
+
+    /** Set the frequency of the I2C interface
+     *
+     *  @param hz The bus frequency in hertz
+     */
+    void frequency(int hz) {
+        if (hz > 0) {
+            _half_ns = 500000000 / hz;
+            _half = _pins.delay_count(_half_ns);
+        }
+    }
+
+    /** Read from an I2C slave
+     *
+     *  @param address 8-bit I2C slave address [ addr | 1 ]
+     *  @param data Pointer to the byte-array to read data in to
+     *  @param length Number of bytes to read
+     *  @param repeated Repeated start, true - don't send stop at end
+     *
+     *  @returns
+     *       0 on success (ack),
+     *   non-0 on failure (nack)
+     */
+    int read(int address, char *data, int length, bool repeated = false) {
+        start();
+        if (!write(address | 1)) {
+            stop();
+            return 1;
+        }
+        for (int i = 0; i < length; i++) {
+            // The last byte is not acknowledged, which tells the slave to stop sending
+            data[i] = read(i < length - 1);
+        }
+        if (!repeated) {
+            stop();
+        }
+        return 0;
+    }
+
+    /** Read a single byte from the I2C bus
+     *
+     *  @param ack indicates if the byte is to be acknowledged (1 = acknowledge)
+     *
+     *  @returns
+     *    the byte read
+     */
+    int read(int ack) {
+        int data = 0;
+        for (int i = 0; i < 8; i++) {
+            data = (data << 1) | read_bit();
+        }
+        write_bit(!ack);
+        return data;
+    }
+
+    /** Write to an I2C slave
+     *
+     *  @param address 8-bit I2C slave address [ addr | 0 ]
+     *  @param data Pointer to the byte-array data to send
+     *  @param length Number of bytes to send
+     *  @param repeated Repeated start, true - do not send stop at end
+     *
+     *  @returns
+     *       0 on success (ack),
+     *   non-0 on failure (nack)
+     */
+    int write(int address, const char *data, int length, bool repeated = false) {
+        start();
+        int rc = !write(address & ~1);
+        for (int i = 0; !rc && i < length; i++) {
+            rc = !write(data[i]);
+        }
+        if (rc || !repeated) {
+            stop();
+        }
+        return rc;
+    }
+
+    /** Write single byte out on the I2C bus
+     *
+     *  @param data data to write out on bus
+     *
+     *  @returns
+     *    '1' if an ACK was received,
+     *    '0' otherwise
+     */
+    int write(int data) {
+        for (int i = 7; i >= 0; i--) {
+            write_bit((data >> i) & 1);
+        }
+        return !read_bit();
+    }
+
+    /** Creates a start condition on the I2C bus
+     *
+     *  If the bus is already held, this is a repeated start.
+     */
+    void start(void) {
+        _pins.sda(1);
+        half_delay();
+        clock_high();
+        _pins.sda(0);
+        half_delay();
+        _pins.scl(0);
+    }
+
+    /** Creates a stop condition on the I2C bus
+     */
+    void stop(void) {
+        _pins.sda(0);
+        half_delay();
+        clock_high();
+        _pins.sda(1);
+        half_delay();
+    }
+
+protected:
+    /// Wait for half a clock period; the delay is converted on first use, so that construction does not calibrate it
+    void half_delay() {
+        if (!_half) {
+            _half = _pins.delay_count(_half_ns);
+        }
+        _pins.delay(_half);
+    }
+
+    /// Release SCL, wait for any clock stretching to end, then hold SCL high for half a period
+    void clock_high() {
+        _pins.scl(1);
+        for (uint32_t n = YOTTA_CFG_MBED_DRIVERS_SOFT_I2C_STRETCH_LIMIT; n && !_pins.scl(); n--) {
+            half_delay();
+        }
+        half_delay();
+    }
+
+    void write_bit(int bit) {
+        _pins.sda(bit);
+        half_delay();
+        clock_high();
+        _pins.scl(0);
+    }
+
+    int read_bit() {
+        _pins.sda(1);
+        half_delay();
+        clock_high();
+        int bit = _pins.sda();
+        _pins.scl(0);
+        return bit;
+    }
+
+    Pins _pins;
+    uint32_t _half_ns;
+    /// _half_ns as a count for _pins.delay(), or 0 until it is first needed
+    uint32_t _half;
+};
+
+/** A bit-banged I2C master on any two GPIO pins
+ *
+ * SoftI2C does not need an I2C peripheral, so it can add buses beyond those of the MCU, on any pins; each SoftI2C is
+ * independent. Both lines need pull-ups. The default frequency is 100kHz.
+ *
+ * Example:
+ * @code
+ * SoftI2C i2c(p5, p6);
+ *
+ * int main() {
+ *     char data[2];
+ *     i2c.frequency(400000);
+ *     i2c.read(0x62, data, 2);
+ * }
+ * @endcode
+ */
+class SoftI2C : public SoftI2CEngine<BitBangI2CPins> {
+public:
+    /** Create a bit-banged I2C master, connected to the specified pins
+     *
+     *  @param sda I2C data line pin
+     *  @param scl I2C clock line pin
+     */
+    SoftI2C(PinName sda, PinName scl) : SoftI2CEngine<BitBangI2CPins>(sda, scl) {}
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SOFTSPI_H
+#define MBED_SOFTSPI_H
+
+#include "platform.h"
+
+#if DEVICE_SPI
+
+#include "spi_api.h"
+#include "BitBang.h"
+
+namespace mbed {
+
+/** A bit-banged SPI master
+ *
+ * The engine drives an SPI bus through a Pins class, which provides ```mosi(level)```, ```miso()```,
+ * ```sclk(level)```, ```delay_count(ns)```, which converts a delay to a count once per frequency, and
+ * ```delay(count)```, which waits for it. SoftSPI uses BitBangSPIPins on GPIO; a simulated Pins class can be used to
+ * check the waveforms.
+ *
+ * The blocking API is that of SPI, for 1 to 32 bit frames in all four modes.
+ */
+template <typename Pins>
+class SoftSPIEngine {
+public:
+    /** Create a bit-banged SPI master, in mode 0 with 8 bit frames at 1MHz
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     */
+    SoftSPIEngine(PinName mosi, PinName miso, PinName sclk) :
+        _pins(mosi, miso, sclk), _half_ns(500), _half(0), _bits(8), _mode(0), _order(SPI_MSB) {
+        _pins.sclk(0);
+    }
+
+    /** Configure the data transmission format
+     *
+     *  @param bits Number of bits per SPI frame (1 - 32)
+     *  @param mode Clock polarity and phase mode (0 - 3)
+     *  @param order Bit order, SPI_MSB (standard) or SPI_LSB
+     */
+    void format(int bits, int mode = 0, spi_bitorder_t order = SPI_MSB) {
+        if (bits < 1 || bits > 32) {
+            return;
+        }
+        _bits = bits;
+        _mode = mode & 3;
+        _order = order;
+        // The clock idles at its polarity
+        _pins.sclk(_mode >> 1);
+    }
+
+    /** Set the spi bus clock frequency
+     *
+     *  @param hz SCLK frequency in hz (default = 1MHz)
+     */
+    void frequency(int hz = 1000000) {
+        if (hz > 0) {
+            _half_ns = 500000000 / hz;
+            _half = _pins.delay_count(_half_ns);
+        }
+    }
+
+    /** Write to the SPI Slave and return the response
+     *
+     *  @param value Data to be sent to the SPI slave
+     *
+     *  @returns
+     *    Response from the SPI slave
+     */
+    int write(int value) {
+        int cpol = _mode >> 1;
+        int cpha = _mode & 1;
+        uint32_t in = 0;
+        for (int i = 0; i < _bits; i++) {
+            int bit = (_order == SPI_MSB) ? _bits - 1 - i : i;
+            // In phase 0 data is sampled on the leading clock edge, in phase 1 on the trailing edge
+            if (cpha) {
+                _pins.sclk(!cpol);
+            }
+            _pins.mosi((value >> bit) & 1);
+            half_delay();
+            _pins.sclk(cpha ? cpol : !cpol);
+            in |= (uint32_t)(_pins.miso() & 1) << bit;
+            half_delay();
+            if (!cpha) {
+                _pins.sclk(cpol);
+            }
+        }
+        return in;
+    }
+
+protected:
+    /// Wait for half a clock period; the delay is converted on first use, so that construction does not calibrate it
+    void half_delay() {
+        if (!_half) {
+            _half = _pins.delay_count(_half_ns);
+        }
+        _pins.delay(_half);
+    }
+
+    Pins _pins;
+    uint32_t _half_ns;
+    /// _half_ns as a count for _pins.delay(), or 0 until it is first needed
+    uint32_t _half;
+    int _bits;
+    int _mode;
+    spi_bitorder_t _order;
+};
+
+/** A bit-banged SPI master on any GPIO pins
+ *
+ * SoftSPI does not need an SPI peripheral, so it can add buses beyond those of the MCU, on any pins; each SoftSPI is
+ * independent. Chip selects are driven with DigitalOut, as with SPI.
+ *
+ * Example:
+ * @code
+ * SoftSPI spi(p5, p6, p7);
+ * DigitalOut cs(p8, 1);
+ *
+ * int main() {
+ *     spi.format(8, 3);
+ *     cs = 0;
+ *     spi.write(0x8F);
+ *     int whoami = spi.write(0x00);
+ *     cs = 1;
+ * }
+ * @endcode
+ */
+class SoftSPI : public SoftSPIEngine<BitBangSPIPins> {
+public:
+    /** Create a bit-banged SPI master, connected to the specified pins
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     */
+    SoftSPI(PinName mosi, PinName miso, PinName sclk) : SoftSPIEngine<BitBangSPIPins>(mosi, miso, sclk) {}
+};
+
+} // namespace mbed
+
+#endif // DEVICE_SPI
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_STATSFILESYSTEM_H
+#define MBED_STATSFILESYSTEM_H
+
+#include "platform.h"
+
+#include "FileSystemLike.h"
+#include "FileHandle.h"
+#include "mbed_stats.h"
+
+#ifndef YOTTA_CFG_MBED_DRIVERS_STATS_MAX_OPEN
+#   define YOTTA_CFG_MBED_DRIVERS_STATS_MAX_OPEN 2
+#endif
+#ifndef YOTTA_CFG_MBED_DRIVERS_STATS_SNAPSHOT_SIZE
+#   define YOTTA_CFG_MBED_DRIVERS_STATS_SNAPSHOT_SIZE 192
+#endif
+
+namespace mbed {
+
+/** An open snapshot of a statistics group
+ *
+ *  The counters are formatted when the file is opened, so reads see one
+ *  point in time however slowly they are made.
+ */
+class StatsFileHandle : public FileHandle {
+    friend class StatsFileSystem;
+
+public:
+    StatsFileHandle();
+
+    virtual ssize_t write(const void* buffer, size_t length);
+    virtual ssize_t read(void* buffer, size_t length);
+    virtual int close();
+    virtual int isatty();
+    virtual off_t lseek(off_t offset, int whence);
+    virtual int fsync();
+    virtual off_t flen();
+
+protected:
+    char   _text[YOTTA_CFG_MBED_DRIVERS_STATS_SNAPSHOT_SIZE];
+    size_t _length;
+    off_t  _pos;
+    bool   _in_use;
+};
+
+/** A read-only filesystem with a file for each registered statistics group
+ *
+ *  Each file is a snapshot of the group's counters as text, one
+ *  "name value" line per counter followed by the average latency. See
+ *  mbed_stats.h for the groups the drivers keep. File handles are taken
+ *  from a fixed pool of YOTTA_CFG_MBED_DRIVERS_STATS_MAX_OPEN; the C
+ *  library's fopen() still allocates its FILE, and opendir() allocates the
+ *  DirHandle.
+ *
+ * Example:
+ * @code
+ * StatsFileSystem stats;
+ *
+ * void app_start(int, char**) {
+ *     FILE *f = fopen("/stats/spi0", "r");
+ *     char line[32];
+ *     while (fgets(line, sizeof(line), f)) {
+ *         printf("%s", line);
+ *     }
+ *     fclose(f);
+ * }
+ * @endcode
+ */
+class StatsFileSystem : public FileSystemLike {
+public:
+    /** Create a StatsFileSystem
+     *
+     *  @param name The name to use for the filesystem
+     */
+    StatsFileSystem(const char *name = "stats");
+
+    virtual FileHandle *open(const char *filename, int flags);
+    virtual DirHandle *opendir(const char *name);
+
+protected:
+    StatsFileHandle _handles[YOTTA_CFG_MBED_DRIVERS_STATS_MAX_OPEN];
+};
+
+} // namespace mbed
+
+#endif
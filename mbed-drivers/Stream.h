@@ -38,7 +38,7 @@ public:
     int vprintf(const char* format, std::va_list args);
     int vscanf(const char* format, std::va_list args);
 
-    operator std::FILE*() {return _file;}
+    operator std::FILE*() {return file();}
 
 protected:
     virtual int close();
@@ -48,10 +48,15 @@ protected:
     virtual int isatty();
     virtual int fsync();
     virtual off_t flen();
+    virtual const void *mmap(off_t offset, size_t length);
 
     virtual int _putc(int c) = 0;
     virtual int _getc() = 0;
 
+    /* The FILE used for formatted I/O, which is only opened on first use so
+     * that streams used just for putc/getc never allocate one */
+    std::FILE *file();
+
     std::FILE *_file;
 
     /* disallow copy constructor and assignment operators */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVER_TRACE_H
+#define MBED_DRIVER_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Driver event tracing, set with YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE
+ *
+ *  When enabled, the drivers record when transfers are queued, started and
+ *  completed, when their interrupts run, when their callbacks run from minar
+ *  and when ticker events fire. Each record is 12 bytes, written to a ring
+ *  that keeps the latest YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE_SIZE records.
+ *  Writers never block: a slot is reserved with an exclusive access on cores
+ *  that have them, and with interrupts masked for a few instructions on
+ *  others.
+ *
+ *  mbed_driver_trace_dump() drains the ring to stdout as text, which
+ *  scripts/driver_trace.py converts to Chrome trace JSON for chrome://tracing
+ *  or Perfetto.
+ */
+#ifndef YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE
+#define YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE 0
+#endif
+
+/** The number of records in the ring, which must be a power of two */
+#ifndef YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE_SIZE
+#define YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE_SIZE 256
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The drivers that record events */
+enum mbed_driver_trace_driver {
+    MBED_DRIVER_TRACE_SPI = 1,
+    MBED_DRIVER_TRACE_I2C,
+    MBED_DRIVER_TRACE_SERIAL_TX,
+    MBED_DRIVER_TRACE_SERIAL_RX,
+    MBED_DRIVER_TRACE_I2C_V2,
+    MBED_DRIVER_TRACE_SPI_V2,
+    MBED_DRIVER_TRACE_TICKER,
+    /** The first ID free for application use */
+    MBED_DRIVER_TRACE_USER = 128
+};
+
+/** The events recorded */
+enum mbed_driver_trace_event {
+    /** A transfer was queued behind another; the argument is 0 */
+    MBED_DRIVER_TRACE_QUEUE = 1,
+    /** A transfer was started; the argument is its transmit length for v1 drivers, and 0 for v2 */
+    MBED_DRIVER_TRACE_START,
+    /** The driver's interrupt ran; the argument is the HAL event */
+    MBED_DRIVER_TRACE_IRQ,
+    /** A transfer completed and its callback was posted to minar; the argument is the event */
+    MBED_DRIVER_TRACE_COMPLETE,
+    /** A completion callback ran from minar; the argument is the event */
+    MBED_DRIVER_TRACE_CALLBACK,
+    /** A ticker event fired; the argument is its ID */
+    MBED_DRIVER_TRACE_FIRE
+};
+
+typedef struct {
+    /** us_ticker time of the event */
+    uint32_t timestamp;
+    uint32_t arg;
+    uint8_t driver;
+    uint8_t event;
+    /** The low bits of the record's position in the trace, written last, so a record being written can be seen */
+    uint16_t sequence;
+} mbed_driver_trace_record_t;
+
+/** Record an event. It may be called from any context. */
+void mbed_driver_trace(uint8_t driver, uint8_t event, uint32_t arg);
+
+/** Copy the oldest records not yet drained, and remove them from the trace
+ *  @param records The buffer to copy the records to
+ *  @param count The number of records the buffer can hold
+ *  @param lost Set to the number of records overwritten before they were drained, if not NULL
+ *  @returns The number of records copied
+ */
+size_t mbed_driver_trace_drain(mbed_driver_trace_record_t *records, size_t count, uint32_t *lost);
+
+/** Drain the trace to stdout, one record per line as
+ *  ```trace:<timestamp>:<driver>:<event>:<argument>``` in hex
+ */
+void mbed_driver_trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE
+#define MBED_DRIVER_TRACE(driver, event, arg) mbed_driver_trace((driver), (event), (uint32_t)(arg))
+#else
+#define MBED_DRIVER_TRACE(driver, event, arg) ((void)0)
+#endif
+
+#endif
@@ -49,6 +49,8 @@
 #include "Serial.h"
 #include "SPI.h"
 #include "I2C.h"
+#include "SoftSPI.h"
+#include "SoftI2C.h"
 #include "RawSerial.h"
 
 // mbed Internal components
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ALLOC_TRACE_H
+#define MBED_ALLOC_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Heap allocation accounting, set with YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE
+ *
+ *  When enabled, operator new and new[] are replaced by versions that count
+ *  the allocations and bytes made from each call site, identified by the
+ *  return address, in a fixed table of YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE_SITES
+ *  entries. mbed_alloc_trace_report() prints the table; the addresses can be
+ *  resolved with addr2line. Code that allocates other than through operator
+ *  new, such as the C library's fopen(), marks the allocation with
+ *  MBED_ALLOC_NOTE(), which attributes it to the caller of the function it is
+ *  in.
+ *
+ *  After mbed_alloc_seal(), every allocation counted also calls
+ *  mbed_alloc_sealed_hook(), which halts through error() unless it is
+ *  replaced. With YOTTA_CFG_MBED_DRIVERS_ALLOC_SEAL set, the heap is sealed
+ *  when app_start() returns, to enforce a policy of no allocation after
+ *  initialization.
+ */
+#ifndef YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE
+#define YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE 0
+#endif
+
+/** The number of call sites that are told apart */
+#ifndef YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE_SITES
+#define YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE_SITES 32
+#endif
+
+/** Seal the heap when app_start() returns; this needs YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE */
+#ifndef YOTTA_CFG_MBED_DRIVERS_ALLOC_SEAL
+#define YOTTA_CFG_MBED_DRIVERS_ALLOC_SEAL 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /** The return address of the allocation */
+    void *caller;
+    uint32_t count;
+    uint32_t bytes;
+} mbed_alloc_site_t;
+
+/** Count an allocation. It may be called from any context.
+ *  @param caller The call site
+ *  @param size The size of the allocation in bytes
+ */
+void mbed_alloc_trace_record(void *caller, size_t size);
+
+/** Get the call sites counted so far, in the order they were first seen
+ *  @param count Set to the number of sites
+ *  @returns The table of sites
+ */
+const mbed_alloc_site_t *mbed_alloc_trace_sites(size_t *count);
+
+/** The allocations counted after the table of sites was full */
+uint32_t mbed_alloc_trace_untracked(void);
+
+/** Forget every call site */
+void mbed_alloc_trace_reset(void);
+
+/** Print the call sites to stdout, one per line as ```alloc:<caller> <count> <bytes>``` */
+void mbed_alloc_trace_report(void);
+
+/** Trap every allocation from now on */
+void mbed_alloc_seal(void);
+
+/** Stop trapping allocations */
+void mbed_alloc_unseal(void);
+
+/** @returns Non-zero if the heap is sealed */
+int mbed_alloc_sealed(void);
+
+/** Called for each allocation made while the heap is sealed, after it is counted. The default halts through error();
+ *  it may be replaced to log the allocation and carry on.
+ *  @param caller The call site
+ *  @param size The size of the allocation in bytes
+ */
+void mbed_alloc_sealed_hook(void *caller, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define MBED_ALLOC_CALLER __builtin_return_address(0)
+
+#if YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE
+#define MBED_ALLOC_NOTE(size) mbed_alloc_trace_record(MBED_ALLOC_CALLER, (size))
+#else
+#define MBED_ALLOC_NOTE(size) ((void)0)
+#endif
+
+#endif
@@ -17,6 +17,25 @@
 #ifndef MBED_ASSERT_H
 #define MBED_ASSERT_H
 
+#include <stdint.h>
+
+/** Assertion level, set with YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL
+ *
+ *  0: assertions are compiled out
+ *  1: a failed assertion reports only a file ID and line number, so no
+ *     strings are stored; scripts/assert_decode.py maps the ID back to a file
+ *  2: a failed assertion prints the expression, file and line
+ *
+ *  The default is 2, or 0 when NDEBUG is defined.
+ */
+#ifdef YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL
+#define MBED_ASSERT_LEVEL YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL
+#elif defined(NDEBUG)
+#define MBED_ASSERT_LEVEL 0
+#else
+#define MBED_ASSERT_LEVEL 2
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -32,12 +51,64 @@ extern "C" {
  */
 void mbed_assert_internal(const char *expr, const char *file, int line);
 
+/** Internal mbed assert function for assertions reported by ID.
+ *  The file ID and line are printed to stderr in hex and mbed_die() is called.
+ *  @param file_id Hash of the name of the file where the assertion failed.
+ *  @param line Failing assertion line number.
+ */
+void mbed_assert_id(uint32_t file_id, int line);
+
 #ifdef __cplusplus
 }
 #endif
 
-#ifdef NDEBUG
+/* MBED_FILE_ID is a hash of the last 16 characters of the base name of
+ * __FILE__, which the compiler folds to a constant. Characters are counted
+ * from the end, so MBED_FILE_C(0) is the last one. */
+#define MBED_FILE_C(i) \
+    (sizeof(__FILE__) > (i) + 1 ? (uint32_t)(unsigned char)__FILE__[sizeof(__FILE__) - 2 - (i)] : (uint32_t)'/')
+#define MBED_FILE_SEP_NOT(i) (MBED_FILE_C(i) != '/' && MBED_FILE_C(i) != '\\')
+#define MBED_FILE_ALIVE_0 1
+#define MBED_FILE_ALIVE_1 (MBED_FILE_ALIVE_0 && MBED_FILE_SEP_NOT(0))
+#define MBED_FILE_ALIVE_2 (MBED_FILE_ALIVE_1 && MBED_FILE_SEP_NOT(1))
+#define MBED_FILE_ALIVE_3 (MBED_FILE_ALIVE_2 && MBED_FILE_SEP_NOT(2))
+#define MBED_FILE_ALIVE_4 (MBED_FILE_ALIVE_3 && MBED_FILE_SEP_NOT(3))
+#define MBED_FILE_ALIVE_5 (MBED_FILE_ALIVE_4 && MBED_FILE_SEP_NOT(4))
+#define MBED_FILE_ALIVE_6 (MBED_FILE_ALIVE_5 && MBED_FILE_SEP_NOT(5))
+#define MBED_FILE_ALIVE_7 (MBED_FILE_ALIVE_6 && MBED_FILE_SEP_NOT(6))
+#define MBED_FILE_ALIVE_8 (MBED_FILE_ALIVE_7 && MBED_FILE_SEP_NOT(7))
+#define MBED_FILE_ALIVE_9 (MBED_FILE_ALIVE_8 && MBED_FILE_SEP_NOT(8))
+#define MBED_FILE_ALIVE_10 (MBED_FILE_ALIVE_9 && MBED_FILE_SEP_NOT(9))
+#define MBED_FILE_ALIVE_11 (MBED_FILE_ALIVE_10 && MBED_FILE_SEP_NOT(10))
+#define MBED_FILE_ALIVE_12 (MBED_FILE_ALIVE_11 && MBED_FILE_SEP_NOT(11))
+#define MBED_FILE_ALIVE_13 (MBED_FILE_ALIVE_12 && MBED_FILE_SEP_NOT(12))
+#define MBED_FILE_ALIVE_14 (MBED_FILE_ALIVE_13 && MBED_FILE_SEP_NOT(13))
+#define MBED_FILE_ALIVE_15 (MBED_FILE_ALIVE_14 && MBED_FILE_SEP_NOT(14))
+#define MBED_FILE_TERM(i, p) ((MBED_FILE_ALIVE_##i && MBED_FILE_SEP_NOT(i)) ? MBED_FILE_C(i) * (p) : 0u)
+#define MBED_FILE_ID ((uint32_t)( \
+    MBED_FILE_TERM(0, 0x1u) + \
+    MBED_FILE_TERM(1, 0x1fu) + \
+    MBED_FILE_TERM(2, 0x3c1u) + \
+    MBED_FILE_TERM(3, 0x745fu) + \
+    MBED_FILE_TERM(4, 0xe1781u) + \
+    MBED_FILE_TERM(5, 0x1b4d89fu) + \
+    MBED_FILE_TERM(6, 0x34e63b41u) + \
+    MBED_FILE_TERM(7, 0x67e12cdfu) + \
+    MBED_FILE_TERM(8, 0x94446f01u) + \
+    MBED_FILE_TERM(9, 0xf449711fu) + \
+    MBED_FILE_TERM(10, 0x94e4b2c1u) + \
+    MBED_FILE_TERM(11, 0x7b1a55fu) + \
+    MBED_FILE_TERM(12, 0xee830681u) + \
+    MBED_FILE_TERM(13, 0xe1ddc99fu) + \
+    MBED_FILE_TERM(14, 0x59db6a41u) + \
+    MBED_FILE_TERM(15, 0xe191dddfu)))
+
+#if MBED_ASSERT_LEVEL == 0
 #define MBED_ASSERT(expr) ((void)0)
+#define MBED_ASSERT_ID(expr) ((void)0)
+
+#elif MBED_ASSERT_LEVEL == 1
+#define MBED_ASSERT(expr) MBED_ASSERT_ID(expr)
 
 #else
 #define MBED_ASSERT(expr)                                \
@@ -48,4 +119,17 @@ do {                                                     \
 } while (0)
 #endif
 
+/** MBED_ASSERT_ID reports failures by file ID and line at every assertion
+ *  level above 0, keeping the expression and file name out of the image; it
+ *  is meant for hot driver paths.
+ */
+#if MBED_ASSERT_LEVEL != 0
+#define MBED_ASSERT_ID(expr)                             \
+do {                                                     \
+    if (!(expr)) {                                       \
+        mbed_assert_id(MBED_FILE_ID, __LINE__);          \
+    }                                                    \
+} while (0)
+#endif
+
 #endif
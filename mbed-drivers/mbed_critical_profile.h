@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CRITICAL_PROFILE_H
+#define MBED_CRITICAL_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Critical section profiling, set with YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE
+ *
+ *  When enabled, every critical section in the drivers is timed from just
+ *  after interrupts are disabled to just before they are enabled again. Each
+ *  section keeps a count, its longest duration with the caller of the
+ *  function it was longest in, and a histogram of durations in powers of two.
+ *  mbed_critical_profile_report() prints them, so the section behind the
+ *  worst interrupt latency can be found.
+ *
+ *  Durations are in ticks of mbed_critical_profile_clock(): CPU cycles on
+ *  cores with a DWT cycle counter, microseconds otherwise. The clock is weak,
+ *  so a simulated clock can replace it.
+ */
+#ifndef YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE
+#define YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE 0
+#endif
+
+/** The number of histogram bins per section. Bin 0 counts durations of 0 or 1
+ *  ticks, bin n those from 2^n to 2^(n+1) - 1, and the last bin all longer ones.
+ */
+#ifndef YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE_BINS
+#define YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE_BINS 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The record of one critical section, identified by where it is in the source */
+typedef struct mbed_critical_site {
+    const char *file;
+    int line;
+    uint32_t count;
+    uint32_t max;
+    /** The return address of the function the section was longest in */
+    void *max_caller;
+    uint32_t histogram[YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE_BINS];
+    struct mbed_critical_site *next;
+    uint8_t listed;
+} mbed_critical_site_t;
+
+/** Read the profiling clock
+ *
+ *  This is a weak function which reads the DWT cycle counter on Cortex-M3, M4
+ *  and M7, and the us_ticker on other cores.
+ */
+uint32_t mbed_critical_profile_clock(void);
+
+/** Start the DWT cycle counter, if there is one, and clear every record */
+void mbed_critical_profile_start(void);
+
+/** Record one pass through a critical section. It must be called with interrupts disabled.
+ *  @param site The record of the section, which is added to the list of sections on its first pass
+ *  @param start The clock when the section was entered
+ *  @param caller The return address of the function containing the section, or NULL
+ */
+void mbed_critical_profile_record(mbed_critical_site_t *site, uint32_t start, void *caller);
+
+/** Get the first section record; the others follow through next */
+mbed_critical_site_t *mbed_critical_profile_sites(void);
+
+/** Print every section record to stdout, longest first */
+void mbed_critical_profile_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(__GNUC__)
+#define MBED_CRITICAL_CALLER __builtin_return_address(0)
+#else
+#define MBED_CRITICAL_CALLER NULL
+#endif
+
+/** An initializer for the record of the section at this line */
+#define MBED_CRITICAL_SITE_INIT {__FILE__, __LINE__, 0, 0, NULL, {0}, NULL, 0}
+
+#if YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE
+
+/** Start timing a critical section in C, just after interrupts are disabled */
+#define MBED_CRITICAL_PROFILE_ENTER() \
+    static mbed_critical_site_t mbed_critical_site_ = MBED_CRITICAL_SITE_INIT; \
+    uint32_t mbed_critical_start_ = mbed_critical_profile_clock()
+
+/** Stop timing a critical section in C, just before interrupts are enabled */
+#define MBED_CRITICAL_PROFILE_EXIT() \
+    mbed_critical_profile_record(&mbed_critical_site_, mbed_critical_start_, MBED_CRITICAL_CALLER)
+
+#ifdef __cplusplus
+/** Time a critical section in C++ until the end of the scope. It must follow the CriticalSectionLock, so that it is
+ *  destroyed before the lock is.
+ */
+#define MBED_CRITICAL_PROFILE() \
+    static mbed_critical_site_t mbed_critical_site_ = MBED_CRITICAL_SITE_INIT; \
+    mbed::CriticalProfileScope mbed_critical_scope_(&mbed_critical_site_, MBED_CRITICAL_CALLER)
+
+namespace mbed {
+
+class CriticalProfileScope {
+public:
+    CriticalProfileScope(mbed_critical_site_t *site, void *caller) :
+        _site(site), _caller(caller), _start(mbed_critical_profile_clock()) {}
+    ~CriticalProfileScope() {
+        mbed_critical_profile_record(_site, _start, _caller);
+    }
+private:
+    mbed_critical_site_t *_site;
+    void *_caller;
+    uint32_t _start;
+};
+
+} // namespace mbed
+#endif
+
+#else
+
+#define MBED_CRITICAL_PROFILE_ENTER()
+#define MBED_CRITICAL_PROFILE_EXIT()
+#define MBED_CRITICAL_PROFILE()
+
+#endif
+
+#endif
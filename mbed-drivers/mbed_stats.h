@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_STATS_H
+#define MBED_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Driver runtime statistics, set with YOTTA_CFG_MBED_DRIVERS_STATS
+ *
+ *  When enabled, the drivers keep counters in named groups: "spi", "i2c" and
+ *  "serial" for the v1 drivers, one group per peripheral for the v2 resource
+ *  managers ("spi0", "i2c1", ...), "interrupts" for the InterruptManager and
+ *  "ticker" for the ticker queues. A group is registered the first time one
+ *  of its counters changes, and can be read with mbed_stats_find(), or as
+ *  text through a StatsFileSystem, as in fopen("/stats/spi0", "r").
+ *
+ *  Each update is a single atomic add, made with an exclusive access on cores
+ *  that have them, and with interrupts masked for a few instructions on
+ *  others. Counters are not updated together, so a snapshot taken while a
+ *  transfer completes may count the transfer in one counter and not yet in
+ *  another.
+ */
+#ifndef YOTTA_CFG_MBED_DRIVERS_STATS
+#define YOTTA_CFG_MBED_DRIVERS_STATS 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The counters kept by each group */
+enum mbed_stats_counter {
+    /** Operations started: transfers for the bus drivers, interrupts dispatched by the InterruptManager and events
+     *  fired from the ticker queues */
+    MBED_STATS_TRANSFERS = 0,
+    /** Bytes in the transfers made, counted as each transfer starts or, for the v2 drivers, as each segment ends */
+    MBED_STATS_BYTES,
+    /** Transfers that ended with an error event */
+    MBED_STATS_ERRORS,
+    /** The most transfers waiting in the driver's queue at once */
+    MBED_STATS_QUEUE_HIGH_WATER,
+    /** Transfers whose completion time was measured */
+    MBED_STATS_COMPLETIONS,
+    /** The sum of the completion times in microseconds; for the ticker, how late events fired */
+    MBED_STATS_LATENCY_US,
+    MBED_STATS_COUNTERS
+};
+
+typedef struct mbed_stats {
+    const char *name;
+    volatile uint32_t counters[MBED_STATS_COUNTERS];
+    /* The next registered group */
+    struct mbed_stats *next;
+    uint8_t listed;
+} mbed_stats_t;
+
+/** A static initializer for a group */
+#define MBED_STATS_INIT(name) {(name), {0}, NULL, 0}
+
+/** Initialize a group that is not statically initialized
+ *  @param stats The group
+ *  @param name The name of the group; it is not copied
+ */
+void mbed_stats_init(mbed_stats_t *stats, const char *name);
+
+/** Add to a counter, registering the group if it is not already. It may be called from any context.
+ *  @param stats The group
+ *  @param counter The counter
+ *  @param n The amount to add
+ */
+void mbed_stats_add(mbed_stats_t *stats, unsigned counter, uint32_t n);
+
+/** Raise a counter to a value, if it is lower. It may be called from any context.
+ *  @param stats The group
+ *  @param counter The counter
+ *  @param value The new value
+ */
+void mbed_stats_max(mbed_stats_t *stats, unsigned counter, uint32_t value);
+
+/** Count a completion and its latency
+ *  @param stats The group
+ *  @param start The mbed_stats_clock() time the transfer was started
+ */
+void mbed_stats_complete(mbed_stats_t *stats, uint32_t start);
+
+/** The clock that latencies are measured with, in microseconds */
+uint32_t mbed_stats_clock(void);
+
+/** Find a registered group
+ *  @param name The name of the group
+ *  @returns The group, or NULL if no group of that name has been registered
+ */
+mbed_stats_t *mbed_stats_find(const char *name);
+
+/** Get the registered groups
+ *  @returns The most recently registered group; the rest follow through next
+ */
+mbed_stats_t *mbed_stats_groups(void);
+
+/** Write a group's counters as text, one "name value" line per counter, followed by the average latency
+ *  @param stats The group
+ *  @param buffer The buffer to write to
+ *  @param size The size of the buffer
+ *  @returns The length of the text, which is truncated if it does not fit, as for snprintf
+ */
+int mbed_stats_format(const mbed_stats_t *stats, char *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+#define MBED_STATS_ADD(stats, counter, n)     mbed_stats_add((stats), (counter), (uint32_t)(n))
+#define MBED_STATS_MAX(stats, counter, value) mbed_stats_max((stats), (counter), (uint32_t)(value))
+#define MBED_STATS_START(start)               ((start) = mbed_stats_clock())
+#define MBED_STATS_COMPLETE(stats, start)     mbed_stats_complete((stats), (start))
+#else
+#define MBED_STATS_ADD(stats, counter, n)     ((void)0)
+#define MBED_STATS_MAX(stats, counter, value) ((void)0)
+#define MBED_STATS_START(start)               ((void)0)
+#define MBED_STATS_COMPLETE(stats, start)     ((void)0)
+#endif
+
+#endif
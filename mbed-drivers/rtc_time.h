@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 #include <time.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +27,10 @@ extern "C" {
  * on the microcontroller Real-Time Clock (RTC), plus some
  * standard C manipulation and formating functions.
  *
+ * The RTC is only read when the time is first needed; from then on the
+ * time is kept by the microsecond ticker and periodically checked against
+ * the RTC, so reading it is cheap and has microsecond resolution.
+ *
  * Example:
  * @code
  * #include "mbed.h"
@@ -69,6 +74,12 @@ extern "C" {
  */
 void set_time(time_t t);
 
+/** Get the current time in microseconds
+ *
+ * @returns Number of microseconds since January 1, 1970
+ */
+uint64_t time_us(void);
+
 #ifdef __cplusplus
 }
 #endif
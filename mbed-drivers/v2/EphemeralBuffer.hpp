@@ -138,6 +138,176 @@ public:
     static constexpr size_t ephemeralSize = sizeof(_data);
 
 };
+
+/**
+ * A variant of EphemeralBuffer with an inline capacity of N bytes.
+ *
+ * EphemeralBuffer packs its data into the pointer and length fields, so it costs no more than a Buffer but can only
+ * hold 7 bytes inline on a 32-bit target. SizedEphemeralBuffer overlays the data on the pointer alone and keeps the
+ * length separately, so it holds N bytes inline in (N rounded up to a word) + 4 bytes on a 32-bit target:
+ *
+ * | Type                      | Inline capacity | sizeof (32-bit) |
+ * |---------------------------|-----------------|-----------------|
+ * | EphemeralBuffer           | 7               | 8               |
+ * | SizedEphemeralBuffer<8>   | 8               | 12              |
+ * | SizedEphemeralBuffer<12>  | 12              | 16              |
+ * | SizedEphemeralBuffer<16>  | 16              | 20              |
+ *
+ * get_buf() and get_len() cost the same as in EphemeralBuffer: a test of the ephemeral flag. set_ephemeral() copies
+ * the data, which for a 16-byte frame is much cheaper than allocating, and later freeing, a buffer for it.
+ *
+ * Use EphemeralBufferOf<N> to get the smallest of the two that holds N bytes.
+ */
+template <size_t N>
+class SizedEphemeralBuffer {
+    static_assert(N >= sizeof(void *), "Use EphemeralBuffer for inline capacities smaller than a pointer");
+public:
+    /**
+     * @brief Default constructor
+     * Initializes the buffer to ephemeral mode with a buffer length of N, so that it can be used to receive data.
+     */
+    SizedEphemeralBuffer() : _len(N), _ephemeral(true) {}
+
+    /**
+     * @brief Copy constructor
+     * Duplicates the incoming buffer: ephemeral data is copied, other buffers share the pointer.
+     *
+     * @param[in] x the buffer to copy
+     */
+    SizedEphemeralBuffer(const SizedEphemeralBuffer & x) : _len(x._len), _ephemeral(x._ephemeral)
+    {
+        if (is_ephemeral()) {
+            std::memcpy(_data, x._data, _len);
+        } else {
+            _dataPtr = x._dataPtr;
+        }
+    }
+
+    /**
+     * Set buffer pointer and length.
+     *
+     * @param[in] b A buffer to duplicate
+     */
+    void set(const Buffer & b)
+    {
+        set(b.buf, b.length);
+    }
+
+    /**
+     * Set buffer pointer and length.
+     * If the buffer is N or fewer bytes, copy it into the contents of the SizedEphemeralBuffer
+     * instead of keeping a pointer to it.
+     *
+     * @param[in] b A buffer to duplicate
+     */
+    void set_ephemeral(const Buffer & b)
+    {
+        set_ephemeral(b.buf, b.length);
+    }
+
+    /**
+     * Set the buffer pointer and length
+     *
+     * @param[in] buf the buffer pointer to duplicate
+     * @param[in] len the length of the buffer to duplicate
+     */
+    void set(void *buf, std::size_t len)
+    {
+        _ephemeral = false;
+        _len = len;
+        _dataPtr = buf;
+    }
+
+    /**
+     * Set buffer pointer and length.
+     * If the buffer is N or fewer bytes, copy it into the contents of the SizedEphemeralBuffer
+     * instead of keeping a pointer to it.
+     *
+     * @param[in] buf the buffer pointer to duplicate
+     * @param[in] len the length of the buffer to duplicate
+     */
+    void set_ephemeral(void *buf, std::size_t len)
+    {
+        if (len <= N) {
+            _ephemeral = true;
+            _len = len;
+            if (buf) {
+                std::memcpy(_data, buf, len);
+            }
+        } else {
+            set(buf, len);
+        }
+    }
+
+    /**
+     * Get a pointer to the buffer.
+     *
+     * @return the buffer pointer
+     */
+    void * get_buf()
+    {
+        return _ephemeral ? _data : _dataPtr;
+    }
+
+    /**
+     * Get the length
+     *
+     * @return the length of the buffer
+     */
+    std::size_t get_len() const
+    {
+        return _len;
+    }
+
+    /**
+     * Check if the buffer is ephemeral.
+     *
+     * @retval true The buffer contains data, rather than a pointer
+     * @retval false The buffer contains a pointer to data
+     */
+    bool is_ephemeral() const
+    {
+        return _ephemeral;
+    }
+
+protected:
+    union {
+        void * _dataPtr;
+        std::uint8_t _data[N];
+    };
+    std::size_t _len:(sizeof(size_t)*8-1);
+    std::size_t _ephemeral:1;
+public:
+    /**
+     * A constant that indicates the maximum size of the buffer in ephemeral mode.
+     */
+    static constexpr size_t ephemeralSize = N;
+};
+
+/* Pin the sizes in the table above, and their 64-bit counterparts of 16, 16, 24 and 24 bytes */
+static_assert(sizeof(EphemeralBuffer) == sizeof(void *) + sizeof(size_t), "EphemeralBuffer should be no larger than a Buffer");
+static_assert(sizeof(SizedEphemeralBuffer<8>) == (sizeof(void *) == 4 ? 12 : 16), "Unexpected SizedEphemeralBuffer<8> size");
+static_assert(sizeof(SizedEphemeralBuffer<12>) == (sizeof(void *) == 4 ? 16 : 24), "Unexpected SizedEphemeralBuffer<12> size");
+static_assert(sizeof(SizedEphemeralBuffer<16>) == (sizeof(void *) == 4 ? 20 : 24), "Unexpected SizedEphemeralBuffer<16> size");
+
+namespace detail {
+template <size_t N, bool Packed = (N <= EphemeralBuffer::ephemeralSize)>
+struct EphemeralBufferSelect {
+    typedef SizedEphemeralBuffer<N> type;
+};
+template <size_t N>
+struct EphemeralBufferSelect<N, true> {
+    typedef EphemeralBuffer type;
+};
+} // namespace detail
+
+/**
+ * The smallest ephemeral buffer type that holds N bytes inline: EphemeralBuffer up to
+ * EphemeralBuffer::ephemeralSize bytes, SizedEphemeralBuffer<N> above that.
+ */
+template <size_t N>
+using EphemeralBufferOf = typename detail::EphemeralBufferSelect<N>::type;
+
 } // namespace v2
 } // namespace drivers
 } // namespace mbed
@@ -70,8 +70,9 @@ const size_t I2C_TRANSACTION_NHANDLERS = 4;
  * The ```tx()``` members add a buffer to send to the transfer.
  *
  * The ```rx()``` members add a buffer to receive into to the transfer. There is a special case of ```rx()```, which
- * doesn't use a normal buffer. When ```rx(size_t)``` is called with a size of less than 8 bytes, the underlying
- * EphermeralBuffer is placed in ephemeral mode. This means that no preallocated receive buffer is needed, instead the
+ * doesn't use a normal buffer. When ```rx(size_t)``` is called with a size of up to
+ * YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE bytes (7 by default), the underlying EphermeralBuffer is placed in
+ * ephemeral mode. This means that no preallocated receive buffer is needed, instead the
  * data is packed directly into the EphemeralBuffer. This has a side-effect that the data will be freed once the last
  * event handler has exited, so if the data must be retained, it should be copied out.
  *
@@ -147,6 +148,14 @@ public:
      */
     using event_callback_t = detail::I2C_event_callback_t;
 
+    /** Transaction completion callback, run in IRQ context
+     *  @param The transaction that has just completed
+     *  @param the event that completed it
+     *  @retval true to run the transaction again immediately; the event handlers are not called
+     *  @retval false to complete the transaction as normal
+     */
+    using DoneCallback = mbed::util::FunctionPointer2<bool, I2CTransaction *, uint32_t>;
+
     /**
      * Construct an I2C transaction and set the destination address at the same time
      *
@@ -185,6 +194,29 @@ public:
      */
     void append(I2CTransaction *t);
 
+    /**
+     * Set the callback to run in IRQ context when the transaction completes
+     *
+     * This allows a transaction to be reused without returning to minar in between, for example to probe a range of
+     * addresses. The callback may modify the transaction before asking for it to be run again.
+     *
+     * @param[in] cb the callback, or an unbound callback for none
+     */
+    void set_done_irq_cb(const DoneCallback & cb)
+    {
+        _doneCB = cb;
+    }
+
+    /**
+     * Run the completion callback, if there is one
+     * @param[in] event the event that completed the transaction
+     * @retval true if the transaction should be run again
+     */
+    bool call_done_irq_cb(uint32_t event)
+    {
+        return _doneCB && _doneCB(this, event);
+    }
+
     /**
      * Forwards the irq-context callback to the segment
      * Also adds a pointer to this transaction to the callback
@@ -272,6 +304,15 @@ public:
         return _address;
     }
 
+    /**
+     * Set the transaction target address
+     * @param[in] address the new target address
+     */
+    void address(uint16_t address)
+    {
+        _address = address;
+    }
+
 protected:
     /**
      * The next transaction in the queue
@@ -311,6 +352,52 @@ protected:
     I2C * _issuer;
     /// An array of I2C Event Handlers.
     detail::I2CEventHandler _handlers[I2C_TRANSACTION_NHANDLERS];
+    /// The callback to run in IRQ context on completion
+    DoneCallback _doneCB;
+};
+
+/**
+ * The result of an I2C bus scan
+ *
+ * Holds one bit for each 7-bit address, set if a device acknowledged it. The I2CScan is filled in from IRQ context
+ * while the scan runs, so it must stay valid until the scan's completion handler has been called.
+ */
+class I2CScan {
+public:
+    I2CScan();
+
+    /**
+     * Test whether a device acknowledged an address
+     * @param[in] address the 7-bit address
+     */
+    bool present(uint8_t address) const;
+
+    /**
+     * Count the devices found
+     */
+    size_t count() const;
+
+    /**
+     * Access the bitmap of devices found
+     * @return 4 words; bit (address % 32) of word (address / 32) is set if the address was acknowledged
+     */
+    const uint32_t * bitmap() const
+    {
+        return _found;
+    }
+
+protected:
+    friend I2C;
+
+    /// Prepare to scan the addresses first to last
+    void reset(uint8_t first, uint8_t last);
+
+    /// Record the result of probing the current address and move on to the next
+    bool probed(I2CTransaction *t, uint32_t event);
+
+    uint32_t _found[4];
+    uint8_t _next;
+    uint8_t _last;
 };
 
 /** An I2C Master, used for communicating with I2C slave devices
@@ -368,6 +455,17 @@ public:
      */
     I2C(PinName sda, PinName scl, mbed::util::PoolAllocator *TransactionPool, mbed::util::PoolAllocator *SegmentPool);
 
+    /** Create an I2C Master interface on a specific resource manager, such as a SoftI2CResourceManager
+     *
+     *  @param sda I2C data line pin
+     *  @param scl I2C clock line pin
+     *  @param owner The resource manager that runs the transactions
+     *  @param TransactionPool An IRQ-safe allocator for Transaction objects, or nullptr
+     *  @param SegmentPool An IRQ-safe allocator for Segment objects, or nullptr
+     */
+    I2C(PinName sda, PinName scl, detail::I2CResourceManager &owner,
+        mbed::util::PoolAllocator *TransactionPool = nullptr, mbed::util::PoolAllocator *SegmentPool = nullptr);
+
     /** Destroy the I2C Master interface.
      *  Releases a reference to the I2C Resource Manager
      */
@@ -462,7 +560,8 @@ public:
         /**
          * @brief Add an ephermeral transmit buffer to the transaction
          *
-         * If the buffer is 7 or fewer bytes, it will be managed internally, so the original can be freed.
+         * If the buffer is YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE or fewer bytes, it will be managed internally, so
+         * the original can be freed.
          *
          * @param[in] buf a pointer to the buffer to send
          * @param[in] len the number of bytes to send
@@ -487,7 +586,7 @@ public:
         /**
          * @brief Add an ephermeral receive buffer to the transaction
          *
-         * If the buffer is 7 or fewer bytes, it will be managed internally
+         * If the buffer is YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE or fewer bytes, it will be managed internally
          *
          * @param[in] len the number of bytes to receive
          */
@@ -534,6 +633,21 @@ public:
      */
     TransferAdder transfer_to_irqsafe(int address);
 
+    /**
+     * @brief Scan the bus for devices
+     *
+     * Probes each 7-bit address from first to last with a zero-length write. The probes run back to back from the
+     * I2C interrupt, reusing a single transaction, which is taken from the transaction pool if there is one. The
+     * result is recorded in the I2CScan, and done is called once, in minar context, when the scan completes.
+     *
+     * @param[out] result the scan result
+     * @param[in] done the handler to call when the scan completes
+     * @param[in] first the first address to probe; the default skips the reserved addresses
+     * @param[in] last the last address to probe
+     * @return the status of queuing the scan
+     */
+    I2CError scan(I2CScan &result, const event_callback_t &done, uint8_t first = 0x08, uint8_t last = 0x77);
+
     /**
      * @brief Create a new segment
      *
@@ -568,6 +682,11 @@ public:
 protected:
     friend TransferAdder;
 
+    /**
+     * @brief Select the resource manager for the pins and take a reference to it
+     */
+    void init(PinName sda, PinName scl);
+
     /**
      * @brief Initiate a transaction
      *
@@ -23,6 +23,16 @@
 #include "EphemeralBuffer.hpp"
 #include "core-util/FunctionPointer.h"
 #include "PinNames.h"
+#include "mbed-drivers/mbed_stats.h"
+
+/**
+ * The number of bytes an I2CSegment holds inline, for tx_ephemeral() and rx(size_t). The default fits in the space of
+ * a pointer and a length; larger values let whole command frames be sent without keeping the caller's buffer alive, at
+ * the cost of a larger segment (see SizedEphemeralBuffer).
+ */
+#ifndef YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE
+#define YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE (sizeof(void *) + sizeof(size_t) - 1)
+#endif
 
 namespace mbed {
 namespace drivers {
@@ -33,6 +43,9 @@ class I2CTransaction;
 namespace detail {
 enum class I2CDirection {Transmit, Receive};
 
+/// The buffer type of an I2CSegment
+typedef EphemeralBufferOf<YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE> I2CSegmentBuffer;
+
 /** I2C transfer callback
  *  @param The transaction that was running when the callback was triggered
  *  @param The event that triggered the calback
@@ -47,7 +60,7 @@ typedef mbed::util::FunctionPointer2<void, I2CTransaction *, uint32_t> I2C_event
  * executes in IRQ context. This allows for I2C transactions to be modified on the fly. For example, it might be useful
  * in some protocols to read a length, then transfer the number of bytes specified by the length.
  */
-class I2CSegment : public EphemeralBuffer {
+class I2CSegment : public I2CSegmentBuffer {
 public:
     /**
      * I2C transfer callback
@@ -56,7 +69,7 @@ public:
      */
     using IRQCallback = mbed::util::FunctionPointer2<void, I2CSegment *, uint32_t>;
     I2CSegment() :
-        EphemeralBuffer(), _next(nullptr), _irqCB(nullptr)
+        I2CSegmentBuffer(), _next(nullptr), _irqCB(nullptr)
     {}
 
     /**
@@ -72,7 +85,7 @@ public:
      * @param[in] s the I2CSegment to copy
      */
     I2CSegment(const I2CSegment & s) :
-        EphemeralBuffer(static_cast<const EphemeralBuffer &>(s)), _dir(s._dir), _next(nullptr), _irqCB(s._irqCB)
+        I2CSegmentBuffer(static_cast<const I2CSegmentBuffer &>(s)), _dir(s._dir), _next(nullptr), _irqCB(s._irqCB)
     {}
 
     /**
@@ -82,7 +95,7 @@ public:
      * @param[in] rref The I2CSegment to move from
      */
     I2CSegment(I2CSegment && rref) :
-        EphemeralBuffer(static_cast<EphemeralBuffer &&>(rref)), _dir(rref._dir), _next(rref._next), _irqCB(rref._irqCB)
+        I2CSegmentBuffer(static_cast<I2CSegmentBuffer &&>(rref)), _dir(rref._dir), _next(rref._next), _irqCB(rref._irqCB)
     {}
 
     /**
@@ -295,6 +308,16 @@ protected:
 
     // The head of the transaction queue
     I2CTransaction * volatile _TransactionQueue;
+
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    // The counters for this logical master, which derived resource managers may rename, as "i2c0" for example
+    mbed_stats_t _stats;
+    char _stats_name[8];
+    // When the transaction at the head of the queue was started
+    uint32_t _stats_start;
+    // The number of transactions in the queue
+    uint32_t _stats_queued;
+#endif
 };
 
 I2CResourceManager * get_i2c_owner(int I);
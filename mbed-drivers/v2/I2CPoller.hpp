@@ -0,0 +1,214 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_I2CPOLLER_HPP
+#define MBED_DRIVERS_V2_I2CPOLLER_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+
+#include "mbed-drivers/TimerEvent.h"
+#include "core-util/FunctionPointer.h"
+#include "I2C.hpp"
+
+/// The largest sample that an I2CPoller entry can read, in bytes
+#ifndef YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE
+#define YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE 8
+#endif
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+/** A periodic poller for many I2C devices on one bus
+ *
+ * Each I2CPoller::Entry describes one poll: a command written to a device and a sample read back, repeated every
+ * ```period``` ticks. The poller runs on a single TimerEvent that fires once per tick. Entries are aligned to the
+ * tick count, so an entry with a period of 4 ticks is always polled on the same tick as those with periods of 1 and
+ * 2; all the polls that are due on a tick are queued on the bus together, in one critical section, and run back to
+ * back. This replaces one Ticker per device, and the unaligned wakeups and bus contention that come with them.
+ *
+ * Transactions are built in IRQ context, so the I2C master must have been created with transaction and segment
+ * pools. Each poll takes one transaction and two segments from the pools.
+ *
+ * Each entry has two sample slots. The device is read into the back slot; when the read completes, the slots are
+ * swapped in minar context and the entry's handler is called. A sample can be read at any time with
+ * ```Entry::sample()```. If an entry's previous poll has not completed when it is next due, the poll is skipped and
+ * counted as an overrun.
+ *
+ * @code
+ * static uint8_t xact_space[4 * sizeof(mbed::drivers::v2::I2CTransaction)];
+ * static mbed::util::PoolAllocator xacts(xact_space, 4, sizeof(mbed::drivers::v2::I2CTransaction));
+ * static uint8_t seg_space[8 * sizeof(mbed::drivers::v2::detail::I2CSegment)];
+ * static mbed::util::PoolAllocator segs(seg_space, 8, sizeof(mbed::drivers::v2::detail::I2CSegment));
+ *
+ * mbed::drivers::v2::I2C i2c(p28, p27, &xacts, &segs);
+ * mbed::drivers::v2::I2CPoller poller(i2c, 10000);             // 10ms ticks
+ * mbed::drivers::v2::I2CPoller::Entry accel(0x3A, "\xA8", 1, 6, 1);   // 100Hz
+ * mbed::drivers::v2::I2CPoller::Entry temp(0x90, "\x00", 1, 2, 50);   // 2Hz
+ *
+ * void app_start(int, char **) {
+ *     poller.add(accel);
+ *     poller.add(temp);
+ *     poller.start();
+ * }
+ * @endcode
+ */
+class I2CPoller : protected mbed::TimerEvent {
+public:
+    class Entry;
+
+    /** Sample handler
+     *  @param The entry with a new sample
+     */
+    typedef mbed::util::FunctionPointer1<void, Entry *> sample_callback_t;
+
+    /**
+     * @brief One device poll
+     */
+    class Entry {
+    public:
+        /**
+         * @param[in] address the I2C address of the device, as passed to I2C::transfer_to()
+         * @param[in] cmd the command to write before reading, or nullptr; it must stay valid while the entry is polled
+         * @param[in] cmd_len the length of the command
+         * @param[in] sample_len the number of bytes to read, at most YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE
+         * @param[in] period the poll period, in poller ticks
+         */
+        Entry(uint16_t address, const void *cmd, size_t cmd_len, size_t sample_len, uint32_t period);
+
+        /**
+         * @brief Set the handler called, in minar context, for each new sample
+         */
+        void on_sample(const sample_callback_t &cb);
+
+        /**
+         * @brief Copy the latest sample
+         *
+         * This can be called from any context.
+         *
+         * @param[out] buf the buffer to copy into, at least sample_len bytes long
+         * @return the sequence number of the sample, or 0 if there has not been a sample yet
+         */
+        uint32_t sample(void *buf) const;
+
+        /**
+         * @brief Get the latest sample in place
+         *
+         * The data is stable until the next sample is delivered, so it can be used from minar context without a copy.
+         */
+        const uint8_t * latest() const
+        {
+            return _slots[_front];
+        }
+
+        /**
+         * @brief Get the number of samples delivered
+         */
+        uint32_t sequence() const
+        {
+            return _sequence;
+        }
+
+        /**
+         * @brief Get the number of polls that failed
+         */
+        uint32_t errors() const
+        {
+            return _errors;
+        }
+
+        /**
+         * @brief Get the number of polls skipped because the previous poll had not completed
+         */
+        uint32_t overruns() const
+        {
+            return _overruns;
+        }
+
+    protected:
+        friend I2CPoller;
+
+        void complete(I2CTransaction *t, uint32_t event);
+
+        Entry * _next;
+        uint16_t _address;
+        const void * _cmd;
+        size_t _cmd_len;
+        size_t _sample_len;
+        uint32_t _period;
+        sample_callback_t _on_sample;
+        volatile bool _busy;
+        volatile uint8_t _front;
+        volatile uint32_t _sequence;
+        volatile uint32_t _errors;
+        volatile uint32_t _overruns;
+        uint8_t _slots[2][YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE];
+    };
+
+    /**
+     * @param[in] i2c the I2C master, which must have transaction and segment pools
+     * @param[in] tick_us the poller tick, in microseconds
+     */
+    I2CPoller(I2C &i2c, uint32_t tick_us);
+
+    virtual ~I2CPoller();
+
+    /**
+     * @brief Add an entry to the poller
+     *
+     * The entry must not be destroyed while it is in the poller, or while its last poll is in progress.
+     */
+    void add(Entry &e);
+
+    /**
+     * @brief Remove an entry from the poller
+     */
+    void remove(Entry &e);
+
+    /**
+     * @brief Start polling
+     */
+    void start();
+
+    /**
+     * @brief Stop polling
+     *
+     * Polls that have already been queued are completed.
+     */
+    void stop();
+
+protected:
+    virtual void handler();
+
+    /// Queue the poll of an entry; called in a critical section
+    void post(Entry *e);
+
+    I2C & _i2c;
+    uint32_t _tick_us;
+    uint32_t _tick;
+    Entry * _entries;
+    bool _running;
+};
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_I2C && DEVICE_I2C_ASYNCH
+
+#endif // MBED_DRIVERS_V2_I2CPOLLER_HPP
@@ -0,0 +1,253 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_I2CSLAVE_HPP
+#define MBED_DRIVERS_V2_I2CSLAVE_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_I2CSLAVE && DEVICE_I2C_ASYNCH
+
+#include "mbed-hal/i2c_api.h"
+#include "minar/minar.h"
+#include "core-util/FunctionPointer.h"
+#include "core-util/PoolAllocator.h"
+#include "I2C.hpp"
+
+/// The interval at which the slave polls the bus for a request, in milliseconds
+#ifndef YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_POLL_INTERVAL_MS
+#define YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_POLL_INTERVAL_MS 10
+#endif
+
+/// The longest write, including the register address byte, that the slave accepts
+#ifndef YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_BUFFER_SIZE
+#define YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_BUFFER_SIZE 32
+#endif
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+namespace detail {
+
+/**
+ * @brief The bus side of an I2C slave
+ *
+ * I2CSlave only talks to the bus through this interface, so it can be driven by a simulated bus as well as by the
+ * HAL. The request codes are those returned by i2c_slave_receive().
+ */
+class I2CSlaveBus {
+public:
+    enum Request {
+        NoData         = 0,
+        ReadAddressed  = 1,
+        WriteGeneral   = 2,
+        WriteAddressed = 3
+    };
+
+    virtual ~I2CSlaveBus() {}
+
+    /**
+     * @brief Set the 7-bit address to respond to
+     */
+    virtual void address(uint8_t address) = 0;
+
+    /**
+     * @brief Set the bus frequency
+     */
+    virtual void frequency(uint32_t hz) = 0;
+
+    /**
+     * @brief Check whether the slave has been addressed
+     * @return one of the Request codes
+     */
+    virtual int receive() = 0;
+
+    /**
+     * @brief Receive the data of a write from the master
+     * @return the number of bytes received
+     */
+    virtual int read(uint8_t *buf, size_t len) = 0;
+
+    /**
+     * @brief Send data in response to a read from the master
+     * @return the number of bytes the master accepted
+     */
+    virtual int write(const uint8_t *buf, size_t len) = 0;
+};
+
+/**
+ * @brief An I2CSlaveBus on an on-chip I2C peripheral
+ */
+class HWI2CSlaveBus : public I2CSlaveBus {
+public:
+    HWI2CSlaveBus(PinName sda, PinName scl);
+    virtual void address(uint8_t address);
+    virtual void frequency(uint32_t hz);
+    virtual int receive();
+    virtual int read(uint8_t *buf, size_t len);
+    virtual int write(const uint8_t *buf, size_t len);
+protected:
+    i2c_t _i2c;
+};
+
+} // namespace detail
+
+/** An I2C slave with a register map
+ *
+ * The slave presents a block of memory to the bus master as a register map, in the usual style of I2C peripherals:
+ *
+ * * a write from the master starts with a register address, which sets the register pointer, and any further bytes
+ *   are stored in the map starting at that register
+ * * a read from the master returns the contents of the map starting at the register pointer
+ *
+ * The register pointer advances past every byte written to or read from the map, and stops at its end, so that
+ * further reads see an idle bus (0xFF); in a full 256-byte map it wraps to 0. The map must already hold the data the
+ * master will read; a response can also be pre-staged with ```stage()```, which overrides the map for the next read
+ * only. General call writes are received and discarded.
+ *
+ * After each request, the on_write() or on_read() handler is posted to minar with the register and length. When a
+ * PoolAllocator of I2CSegments is supplied with ```segment_pool()```, each write is also copied into a pooled segment
+ * (if it fits in the segment's inline buffer, see YOTTA_CFG_MBED_DRIVERS_I2C_EPHEMERAL_SIZE), so the handler sees the
+ * data as written even if the master has written again since. The segment is freed when the handler returns.
+ *
+ * The HAL only provides a polled slave API, whose transfers block until the master has finished, so once
+ * ```start()``` has been called the slave polls the bus from minar, rather than in IRQ context, every
+ * YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_POLL_INTERVAL_MS. The master is held off by clock stretching until the request is
+ * served, so a shorter interval gives faster responses at the cost of more wakeups.
+ *
+ * @code
+ * uint8_t regs[16] = {0x42};   // WHO_AM_I at register 0
+ * mbed::drivers::v2::I2CSlave slave(p28, p27, 0x30);
+ *
+ * void written(uint8_t reg, size_t len, mbed::drivers::v2::detail::I2CSegment *) {
+ *     if (reg <= 4 && reg + len > 4) {
+ *         apply_config(regs[4]);
+ *     }
+ * }
+ *
+ * void app_start(int, char **) {
+ *     slave.registers(regs, sizeof(regs));
+ *     slave.on_write(written);
+ *     slave.start();
+ * }
+ * @endcode
+ */
+class I2CSlave {
+public:
+    /** Write handler
+     *  @param The register address that the master wrote to
+     *  @param The number of data bytes written, not counting the register address
+     *  @param The data, or nullptr if there is no segment pool or the data did not fit in a segment
+     */
+    typedef mbed::util::FunctionPointer3<void, uint8_t, size_t, detail::I2CSegment *> write_callback_t;
+
+    /** Read handler
+     *  @param The register address that the master read from
+     *  @param The number of bytes the master read
+     */
+    typedef mbed::util::FunctionPointer2<void, uint8_t, size_t> read_callback_t;
+
+    /** Create an I2C slave on an on-chip I2C peripheral
+     *
+     *  @param sda I2C data line pin
+     *  @param scl I2C clock line pin
+     *  @param address the 7-bit slave address
+     */
+    I2CSlave(PinName sda, PinName scl, uint8_t address);
+
+    /** Create an I2C slave on any I2CSlaveBus
+     *
+     *  @param bus the bus to serve; it is not owned by the I2CSlave
+     *  @param address the 7-bit slave address
+     */
+    I2CSlave(detail::I2CSlaveBus *bus, uint8_t address);
+
+    virtual ~I2CSlave();
+
+    /** Set the memory presented as the register map
+     *
+     *  @param map the register map
+     *  @param size the size of the map in bytes, at most 256
+     */
+    void registers(void *map, size_t size);
+
+    /** Pre-stage the response to the next read
+     *
+     *  The buffer is sent instead of the register map for the next read from the master only. It must stay valid
+     *  until then.
+     *
+     *  @param buf the data to send
+     *  @param len the number of bytes to send
+     */
+    void stage(const void *buf, size_t len);
+
+    /** Set the pool that write data is copied into
+     *
+     *  @param pool a PoolAllocator with elements of sizeof(detail::I2CSegment) bytes, or nullptr
+     */
+    void segment_pool(mbed::util::PoolAllocator *pool);
+
+    /** Set the handler for writes from the master
+     */
+    void on_write(const write_callback_t &cb);
+
+    /** Set the handler for reads by the master
+     */
+    void on_read(const read_callback_t &cb);
+
+    /** Start polling the bus
+     */
+    void start();
+
+    /** Stop polling the bus
+     */
+    void stop();
+
+    /** Serve at most one bus request
+     *
+     *  This is called from minar once started; it can also be called directly, for example to drive the slave from a
+     *  simulated bus. It must not be called from IRQ context.
+     */
+    void poll();
+
+protected:
+    void serve_read();
+    void serve_write(bool general);
+
+    void deliver_write(uint8_t reg, size_t len, detail::I2CSegment *s);
+    void deliver_read(uint8_t reg, size_t len);
+
+    detail::I2CSlaveBus * _bus;
+    bool _owns_bus;
+    uint8_t * _map;
+    size_t _size;
+    volatile uint8_t _reg;
+    const uint8_t * volatile _staged;
+    volatile size_t _staged_len;
+    mbed::util::PoolAllocator * _pool;
+    write_callback_t _on_write;
+    read_callback_t _on_read;
+    minar::callback_handle_t _poll_handle;
+    uint8_t _rx[YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_BUFFER_SIZE];
+};
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_I2CSLAVE && DEVICE_I2C_ASYNCH
+
+#endif // MBED_DRIVERS_V2_I2CSLAVE_HPP
@@ -0,0 +1,359 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_REGISTERMAP_HPP
+#define MBED_DRIVERS_V2_REGISTERMAP_HPP
+
+#include "mbed-drivers/platform.h"
+#include "core-util/FunctionPointer.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+#include "I2C.hpp"
+#endif
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+#include "SPI.hpp"
+#endif
+
+/// The longest single bus transfer a RegisterMap makes
+#ifndef YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST
+#define YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST 32
+#endif
+
+/**
+ * \file
+ * \brief A cached register map for I2C and SPI peripheral devices
+ *
+ * Most I2C and SPI peripherals are controlled through a map of 8-bit registers. RegisterMap keeps a shadow copy of
+ * the device's registers, so that reads of configuration registers, and the read half of read-modify-write updates,
+ * do not need a bus transfer:
+ *
+ * * ```refresh()``` loads registers from the device into the shadow copy
+ * * ```read()``` is answered from the shadow copy when every register in the range is cached
+ * * ```write()``` and ```update()``` change the shadow copy and mark the registers dirty; the dirty registers are
+ *   written to the device from minar, so all the updates made in one minar callback are written together, with
+ *   adjacent dirty registers coalesced into burst writes
+ * * registers marked volatile with ```set_volatile()``` (status registers, FIFOs) are never answered from the cache
+ *
+ * The device is reached through a RegisterBus. I2CRegisterBus and SPIRegisterBus adapt the v2 I2C and SPI APIs.
+ * A RegisterMap, and its RegisterBus, must only be used from minar context.
+ */
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+/**
+ * @brief The bus interface used by RegisterMap
+ *
+ * A RegisterBus only needs to support one transfer at a time.
+ */
+class RegisterBus {
+public:
+    /** Transfer completion callback
+     *  @param 0 on success, or a negative value on failure
+     */
+    typedef mbed::util::FunctionPointer1<void, int> done_t;
+
+    virtual ~RegisterBus() {}
+
+    /**
+     * @brief Read consecutive registers from the device
+     *
+     * @param[in] reg the first register
+     * @param[out] buf the buffer to read into; it must stay valid until done is called
+     * @param[in] len the number of registers to read
+     * @param[in] done called in minar context when the read is complete
+     * @return 0 if the read was started, or a negative value
+     */
+    virtual int read(uint8_t reg, void *buf, size_t len, const done_t &done) = 0;
+
+    /**
+     * @brief Write consecutive registers in the device
+     *
+     * The data is copied before write() returns.
+     *
+     * @param[in] reg the first register
+     * @param[in] buf the data to write
+     * @param[in] len the number of registers to write
+     * @param[in] done called in minar context when the write is complete
+     * @return 0 if the write was started, or a negative value
+     */
+    virtual int write(uint8_t reg, const void *buf, size_t len, const done_t &done) = 0;
+};
+
+/**
+ * @brief The register cache behind RegisterMap<N>
+ *
+ * The storage for the shadow copy and its flags is provided by the derived RegisterMap<N>.
+ */
+class RegisterCache {
+public:
+    typedef RegisterBus::done_t done_t;
+
+    /**
+     * @brief Mark registers as volatile
+     *
+     * Volatile registers change on their own, so reads of them always go to the device. Writes are still queued and
+     * coalesced like any other.
+     *
+     * @param[in] reg the first register
+     * @param[in] count the number of registers
+     */
+    void set_volatile(uint8_t reg, size_t count = 1);
+
+    /**
+     * @brief Load registers from the device into the cache
+     *
+     * @param[in] reg the first register
+     * @param[in] len the number of registers, at most YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST
+     * @param[in] done called with the result of the read
+     * @return 0 if the read was queued, or -1 if the range is invalid or another read is waiting
+     */
+    int refresh(uint8_t reg, size_t len, const done_t &done);
+
+    /**
+     * @brief Read registers
+     *
+     * If every register in the range is cached, the data is copied at once and done is posted to minar. Otherwise
+     * the registers are read from the device, after any dirty registers have been written.
+     *
+     * @param[in] reg the first register
+     * @param[out] buf the buffer to read into; it must stay valid until done is called
+     * @param[in] len the number of registers, at most YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST
+     * @param[in] done called with the result of the read
+     * @return 0 if the read was queued, or -1 if the range is invalid or another read is waiting
+     */
+    int read(uint8_t reg, void *buf, size_t len, const done_t &done);
+
+    /**
+     * @brief Write registers
+     *
+     * The cache is updated at once; the device is updated by the next flush, which is scheduled automatically.
+     *
+     * @param[in] reg the first register
+     * @param[in] buf the data to write
+     * @param[in] len the number of registers
+     * @return 0 on success, or -1 if the range is invalid
+     */
+    int write(uint8_t reg, const void *buf, size_t len);
+
+    /**
+     * @brief Read-modify-write a register in the cache
+     *
+     * Sets the bits of the register selected by mask to the corresponding bits of value. The register must be cached
+     * and not volatile, so that no bus read is needed.
+     *
+     * @param[in] reg the register
+     * @param[in] mask the bits to change
+     * @param[in] value the new value of those bits
+     * @return 0 on success, or -1 if the register is not cached
+     */
+    int update(uint8_t reg, uint8_t mask, uint8_t value);
+
+    /**
+     * @brief Get the cached value of a register
+     *
+     * @param[in] reg the register
+     * @param[out] value the cached value
+     * @return 0 on success, or -1 if the register is not cached
+     */
+    int get(uint8_t reg, uint8_t *value) const;
+
+    /**
+     * @brief Write all dirty registers to the device now
+     *
+     * @param[in] done called once there are no dirty registers, with 0 or the first write error since the flush was
+     *                 requested
+     */
+    void flush(const done_t &done);
+
+    /**
+     * @brief Drop all cached values
+     *
+     * Dirty registers are still written.
+     */
+    void invalidate();
+
+    /**
+     * @brief Check for registers that have not been written to the device yet
+     */
+    bool is_dirty() const;
+
+protected:
+    RegisterCache(RegisterBus &bus, uint8_t *shadow, uint32_t *valid, uint32_t *dirty, uint32_t *vol, size_t size);
+
+    static bool test(const uint32_t *map, size_t i)
+    {
+        return (map[i / 32] >> (i % 32)) & 1;
+    }
+    static void set(uint32_t *map, size_t i)
+    {
+        map[i / 32] |= 1UL << (i % 32);
+    }
+    static void clear(uint32_t *map, size_t i)
+    {
+        map[i / 32] &= ~(1UL << (i % 32));
+    }
+
+    /// Check that reg and len describe registers in the map
+    bool in_range(uint8_t reg, size_t len) const;
+    /// Queue a device read of the range, into buf if it is not null
+    int queue_read(uint8_t reg, void *buf, size_t len, const done_t &done);
+    /// Post a flush to minar, unless one is already posted
+    void schedule_flush();
+    /// The flush posted by schedule_flush()
+    void flush_posted();
+    /// Start the next bus transfer, if the bus is idle
+    void run();
+    /// Start writing the first run of dirty registers
+    bool write_next_run();
+    /// Handle completion of the current bus transfer
+    void bus_done(int status);
+
+    enum Operation {
+        Idle,
+        Reading,
+        Writing
+    };
+
+    RegisterBus & _bus;
+    uint8_t * _shadow;
+    uint32_t * _valid;
+    uint32_t * _dirty;
+    uint32_t * _volatile;
+    size_t _size;
+
+    Operation _op;
+    uint8_t _op_reg;
+    size_t _op_len;
+    bool _flush_posted;
+
+    // The read waiting for, or using, the bus
+    bool _rd_pending;
+    uint8_t _rd_reg;
+    size_t _rd_len;
+    void * _rd_buf;
+    done_t _rd_done;
+
+    // The flush request waiting for the dirty registers to be written
+    done_t _flush_done;
+    int _flush_status;
+
+    uint8_t _scratch[YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST];
+};
+
+/** A cached map of N registers
+ *
+ * @code
+ * mbed::drivers::v2::I2C i2c(p28, p27);
+ * mbed::drivers::v2::I2CRegisterBus accel_bus(i2c, 0x3A);
+ * mbed::drivers::v2::RegisterMap<0x40> accel(accel_bus);
+ *
+ * void loaded(int status) {
+ *     // Both updates are written in one burst, with no bus reads
+ *     accel.update(CTRL_REG1, ODR_MASK, ODR_100HZ);
+ *     accel.update(CTRL_REG2, RANGE_MASK, RANGE_4G);
+ * }
+ *
+ * void app_start(int, char **) {
+ *     accel.set_volatile(STATUS_REG);
+ *     accel.refresh(CTRL_REG1, 5, loaded);
+ * }
+ * @endcode
+ */
+template <size_t N>
+class RegisterMap : public RegisterCache {
+    static_assert(N > 0 && N <= 256, "A RegisterMap holds 1 to 256 8-bit registers");
+public:
+    /**
+     * @brief Create a register map for the device behind bus
+     */
+    RegisterMap(RegisterBus &bus) :
+        RegisterCache(bus, _regs, _flags[0], _flags[1], _flags[2], N), _regs(), _flags()
+    {}
+
+protected:
+    uint8_t _regs[N];
+    uint32_t _flags[3][(N + 31) / 32];
+};
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+/**
+ * @brief A RegisterBus for a device on a v2 I2C master
+ *
+ * Writes send the register address followed by the data; reads send the register address, then read the data
+ * with a repeated start.
+ */
+class I2CRegisterBus : public RegisterBus {
+public:
+    /**
+     * @param[in] i2c the I2C master
+     * @param[in] address the device address, as passed to I2C::transfer_to()
+     */
+    I2CRegisterBus(I2C &i2c, uint16_t address);
+
+    virtual int read(uint8_t reg, void *buf, size_t len, const done_t &done);
+    virtual int write(uint8_t reg, const void *buf, size_t len, const done_t &done);
+
+protected:
+    void complete(I2CTransaction *t, uint32_t event);
+
+    I2C & _i2c;
+    uint16_t _address;
+    done_t _done;
+    uint8_t _buf[1 + YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST];
+};
+#endif
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+/**
+ * @brief A RegisterBus for a device on a v2 SPI master
+ *
+ * Each transfer starts with a command byte, the register address ORed with read_flag or write_flag, followed by the
+ * data. Flags for address auto-increment can be included in read_flag and write_flag.
+ */
+class SPIRegisterBus : public RegisterBus {
+public:
+    /**
+     * @param[in] spi the SPI master
+     * @param[in] cs the chip select of the device
+     * @param[in] read_flag the bits to set in the command byte of a read
+     * @param[in] write_flag the bits to set in the command byte of a write
+     */
+    SPIRegisterBus(SPI &spi, DigitalOut &cs, uint8_t read_flag = 0x80, uint8_t write_flag = 0x00);
+
+    virtual int read(uint8_t reg, void *buf, size_t len, const done_t &done);
+    virtual int write(uint8_t reg, const void *buf, size_t len, const done_t &done);
+
+protected:
+    void complete(SPITransaction *t, uint32_t event);
+
+    SPI & _spi;
+    DigitalOut & _cs;
+    uint8_t _read_flag;
+    uint8_t _write_flag;
+    done_t _done;
+    uint8_t _buf[1 + YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST];
+};
+#endif
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // MBED_DRIVERS_V2_REGISTERMAP_HPP
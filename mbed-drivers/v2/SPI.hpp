@@ -0,0 +1,613 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_SPI_HPP
+#define MBED_DRIVERS_V2_SPI_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#include "mbed-hal/spi_api.h"
+#include "mbed-hal/dma_api.h"
+
+#include "mbed-drivers/DigitalOut.h"
+#include "core-util/FunctionPointer.h"
+#include "core-util/PoolAllocator.h"
+
+// Forward declarations
+namespace mbed {
+namespace drivers {
+namespace v2 {
+enum class SPIError;
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#include "SPIDetail.hpp"
+#include "EphemeralBuffer.hpp"
+
+/// There are 3 possible SPI Events, so 4 SPI transaction handlers matches the I2C API
+const size_t SPI_TRANSACTION_NHANDLERS = 4;
+
+/**
+ * \file
+ * \brief A generic interface for SPI peripherals
+ *
+ * This mirrors the v2 I2C API. The SPI class interfaces with an SPI Resource manager in order to initiate
+ * Transactions and receive events. There is one resource manager per SPI master, so SPI objects on different masters
+ * run independently, while SPI objects on the same master queue behind one another.
+ *
+ * # SPI
+ * SPI encapsulates a connection to an SPI master. The physical SPI master to use is selected via the pins provided to
+ * the constructor. The ```format()``` and ```frequency()``` APIs set the defaults for transactions issued from the SPI
+ * object. Transactions are initiated by calling ```transfer_to()``` or ```transfer_to_irqsafe()``` with the chip
+ * select of the target device. Both of these APIs create an instance of the ```TransferAdder``` helper class.
+ *
+ * # TransferAdder
+ * The ```format()``` and ```frequency()``` members override the defaults of the issuing SPI object for this
+ * transaction.
+ *
+ * The ```on()``` member allows setting up to 4 event handlers, each with a corresponding event mask.
+ *
+ * The ```tx()```, ```rx()``` and ```txrx()``` members add a segment to the transfer. Segments are transferred back to
+ * back with the chip select held active. As with I2C, ```rx(size_t)``` and ```tx_ephemeral()``` store up to
+ * EphemeralBuffer::ephemeralSize bytes inside the segment itself.
+ *
+ * The ```apply()``` method validates the transfer and adds it to the transaction queue of the SPIResourceManager.
+ *
+ * # Constructing SPI transactions
+ *
+ * ```C++
+ * SPI spi0(mosi, miso, sclk);
+ * DigitalOut flash_cs(cs, 1);
+ * void app_start (int, char **) {
+ *     spi0.transfer_to(flash_cs).tx_ephemeral("\x9f", 1).rx(3).on(SPI_EVENT_ALL, idCB);
+ * }
+ * ```
+ */
+namespace mbed {
+namespace drivers {
+namespace v2 {
+// Forward declaration of SPI
+class SPI;
+
+/**
+ * @brief List of error codes that can be produced by the SPI API
+ */
+enum class SPIError {
+    None,
+    InvalidMaster,
+    PinMismatch,
+    Busy,
+    NullTransaction,
+    NullSegment,
+    MissingPoolAllocator,
+    InvalidFormat,
+    BufferSize,
+    DeinitInProgress
+};
+
+/**
+ * A Transaction container for SPI
+ */
+class SPITransaction {
+public:
+    /** SPI transfer callback
+     *  @param The transaction that was running when the callback was triggered
+     *  @param the event that triggered the calback
+     */
+    using event_callback_t = detail::SPI_event_callback_t;
+
+    /**
+     * Construct an SPI transaction
+     *
+     * @param[in] cs the chip select to hold low for the transaction, or nullptr
+     * @param[in] bits the number of bits per frame
+     * @param[in] mode the clock polarity and phase mode (0 - 3)
+     * @param[in] order the bit order
+     * @param[in] hz the bus frequency in Hz
+     * @param[in] irqsafe set if the transaction and its segments come from pool allocators
+     * @param[in] issuer the SPI object that created the transaction
+     */
+    SPITransaction(DigitalOut *cs, uint8_t bits, uint8_t mode, spi_bitorder_t order, uint32_t hz, bool irqsafe,
+                   SPI *issuer);
+    ~SPITransaction();
+
+    /**
+     * Get a new segment to be used by the transaction.
+     * This API calls the associated SPI object's associated allocator.
+     * @return a new SPISegment
+     */
+    detail::SPISegment * new_segment();
+
+    /**
+     * Install a new event handler with the corresponding event mask
+     *
+     * @param[in] event The event mask on which to trigger cb
+     * @param[in] cb The event to trigger when one or more bits in the event mask is matched
+     * @retval false There was no space for a new event handler
+     * @retval true The new event handler was installed
+     */
+    bool add_event(uint32_t event, const event_callback_t & cb);
+
+    /**
+     * The resource manager calls this API.
+     * Calls the event handlers whose event mask matches event
+     */
+    void process_event(uint32_t event);
+
+    /**
+     * Set the next transaction in the queue
+     */
+    void append(SPITransaction *t);
+
+    /**
+     * Forwards the irq-context callback to the current segment
+     * @param[in] the event that triggered this callback
+     */
+    void call_irq_cb(uint32_t event);
+
+    /**
+     * If the current segment is valid advance the segment pointer
+     *
+     * @retval true if the current segment is valid after this operation
+     * @retval false if the current segment is not valid after this operation
+     */
+    bool advance_segment();
+
+    /**
+     * Drive the chip select, if there is one
+     * @param[in] active true to select the device (drive the pin low)
+     */
+    void select(bool active)
+    {
+        if (_cs) {
+            _cs->write(active ? 0 : 1);
+        }
+    }
+
+    /**
+     * Reset the current segment to the root segment
+     */
+    void reset_current()
+    {
+        _current  = _root;
+    }
+
+    /**
+     * Accessor for the next pointer
+     * @return the next transaction
+     */
+    SPITransaction * get_next()
+    {
+        return _next;
+    }
+
+    /**
+     * Accessor for the Transactions's issuer
+     * @return the SPI object that issued this transaction
+     */
+    SPI * get_issuer()
+    {
+        return _issuer;
+    }
+
+    /**
+     * Accessor for the current segment pointer
+     * @return the current segment poitner
+     */
+    detail::SPISegment * get_current()
+    {
+        return _current;
+    }
+
+    /**
+     * Accessor for the irqsafe flag
+     * @retval true if the transaction was allocated from the issuer's pool allocators
+     */
+    bool is_irqsafe() const
+    {
+        return _irqsafe;
+    }
+
+    /**
+     * Accessor for the transaction frequency
+     * @return the frequency of the transaction in Hz
+     */
+    uint32_t frequency() const
+    {
+        return _hz;
+    }
+
+    /**
+     * Accessor for the transaction frequency
+     * @param[in] hz the transaction frequency in Hz
+     */
+    void frequency(uint32_t hz)
+    {
+        _hz = hz;
+    }
+
+    /**
+     * Set the frame format of the transaction
+     * @param[in] bits the number of bits per frame
+     * @param[in] mode the clock polarity and phase mode (0 - 3)
+     * @param[in] order the bit order
+     */
+    void format(uint8_t bits, uint8_t mode, spi_bitorder_t order)
+    {
+        _bits = bits;
+        _mode = mode;
+        _order = order;
+    }
+
+    /// Accessor for the number of bits per frame
+    uint8_t bits() const
+    {
+        return _bits;
+    }
+
+    /// Accessor for the clock polarity and phase mode
+    uint8_t mode() const
+    {
+        return _mode;
+    }
+
+    /// Accessor for the bit order
+    spi_bitorder_t order() const
+    {
+        return _order;
+    }
+
+protected:
+    /**
+     * The next transaction in the queue
+     *
+     * This field is not volatile because it is only accessed from within a
+     * critical section.
+     */
+    SPITransaction * _next;
+    /// The chip select of the target device
+    DigitalOut * _cs;
+    /// The first SPISegment in the transaction
+    detail::SPISegment * _root;
+    /// The last segment while composing the transaction, then the segment in progress while it runs
+    detail::SPISegment * _current;
+    /// The SPI frequency to use for the transaction
+    uint32_t _hz;
+    /// The number of bits per frame
+    uint8_t _bits;
+    /// The clock polarity and phase mode
+    uint8_t _mode;
+    /// The bit order
+    spi_bitorder_t _order;
+    /// Flag to indicate that the Transaction and its Segments were allocated with an irqsafe allocator
+    bool _irqsafe;
+    /// The SPI Object that launched this transaction
+    SPI * _issuer;
+    /// An array of SPI Event Handlers.
+    detail::SPIEventHandler _handlers[SPI_TRANSACTION_NHANDLERS];
+};
+
+/** An SPI Master, used for communicating with SPI slave devices
+ *
+ * Example:
+ * @code
+ * // Read the JEDEC ID of an SPI flash
+ *
+ * #include "mbed-drivers/mbed.h"
+ * #include "mbed-drivers/v2/SPI.hpp"
+ *
+ * mbed::drivers::v2::SPI spi(p5, p6, p7);
+ * DigitalOut flash_cs(p8, 1);
+ *
+ * // This callback executes in minar context
+ * void id_done(mbed::drivers::v2::SPITransaction * t, uint32_t event) {
+ *     t->reset_current();
+ *     uint8_t *id = static_cast<uint8_t *>(t->get_current()   // the command segment
+ *                                          ->get_next()       // the response segment
+ *                                          ->rx().get_buf());
+ *     printf("JEDEC ID %02x %02x %02x\r\n", id[0], id[1], id[2]);
+ * }
+ *
+ * void app_start(int, char **) {
+ *     spi.transfer_to(flash_cs)
+ *         .tx_ephemeral("\x9f", 1)     // Send the Read ID command
+ *         .rx(3)                       // Read 3 bytes into an ephemeral buffer
+ *         .on(SPI_EVENT_COMPLETE, id_done)
+ *         .apply();
+ * }
+ * @endcode
+ */
+class SPI {
+public:
+    using event_callback_t = detail::SPI_event_callback_t;
+
+    /** Create an SPI Master interface, connected to the specified pins
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     */
+    SPI(PinName mosi, PinName miso, PinName sclk);
+
+    /** Create an SPI Master interface, connected to the specified pins and providing IRQ-safe allocators
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     *  @param TransactionPool An IRQ-safe allocator for Transaction objects
+     *  @param SegmentPool An IRQ-safe allocator for Segment objects
+     */
+    SPI(PinName mosi, PinName miso, PinName sclk, mbed::util::PoolAllocator *TransactionPool,
+        mbed::util::PoolAllocator *SegmentPool);
+
+    /** Create an SPI Master interface on a specific resource manager, such as a SoftSPIResourceManager
+     *
+     *  @param mosi SPI Master Out, Slave In pin
+     *  @param miso SPI Master In, Slave Out pin
+     *  @param sclk SPI Clock pin
+     *  @param owner The resource manager that runs the transactions
+     *  @param TransactionPool An IRQ-safe allocator for Transaction objects, or nullptr
+     *  @param SegmentPool An IRQ-safe allocator for Segment objects, or nullptr
+     */
+    SPI(PinName mosi, PinName miso, PinName sclk, detail::SPIResourceManager &owner,
+        mbed::util::PoolAllocator *TransactionPool = nullptr, mbed::util::PoolAllocator *SegmentPool = nullptr);
+
+    /** Destroy the SPI Master interface.
+     *  Releases a reference to the SPI Resource Manager
+     */
+    ~SPI();
+
+    /** Set the default frame format of transactions issued by this object
+     *
+     *  @param bits Number of bits per SPI frame (4 - 16)
+     *  @param mode Clock polarity and phase mode (0 - 3)
+     *  @param order Bit order
+     */
+    void format(uint8_t bits, uint8_t mode = 0, spi_bitorder_t order = SPI_MSB);
+
+    /** Set the default frequency of transactions issued by this object
+     *
+     *  @param hz The bus frequency in hertz
+     */
+    void frequency(uint32_t hz);
+
+    /**
+     * @brief A helper class for constructing transactions
+     */
+    class TransferAdder {
+        friend SPI;
+    protected:
+        /**
+         * @brief Construct a new TransferAdder
+         *
+         * @param[in] spi the issuing SPI object
+         * @param[in] cs the chip select of the target device, or nullptr
+         * @param[in] irqsafe indicates whether the TransferAdder should use the SPI Object's IRQ-safe allocators
+         */
+        TransferAdder(SPI *spi, DigitalOut *cs, bool irqsafe);
+
+        /**
+         * @brief Allocates and constructs a new SPI Segment
+         * @return A new SPI Segment
+         */
+        detail::SPISegment * new_segment();
+
+    public:
+        /**
+         * @brief Set the frequency for this transaction
+         *
+         * @param[in] hz the frequency to set
+         */
+        TransferAdder & frequency(uint32_t hz);
+
+        /**
+         * @brief Set the frame format for this transaction
+         *
+         * @param[in] bits Number of bits per SPI frame (4 - 16)
+         * @param[in] mode Clock polarity and phase mode (0 - 3)
+         * @param[in] order Bit order
+         */
+        TransferAdder & format(uint8_t bits, uint8_t mode = 0, spi_bitorder_t order = SPI_MSB);
+
+        /**
+         * @brief set an event handler
+         *
+         * An event is triggered when any of the bits in the event mask match the event.
+         *
+         * @param[in] event the event mask
+         * @param[in] cb the callback to trigger on an event mask match
+         */
+        TransferAdder & on(uint32_t event, const event_callback_t & cb);
+
+        /**
+         * @brief set an event handler
+         *
+         * @param[in] event the event mask
+         * @param[in] cb the callback to trigger on an event mask match
+         */
+        TransferAdder & on(uint32_t event, event_callback_t && cb);
+
+        /**
+         * @brief Queue the transfer
+         *
+         * Hands the transfer over to the resource manager and returns the resource manager's status. No further
+         * configuration of the transfer is possible after apply() has been called.
+         *
+         * @return the error status of submitting the transfer to the resource manager
+         */
+        SPIError apply();
+
+        /**
+         * @brief Add a transmit-only segment to the transaction
+         *
+         * @param[in] buf a pointer to the buffer to send
+         * @param[in] len the number of bytes to send
+         */
+        TransferAdder & tx(void *buf, size_t len);
+
+        /**
+         * @brief Add a transmit-only segment to the transaction
+         *
+         * @param[in] buf a pointer to and length of the buffer to send
+         */
+        TransferAdder & tx(const Buffer & buf);
+
+        /**
+         * @brief Add a transmit-only segment with an ephemeral buffer to the transaction
+         *
+         * The data is copied into the segment, so the original can be freed.
+         *
+         * @param[in] buf a pointer to the buffer to send
+         * @param[in] len the number of bytes to send, at most EphemeralBuffer::ephemeralSize
+         */
+        TransferAdder & tx_ephemeral(const void *buf, size_t len);
+
+        /**
+         * @brief Add a receive-only segment to the transaction
+         *
+         * @param[in] buf a pointer to the buffer to receive into
+         * @param[in] len the number of bytes to receive
+         */
+        TransferAdder & rx(void *buf, size_t len);
+
+        /**
+         * @brief Add a receive-only segment to the transaction
+         *
+         * @param[in] buf a pointer to and length of the buffer to receive into
+         */
+        TransferAdder & rx(const Buffer & buf);
+
+        /**
+         * @brief Add a receive-only segment with an ephemeral buffer to the transaction
+         *
+         * @param[in] len the number of bytes to receive, at most EphemeralBuffer::ephemeralSize
+         */
+        TransferAdder & rx(size_t len);
+
+        /**
+         * @brief Add a full duplex segment to the transaction
+         *
+         * @param[in] txbuf a pointer to the buffer to send
+         * @param[in] txlen the number of bytes to send
+         * @param[in] rxbuf a pointer to the buffer to receive into
+         * @param[in] rxlen the number of bytes to receive
+         */
+        TransferAdder & txrx(void *txbuf, size_t txlen, void *rxbuf, size_t rxlen);
+
+        /**
+         * @brief Applies an unapplied transaction or destroys a failed transaction
+         */
+        ~TransferAdder();
+    protected:
+        /// The transaction object that is to be added to the SPI transaction queue
+        SPITransaction * _xact;
+        /// The SPI object to use for posting the transaction
+        SPI* _spi;
+        /// flag variable to prevent double-posting of transactions
+        bool _posted;
+        /// flag variable to indicate whether the transaction is intended to use irq-safe allocators
+        bool _irqsafe;
+        /// The error status of the TransferAdder. Transaction will only be posted if the error status is SPIError::None
+        SPIError _rc;
+    };
+
+    /**
+     * @brief Begin constructing a transfer to the device selected by cs
+     *
+     * This API should not be called from IRQ context
+     *
+     * @param[in] cs the chip select of the target device; it is driven low for the duration of the transaction
+     */
+    TransferAdder transfer_to(DigitalOut &cs);
+
+    /**
+     * @brief Begin constructing a transfer to the device selected by cs, in irq context
+     *
+     * This API can be called from IRQ context, but it requires that pool allocators for both Transactions and
+     * Segments have been specified.
+     *
+     * @param[in] cs the chip select of the target device; it is driven low for the duration of the transaction
+     */
+    TransferAdder transfer_to_irqsafe(DigitalOut &cs);
+
+    /**
+     * @brief Create a new segment
+     *
+     * If irqsafe = true, allocate from a pool allocator. Otherwise, allocate from new.
+     *
+     * @param[in] irqsafe flag that indicates whether or not to use a pool allocator
+     * @return the new segment on success, or NULL on failure
+     */
+    detail::SPISegment * new_segment(bool irqsafe);
+
+    /**
+     * @brief Free a transaction
+     *
+     * @param[in] t the transaction to destroy and free
+     */
+    void free(SPITransaction *t);
+
+    /**
+     * @brief Free a segment
+     *
+     * @param[in] s the segment to destroy and free
+     * @param[in] irqsafe a flag that indicates whether to use the pool allocator to free or not
+     */
+    void free(detail::SPISegment *s, bool irqsafe);
+
+protected:
+    friend TransferAdder;
+
+    /**
+     * @brief Select the resource manager for the pins and take a reference to it
+     */
+    void init(PinName mosi, PinName miso, PinName sclk);
+
+    /**
+     * @brief Initiate a transaction
+     *
+     * @param[in] t the transaction to queue
+     * @return the status of the submission
+     */
+    SPIError post_transaction(SPITransaction *t);
+
+    /**
+     * @brief Creates a new transaction, prefilled with this object's format and frequency
+     *
+     * @param[in] cs the chip select of the target device
+     * @param[in] irqsafe The flag that indicates whether to use pool allocators
+     * @return the new SPI Transaction object, or NULL on failure
+     */
+    SPITransaction * new_transaction(DigitalOut *cs, bool irqsafe);
+
+    uint32_t _hz;
+    uint8_t _bits;
+    uint8_t _mode;
+    spi_bitorder_t _order;
+    detail::SPIResourceManager * _owner;
+    mbed::util::PoolAllocator * TransactionPool;
+    mbed::util::PoolAllocator * SegmentPool;
+};
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif
+
+#endif // MBED_DRIVERS_V2_SPI_HPP
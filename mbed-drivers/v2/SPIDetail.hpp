@@ -0,0 +1,302 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_SPIDETAIL_HPP
+#define MBED_DRIVERS_V2_SPIDETAIL_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#include "EphemeralBuffer.hpp"
+#include "core-util/FunctionPointer.h"
+#include "PinNames.h"
+#include "mbed-drivers/mbed_stats.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+// Forward declaration of the SPITransaction
+class SPITransaction;
+
+namespace detail {
+
+/** SPI transfer callback
+ *  @param The transaction that was running when the callback was triggered
+ *  @param The event that triggered the calback
+ */
+typedef mbed::util::FunctionPointer2<void, SPITransaction *, uint32_t> SPI_event_callback_t;
+
+/**
+ * @brief A class that contains the information required for an individual chunk of an SPI transaction
+ *
+ * SPI is full duplex, so each segment carries both a transmit and a receive buffer. Either may be empty: a segment with
+ * no transmit buffer clocks out the fill word, and a segment with no receive buffer discards the incoming data. The
+ * segments of an SPITransaction are formed into a linked list through the _next pointer and are transferred with the
+ * chip select held active throughout. Each segment can have an associated callback that executes in IRQ context, so
+ * that a transaction can be modified on the fly, for example to read a length and then set up the following segment.
+ */
+class SPISegment {
+public:
+    /**
+     * SPI segment callback
+     * @param The segment that was running when the callback was triggered
+     * @param The event that triggered the calback
+     */
+    using IRQCallback = mbed::util::FunctionPointer2<void, SPISegment *, uint32_t>;
+    SPISegment() :
+        _tx(), _rx(), _next(nullptr), _irqCB(nullptr)
+    {
+        _tx.set(nullptr, 0);
+        _rx.set(nullptr, 0);
+    }
+
+    /**
+     * @brief Copies an existing SPISegment
+     *
+     * Both buffers are copied as EphemeralBuffers: ephemeral data is duplicated, other buffers share the pointer.
+     * Following segments are not duplicated.
+     *
+     * @param[in] s the SPISegment to copy
+     */
+    SPISegment(const SPISegment & s) :
+        _tx(s._tx), _rx(s._rx), _next(nullptr), _irqCB(s._irqCB)
+    {}
+
+    /**
+     * @brief Access the transmit buffer
+     * @return the buffer to send during this segment
+     */
+    EphemeralBuffer & tx()
+    {
+        return _tx;
+    }
+
+    /**
+     * @brief Access the receive buffer
+     * @return the buffer to receive into during this segment
+     */
+    EphemeralBuffer & rx()
+    {
+        return _rx;
+    }
+
+    /**
+     * @brief Set the following SPISegment.
+     *
+     * @param[in] next an SPISegment to append to the current one
+     */
+    void set_next(SPISegment *next)
+    {
+        _next = next;
+    }
+
+    /**
+     * @brief get a pointer to the next SPISegment
+     *
+     * @return If another segment is appended, a pointer to that segment,
+     * otherwise nullptr
+     */
+    SPISegment * get_next() const
+    {
+        return _next;
+    }
+
+    /**
+     * @brief Set the callback to execute immediately when this segment is
+     * completed.
+     *
+     * This should typically be nullptr. No event filtering is provided on the
+     * irq callback.
+     * @param[in] cb the FunctionPointer to call when this segment completes
+     */
+    void set_irq_cb(IRQCallback cb)
+    {
+        _irqCB = cb;
+    }
+
+    /**
+     * @brief Trigger the attached callback
+     *
+     * @param[in] event the event which caused this callback.
+     */
+    void call_irq_cb(uint32_t event)
+    {
+        if (_irqCB) {
+            _irqCB(this, event);
+        }
+    }
+
+protected:
+    EphemeralBuffer _tx;            ///< Data to send
+    EphemeralBuffer _rx;            ///< Space to receive into
+    SPISegment *    _next;          ///< Next segment to execute
+    IRQCallback     _irqCB;         ///< Callback to execute in irq context
+};
+
+/**
+ * @brief The base resource manager class for SPI
+ *
+ * The SPIResourceManager serializes transactions onto one logical SPI master, in the same way as the
+ * I2CResourceManager does for I2C. Each transaction is run atomically: the bus format and frequency are applied, the
+ * transaction's chip select is asserted, every segment is transferred, and then the chip select is released before
+ * the next transaction starts. This way, many devices with different formats can share the bus without conflicts.
+ *
+ * ## Event Handling overview
+ *
+ * ```
+ * If there is an error condition:
+ *     Release the chip select
+ *     Schedule handle_event() with the current transaction and event
+ * Otherwise, if there are more segments to process:
+ *     Start the next segment
+ * Otherwise,
+ *     Release the chip select
+ *     Schedule handle_event() with the current transaction and the complete event
+ * If another segment was not started,
+ *     Start the next transaction
+ * ```
+ */
+class SPIResourceManager {
+public:
+    SPIResourceManager(const SPIResourceManager&) = delete;
+    SPIResourceManager(SPIResourceManager&&) = delete;
+    const SPIResourceManager& operator =(const SPIResourceManager&) = delete;
+    const SPIResourceManager& operator =(SPIResourceManager&&) = delete;
+
+    /**
+     * @brief Initialize the I/O pins
+     *
+     * init is called each time a new SPI object is created.
+     *
+     * @param[in] mosi the MOSI pin of the SPI master to bind
+     * @param[in] miso the MISO pin of the SPI master to bind
+     * @param[in] sclk the SCLK pin of the SPI master to bind
+     */
+    virtual SPIError init(PinName mosi, PinName miso, PinName sclk) = 0;
+    /**
+     * Release a reference to the SPIResourceManager
+     */
+    virtual void release() = 0;
+
+    /**
+     * @brief Add a transaction to the transaction queue of the associated logical SPI master
+     *
+     * @param[in] transaction Queue this transaction
+     * @return the result of validating the transaction
+     */
+    SPIError post_transaction(SPITransaction *transaction);
+
+protected:
+    /**
+     * @brief Starts the transaction at the head of the queue
+     */
+    virtual SPIError start_transaction() = 0;
+
+    /**
+     * @brief Starts the next segment
+     */
+    virtual SPIError start_segment() = 0;
+
+    /**
+     * @brief Validates the transaction according to the criteria of the derived Resource Manager
+     * @param[in] transaction the transaction to validate
+     */
+    virtual SPIError validate_transaction(SPITransaction *transaction) const = 0;
+
+    /**
+     * @brief Process an event
+     *
+     * Fires the segment's irq callback, then either starts the next segment or completes the transaction and starts
+     * the next one.
+     *
+     * @param[in] event the source of the current handler call
+     */
+    void process_event(uint32_t event);
+
+    /**
+     * @brief Handle an event
+     *
+     * Distributes the event to the transaction's event handlers, then frees the transaction using the issuing SPI
+     * object.
+     *
+     * @param[in] t the transaction that was in progress when the event was triggered
+     * @param[in] event the event(s) that occurred
+     */
+    void handle_event(SPITransaction *t, uint32_t event);
+
+    SPIResourceManager();
+    ~SPIResourceManager();
+
+    // The head of the transaction queue
+    SPITransaction * volatile _TransactionQueue;
+
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    // The counters for this logical master, which derived resource managers may rename, as "spi0" for example
+    mbed_stats_t _stats;
+    char _stats_name[8];
+    // When the transaction at the head of the queue was started
+    uint32_t _stats_start;
+    // The number of transactions in the queue
+    uint32_t _stats_queued;
+#endif
+};
+
+SPIResourceManager * get_spi_owner(int I);
+
+/**
+ * @brief A helper class for holding a callback and an event mask
+ */
+class SPIEventHandler {
+public:
+    SPIEventHandler();
+
+    /**
+     * @brief Call the event handler
+     *
+     * @param[in] t the transaction that was in progress when the event was triggered
+     * @param[in] event the event(s) that occurred
+     */
+    void call(SPITransaction *t, uint32_t event);
+
+    /**
+     * @brief Set the callback and the event mask
+     *
+     * @param[in] cb the callback to trigger when the event mask is matched
+     * @param[in] event The event mask to use to filter events
+     */
+    void set(const SPI_event_callback_t &cb, uint32_t event);
+
+    /**
+     * @brief Test if the event mask matches any bit of event
+     */
+    bool matches(uint32_t event) const;
+
+    /**
+     * @brief Test if the event mask is non-zero and the callback is bound
+     */
+    operator bool() const;
+protected:
+    SPI_event_callback_t _cb;
+    uint32_t _eventmask;
+};
+
+} // namespace detail
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+#endif // DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#endif // MBED_DRIVERS_V2_SPIDETAIL_HPP
@@ -0,0 +1,489 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_SERIAL_HPP
+#define MBED_DRIVERS_V2_SERIAL_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
+
+#include "mbed-hal/serial_api.h"
+#include "mbed-hal/dma_api.h"
+
+#include "core-util/FunctionPointer.h"
+#include "core-util/PoolAllocator.h"
+
+// Forward declarations
+namespace mbed {
+namespace drivers {
+namespace v2 {
+enum class SerialError;
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#include "SerialDetail.hpp"
+#include "EphemeralBuffer.hpp"
+
+/// Serial transactions can have up to 4 event handlers, as for I2C
+const size_t SERIAL_TRANSACTION_NHANDLERS = 4;
+
+/**
+ * \file
+ * \brief An asynchronous, queued interface for UARTs
+ *
+ * This follows the v2 I2C API. Each Serial object is bound to the SerialResourceManager for its UART, which keeps one
+ * queue of transactions for each direction. Transactions are built with a TransferAdder, returned by ```write()``` or
+ * ```read()```:
+ *
+ * * each ```tx()``` or ```rx()``` call adds a segment; segments are transferred back to back, so a frame can be
+ *   gathered from several buffers without copying
+ * * ```tx_ephemeral()``` and ```rx(size_t)``` store up to EphemeralBuffer::ephemeralSize bytes in the segment itself
+ * * ```on()``` installs up to 4 event handlers, which run in minar context when the transaction ends
+ * * ```apply()```, or the destruction of the TransferAdder, queues the transaction
+ *
+ * Transactions and segments are allocated with new, or from the Serial object's PoolAllocators when built with
+ * ```write_irqsafe()``` or ```read_irqsafe()```. With pools, sending a frame does not touch the heap and can be done
+ * from IRQ context.
+ *
+ * ```C++
+ * Serial uart(tx, rx);
+ * void send_frame(uint8_t *payload, size_t len, uint16_t crc) {
+ *     uint8_t hdr[3] = {0x7e, (uint8_t)(len >> 8), (uint8_t)len};
+ *     uart.write().tx_ephemeral(hdr, 3).tx(payload, len).tx_ephemeral(&crc, 2).on(SERIAL_EVENT_TX_ALL, sentCB);
+ * }
+ * ```
+ */
+namespace mbed {
+namespace drivers {
+namespace v2 {
+// Forward declaration of Serial
+class Serial;
+
+/**
+ * @brief List of error codes that can be produced by the Serial API
+ */
+enum class SerialError {
+    None,
+    InvalidPort,
+    PinMismatch,
+    Busy,
+    NullTransaction,
+    NullSegment,
+    MissingPoolAllocator,
+    BufferSize,
+    DeinitInProgress
+};
+
+/**
+ * A Transaction container for Serial
+ */
+class SerialTransaction {
+public:
+    /** Serial transfer callback
+     *  @param The transaction that was running when the callback was triggered
+     *  @param the event that triggered the calback
+     */
+    using event_callback_t = detail::Serial_event_callback_t;
+
+    /**
+     * Construct a Serial transaction
+     *
+     * @param[in] dir whether the transaction sends or receives
+     * @param[in] irqsafe set if the transaction and its segments come from pool allocators
+     * @param[in] issuer the Serial object that created the transaction
+     */
+    SerialTransaction(detail::SerialDirection dir, bool irqsafe, Serial *issuer);
+    ~SerialTransaction();
+
+    /**
+     * Get a new segment to be used by the transaction.
+     * This API calls the associated Serial object's associated allocator.
+     * @return a new SerialSegment
+     */
+    detail::SerialSegment * new_segment();
+
+    /**
+     * Install a new event handler with the corresponding event mask
+     *
+     * @param[in] event The event mask on which to trigger cb
+     * @param[in] cb The event to trigger when one or more bits in the event mask is matched
+     * @retval false There was no space for a new event handler
+     * @retval true The new event handler was installed
+     */
+    bool add_event(uint32_t event, const event_callback_t & cb);
+
+    /**
+     * The resource manager calls this API.
+     * Calls the event handlers whose event mask matches event
+     */
+    void process_event(uint32_t event);
+
+    /**
+     * Set the next transaction in the queue
+     */
+    void append(SerialTransaction *t);
+
+    /**
+     * Forwards the irq-context callback to the current segment
+     * @param[in] the event that triggered this callback
+     */
+    void call_irq_cb(uint32_t event);
+
+    /**
+     * If the current segment is valid advance the segment pointer
+     *
+     * @retval true if the current segment is valid after this operation
+     * @retval false if the current segment is not valid after this operation
+     */
+    bool advance_segment();
+
+    /**
+     * Reset the current segment to the root segment
+     */
+    void reset_current()
+    {
+        _current  = _root;
+    }
+
+    /**
+     * Accessor for the next pointer
+     * @return the next transaction
+     */
+    SerialTransaction * get_next()
+    {
+        return _next;
+    }
+
+    /**
+     * Accessor for the Transactions's issuer
+     * @return the Serial object that issued this transaction
+     */
+    Serial * get_issuer()
+    {
+        return _issuer;
+    }
+
+    /**
+     * Accessor for the current segment pointer
+     * @return the current segment poitner
+     */
+    detail::SerialSegment * get_current()
+    {
+        return _current;
+    }
+
+    /**
+     * Accessor for the transfer direction
+     * @return the direction of the transaction
+     */
+    detail::SerialDirection get_dir() const
+    {
+        return _dir;
+    }
+
+    /**
+     * Accessor for the irqsafe flag
+     * @retval true if the transaction was allocated from the issuer's pool allocators
+     */
+    bool is_irqsafe() const
+    {
+        return _irqsafe;
+    }
+
+protected:
+    /**
+     * The next transaction in the queue
+     *
+     * This field is not volatile because it is only accessed from within a
+     * critical section.
+     */
+    SerialTransaction * _next;
+    /// The first SerialSegment in the transaction
+    detail::SerialSegment * _root;
+    /// The last segment while composing the transaction, then the segment in progress while it runs
+    detail::SerialSegment * _current;
+    /// Whether the transaction sends or receives
+    detail::SerialDirection _dir;
+    /// Flag to indicate that the Transaction and its Segments were allocated with an irqsafe allocator
+    bool _irqsafe;
+    /// The Serial Object that launched this transaction
+    Serial * _issuer;
+    /// An array of Serial Event Handlers.
+    detail::SerialEventHandler _handlers[SERIAL_TRANSACTION_NHANDLERS];
+};
+
+/** An asynchronous, queued UART
+ *
+ * Example:
+ * @code
+ * #include "mbed-drivers/mbed.h"
+ * #include "mbed-drivers/v2/Serial.hpp"
+ *
+ * static mbed::util::PoolAllocator xact_pool(xact_space, 4, sizeof(mbed::drivers::v2::SerialTransaction));
+ * static mbed::util::PoolAllocator seg_pool(seg_space, 12, sizeof(mbed::drivers::v2::detail::SerialSegment));
+ * mbed::drivers::v2::Serial uart(UART_TX, UART_RX, &xact_pool, &seg_pool);
+ *
+ * // Called in IRQ context for every sample: no heap activity
+ * void sample_ready(uint16_t sample) {
+ *     uart.write_irqsafe().tx_ephemeral("S", 1).tx_ephemeral(&sample, 2).apply();
+ * }
+ * @endcode
+ */
+class Serial {
+public:
+    using event_callback_t = detail::Serial_event_callback_t;
+
+    /** Create a Serial interface, connected to the specified pins
+     *
+     *  @param tx Transmit pin
+     *  @param rx Receive pin
+     */
+    Serial(PinName tx, PinName rx);
+
+    /** Create a Serial interface, connected to the specified pins and providing IRQ-safe allocators
+     *
+     *  @param tx Transmit pin
+     *  @param rx Receive pin
+     *  @param TransactionPool An IRQ-safe allocator for Transaction objects
+     *  @param SegmentPool An IRQ-safe allocator for Segment objects
+     */
+    Serial(PinName tx, PinName rx, mbed::util::PoolAllocator *TransactionPool, mbed::util::PoolAllocator *SegmentPool);
+
+    /** Destroy the Serial interface.
+     *  Releases a reference to the Serial Resource Manager
+     */
+    ~Serial();
+
+    /** Set the baud rate of the UART
+     *
+     *  This applies to every Serial object on the same UART.
+     *
+     *  @param baudrate The baudrate of the serial port
+     */
+    void baud(int baudrate);
+
+    /** Set the frame format of the UART
+     *
+     *  This applies to every Serial object on the same UART.
+     *
+     *  @param bits The number of bits in a word (5-8; default = 8)
+     *  @param parity The parity used (ParityNone, ParityOdd, ParityEven, ParityForced1, ParityForced0)
+     *  @param stop_bits The number of stop bits (1 or 2; default = 1)
+     */
+    void format(int bits = 8, SerialParity parity = ParityNone, int stop_bits = 1);
+
+    /**
+     * @brief A helper class for constructing transactions
+     */
+    class TransferAdder {
+        friend Serial;
+    protected:
+        /**
+         * @brief Construct a new TransferAdder
+         *
+         * @param[in] serial the issuing Serial object
+         * @param[in] dir the direction of the transaction
+         * @param[in] irqsafe indicates whether the TransferAdder should use the Serial Object's IRQ-safe allocators
+         */
+        TransferAdder(Serial *serial, detail::SerialDirection dir, bool irqsafe);
+
+        /**
+         * @brief Allocates and constructs a new Serial Segment
+         * @param[in] d the direction of the segment, which must match the transaction
+         * @return A new Serial Segment
+         */
+        detail::SerialSegment * new_segment(detail::SerialDirection d);
+
+    public:
+        /**
+         * @brief set an event handler
+         *
+         * @param[in] event the event mask
+         * @param[in] cb the callback to trigger on an event mask match
+         */
+        TransferAdder & on(uint32_t event, const event_callback_t & cb);
+
+        /**
+         * @brief set an event handler
+         *
+         * @param[in] event the event mask
+         * @param[in] cb the callback to trigger on an event mask match
+         */
+        TransferAdder & on(uint32_t event, event_callback_t && cb);
+
+        /**
+         * @brief Queue the transfer
+         *
+         * @return the error status of submitting the transfer to the resource manager
+         */
+        SerialError apply();
+
+        /**
+         * @brief Add a buffer to send to a write transaction
+         *
+         * @param[in] buf a pointer to the buffer to send
+         * @param[in] len the number of bytes to send
+         */
+        TransferAdder & tx(const void *buf, size_t len);
+
+        /**
+         * @brief Add a buffer to send to a write transaction
+         *
+         * @param[in] buf a pointer to and length of the buffer to send
+         */
+        TransferAdder & tx(const Buffer & buf);
+
+        /**
+         * @brief Add an ephemeral buffer to send to a write transaction
+         *
+         * The data is copied into the segment, so the original can be freed.
+         *
+         * @param[in] buf a pointer to the buffer to send
+         * @param[in] len the number of bytes to send, at most EphemeralBuffer::ephemeralSize
+         */
+        TransferAdder & tx_ephemeral(const void *buf, size_t len);
+
+        /**
+         * @brief Add a buffer to receive into to a read transaction
+         *
+         * @param[in] buf a pointer to the buffer to receive into
+         * @param[in] len the number of bytes to receive
+         */
+        TransferAdder & rx(void *buf, size_t len);
+
+        /**
+         * @brief Add a buffer to receive into to a read transaction
+         *
+         * @param[in] buf a pointer to and length of the buffer to receive into
+         */
+        TransferAdder & rx(const Buffer & buf);
+
+        /**
+         * @brief Add an ephemeral receive buffer to a read transaction
+         *
+         * @param[in] len the number of bytes to receive, at most EphemeralBuffer::ephemeralSize
+         */
+        TransferAdder & rx(size_t len);
+
+        /**
+         * @brief Applies an unapplied transaction or destroys a failed transaction
+         */
+        ~TransferAdder();
+    protected:
+        /// The transaction object that is to be added to the transaction queue
+        SerialTransaction * _xact;
+        /// The Serial object to use for posting the transaction
+        Serial* _serial;
+        /// flag variable to prevent double-posting of transactions
+        bool _posted;
+        /// flag variable to indicate whether the transaction is intended to use irq-safe allocators
+        bool _irqsafe;
+        /// The error status of the TransferAdder. Transaction will only be posted if the error status is None
+        SerialError _rc;
+    };
+
+    /**
+     * @brief Begin constructing a transmit transaction
+     *
+     * This API should not be called from IRQ context
+     */
+    TransferAdder write();
+
+    /**
+     * @brief Begin constructing a transmit transaction, in irq context
+     *
+     * This requires that pool allocators for both Transactions and Segments have been specified.
+     */
+    TransferAdder write_irqsafe();
+
+    /**
+     * @brief Begin constructing a receive transaction
+     *
+     * Receive transactions are queued like transmit transactions. Queuing more than one keeps the receiver armed: as
+     * soon as one transaction's buffers are full, the next one starts receiving.
+     *
+     * This API should not be called from IRQ context
+     */
+    TransferAdder read();
+
+    /**
+     * @brief Begin constructing a receive transaction, in irq context
+     *
+     * This requires that pool allocators for both Transactions and Segments have been specified.
+     */
+    TransferAdder read_irqsafe();
+
+    /**
+     * @brief Create a new segment
+     *
+     * @param[in] irqsafe flag that indicates whether or not to use a pool allocator
+     * @return the new segment on success, or NULL on failure
+     */
+    detail::SerialSegment * new_segment(bool irqsafe);
+
+    /**
+     * @brief Free a transaction
+     *
+     * @param[in] t the transaction to destroy and free
+     */
+    void free(SerialTransaction *t);
+
+    /**
+     * @brief Free a segment
+     *
+     * @param[in] s the segment to destroy and free
+     * @param[in] irqsafe a flag that indicates whether to use the pool allocator to free or not
+     */
+    void free(detail::SerialSegment *s, bool irqsafe);
+
+protected:
+    friend TransferAdder;
+
+    /**
+     * @brief Select the resource manager for the pins and take a reference to it
+     */
+    void init(PinName tx, PinName rx);
+
+    /**
+     * @brief Initiate a transaction
+     *
+     * @param[in] t the transaction to queue
+     * @return the status of the submission
+     */
+    SerialError post_transaction(SerialTransaction *t);
+
+    /**
+     * @brief Creates a new transaction
+     *
+     * @param[in] dir the direction of the transaction
+     * @param[in] irqsafe The flag that indicates whether to use pool allocators
+     * @return the new Serial Transaction object, or NULL on failure
+     */
+    SerialTransaction * new_transaction(detail::SerialDirection dir, bool irqsafe);
+
+    detail::SerialResourceManager * _owner;
+    mbed::util::PoolAllocator * TransactionPool;
+    mbed::util::PoolAllocator * SegmentPool;
+};
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif
+
+#endif // MBED_DRIVERS_V2_SERIAL_HPP
@@ -0,0 +1,279 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_SERIALDETAIL_HPP
+#define MBED_DRIVERS_V2_SERIALDETAIL_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
+
+#include "EphemeralBuffer.hpp"
+#include "core-util/FunctionPointer.h"
+#include "PinNames.h"
+#include "mbed-hal/serial_api.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+// Forward declaration of the SerialTransaction
+class SerialTransaction;
+
+namespace detail {
+enum class SerialDirection {Transmit, Receive};
+
+/** Serial transfer callback
+ *  @param The transaction that was running when the callback was triggered
+ *  @param The event that triggered the calback
+ */
+typedef mbed::util::FunctionPointer2<void, SerialTransaction *, uint32_t> Serial_event_callback_t;
+
+/**
+ * @brief One buffer of a Serial transaction
+ *
+ * The segments of a SerialTransaction are formed into a linked list through the _next pointer and are sent (or
+ * received) back to back, so a frame can be assembled from a header, a payload and a CRC held in different places
+ * without copying. Each segment can have an associated callback that executes in IRQ context.
+ */
+class SerialSegment : public EphemeralBuffer {
+public:
+    /**
+     * Serial segment callback
+     * @param The segment that was running when the callback was triggered
+     * @param The event that triggered the calback
+     */
+    using IRQCallback = mbed::util::FunctionPointer2<void, SerialSegment *, uint32_t>;
+    SerialSegment() :
+        EphemeralBuffer(), _next(nullptr), _irqCB(nullptr)
+    {}
+
+    /**
+     * @brief Copies an existing SerialSegment
+     *
+     * Following segments are not duplicated.
+     *
+     * @param[in] s the SerialSegment to copy
+     */
+    SerialSegment(const SerialSegment & s) :
+        EphemeralBuffer(static_cast<const EphemeralBuffer &>(s)), _next(nullptr), _irqCB(s._irqCB)
+    {}
+
+    /**
+     * @brief Set the following SerialSegment.
+     *
+     * @param[in] next a SerialSegment to append to the current one
+     */
+    void set_next(SerialSegment *next)
+    {
+        _next = next;
+    }
+
+    /**
+     * @brief get a pointer to the next SerialSegment
+     *
+     * @return If another segment is appended, a pointer to that segment,
+     * otherwise nullptr
+     */
+    SerialSegment * get_next() const
+    {
+        return _next;
+    }
+
+    /**
+     * @brief Set the callback to execute immediately when this segment is
+     * completed.
+     *
+     * @param[in] cb the FunctionPointer to call when this segment completes
+     */
+    void set_irq_cb(IRQCallback cb)
+    {
+        _irqCB = cb;
+    }
+
+    /**
+     * @brief Trigger the attached callback
+     *
+     * @param[in] event the event which caused this callback.
+     */
+    void call_irq_cb(uint32_t event)
+    {
+        if (_irqCB) {
+            _irqCB(this, event);
+        }
+    }
+
+protected:
+    SerialSegment *   _next;        ///< Next segment to execute
+    IRQCallback       _irqCB;       ///< Callback to execute in irq context
+};
+
+/**
+ * @brief The base resource manager class for Serial
+ *
+ * There is one SerialResourceManager per UART. It keeps two independent transaction queues, one for each direction,
+ * so that a transmit never waits behind a receive. As with the I2CResourceManager, the next segment, and then the next
+ * transaction, is started from the interrupt handler as soon as the previous one completes. Transmitting a queue of
+ * frames therefore runs at line rate, and queued receive transactions form a stream: the next buffer is armed
+ * immediately when the previous one fills.
+ *
+ * ## Event Handling overview
+ *
+ * For each direction:
+ * ```
+ * If there is an error condition:
+ *     Schedule handle_event() with the current transaction and event
+ * Otherwise, if there are more segments to process:
+ *     Start the next segment
+ * Otherwise,
+ *     Schedule handle_event() with the current transaction and the complete event
+ * If another segment was not started,
+ *     Start the next transaction in the same direction
+ * ```
+ */
+class SerialResourceManager {
+public:
+    SerialResourceManager(const SerialResourceManager&) = delete;
+    SerialResourceManager(SerialResourceManager&&) = delete;
+    const SerialResourceManager& operator =(const SerialResourceManager&) = delete;
+    const SerialResourceManager& operator =(SerialResourceManager&&) = delete;
+
+    /**
+     * @brief Initialize the I/O pins
+     *
+     * init is called each time a new Serial object is created.
+     *
+     * @param[in] tx the TX pin of the UART to bind
+     * @param[in] rx the RX pin of the UART to bind
+     */
+    virtual SerialError init(PinName tx, PinName rx) = 0;
+    /**
+     * Release a reference to the SerialResourceManager
+     */
+    virtual void release() = 0;
+
+    /**
+     * @brief Set the baud rate of the UART
+     * @param[in] baudrate the baud rate in bits per second
+     */
+    virtual void baud(int baudrate) = 0;
+
+    /**
+     * @brief Set the frame format of the UART
+     * @param[in] bits the number of data bits (5 - 8)
+     * @param[in] parity the parity mode
+     * @param[in] stop_bits the number of stop bits (1 or 2)
+     */
+    virtual void format(int bits, SerialParity parity, int stop_bits) = 0;
+
+    /**
+     * @brief Add a transaction to the queue for its direction
+     *
+     * @param[in] transaction Queue this transaction
+     * @return the result of validating the transaction
+     */
+    SerialError post_transaction(SerialTransaction *transaction);
+
+protected:
+    /**
+     * @brief Starts the transaction at the head of the queue for direction d
+     */
+    virtual SerialError start_transaction(SerialDirection d) = 0;
+
+    /**
+     * @brief Starts the next segment in direction d
+     */
+    virtual SerialError start_segment(SerialDirection d) = 0;
+
+    /**
+     * @brief Process an event for one direction
+     *
+     * @param[in] d the direction that the event belongs to
+     * @param[in] event the source of the current handler call
+     */
+    void process_event(SerialDirection d, uint32_t event);
+
+    /**
+     * @brief Handle an event
+     *
+     * Distributes the event to the transaction's event handlers, then frees the transaction using the issuing Serial
+     * object.
+     *
+     * @param[in] t the transaction that was in progress when the event was triggered
+     * @param[in] event the event(s) that occurred
+     */
+    void handle_event(SerialTransaction *t, uint32_t event);
+
+    /**
+     * @brief Get the head of the queue for a direction
+     */
+    SerialTransaction * volatile & queue(SerialDirection d)
+    {
+        return d == SerialDirection::Transmit ? _TxQueue : _RxQueue;
+    }
+
+    SerialResourceManager();
+    ~SerialResourceManager();
+
+    // The heads of the transaction queues
+    SerialTransaction * volatile _TxQueue;
+    SerialTransaction * volatile _RxQueue;
+};
+
+SerialResourceManager * get_serial_owner(int I);
+
+/**
+ * @brief A helper class for holding a callback and an event mask
+ */
+class SerialEventHandler {
+public:
+    SerialEventHandler();
+
+    /**
+     * @brief Call the event handler
+     *
+     * @param[in] t the transaction that was in progress when the event was triggered
+     * @param[in] event the event(s) that occurred
+     */
+    void call(SerialTransaction *t, uint32_t event);
+
+    /**
+     * @brief Set the callback and the event mask
+     *
+     * @param[in] cb the callback to trigger when the event mask is matched
+     * @param[in] event The event mask to use to filter events
+     */
+    void set(const Serial_event_callback_t &cb, uint32_t event);
+
+    /**
+     * @brief Test if the event mask matches any bit of event
+     */
+    bool matches(uint32_t event) const;
+
+    /**
+     * @brief Test if the event mask is non-zero and the callback is bound
+     */
+    operator bool() const;
+protected:
+    Serial_event_callback_t _cb;
+    uint32_t _eventmask;
+};
+
+} // namespace detail
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+#endif // DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
+
+#endif // MBED_DRIVERS_V2_SERIALDETAIL_HPP
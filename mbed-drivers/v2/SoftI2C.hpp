@@ -0,0 +1,77 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_SOFTI2C_HPP
+#define MBED_DRIVERS_V2_SOFTI2C_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+
+#include "mbed-drivers/SoftI2C.h"
+#include "I2C.hpp"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+/**
+ * @brief An I2C resource manager that bit-bangs the bus on GPIO
+ *
+ * A SoftI2CResourceManager runs v2 I2C transactions on a SoftI2C, so v2 I2C masters can be created on any pair of
+ * pins with the I2C constructor that takes a resource manager. Each segment is run in its own minar callback, so
+ * the bus is not bit-banged with interrupts disabled; segment IRQ callbacks are therefore called in minar context.
+ * 10-bit addresses are not supported.
+ *
+ * @code
+ * mbed::drivers::v2::SoftI2CResourceManager soft_i2c(p5, p6);
+ * mbed::drivers::v2::I2C i2c(p5, p6, soft_i2c);
+ * @endcode
+ */
+class SoftI2CResourceManager : public detail::I2CResourceManager {
+public:
+    /**
+     * @param[in] sda I2C data line pin
+     * @param[in] scl I2C clock line pin
+     */
+    SoftI2CResourceManager(PinName sda, PinName scl);
+
+    virtual I2CError init(PinName sda, PinName scl);
+    virtual void release();
+
+protected:
+    virtual I2CError start_transaction();
+    virtual I2CError start_segment();
+    virtual I2CError validate_transaction(I2CTransaction *t) const;
+
+    /// Run the current segment of the transaction at the head of the queue
+    void run();
+    /// Post run() to minar
+    void schedule();
+
+    SoftI2C _bus;
+    const PinName _sda;
+    const PinName _scl;
+    volatile uint32_t _references;
+};
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_I2C && DEVICE_I2C_ASYNCH
+
+#endif // MBED_DRIVERS_V2_SOFTI2C_HPP
@@ -0,0 +1,79 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DRIVERS_V2_SOFTSPI_HPP
+#define MBED_DRIVERS_V2_SOFTSPI_HPP
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#include "mbed-drivers/SoftSPI.h"
+#include "SPI.hpp"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+/**
+ * @brief An SPI resource manager that bit-bangs the bus on GPIO
+ *
+ * A SoftSPIResourceManager runs v2 SPI transactions on a SoftSPI, so v2 SPI masters can be created on any pins with
+ * the SPI constructor that takes a resource manager. Each segment is run in its own minar callback, so the bus is not
+ * bit-banged with interrupts disabled; segment IRQ callbacks are therefore called in minar context. Frames of 1 to 16
+ * bits are supported, stored in one byte up to 8 bits and two bytes above, as with the SPI HAL.
+ *
+ * @code
+ * mbed::drivers::v2::SoftSPIResourceManager soft_spi(p5, p6, p7);
+ * mbed::drivers::v2::SPI spi(p5, p6, p7, soft_spi);
+ * @endcode
+ */
+class SoftSPIResourceManager : public detail::SPIResourceManager {
+public:
+    /**
+     * @param[in] mosi SPI Master Out, Slave In pin
+     * @param[in] miso SPI Master In, Slave Out pin
+     * @param[in] sclk SPI Clock pin
+     */
+    SoftSPIResourceManager(PinName mosi, PinName miso, PinName sclk);
+
+    virtual SPIError init(PinName mosi, PinName miso, PinName sclk);
+    virtual void release();
+
+protected:
+    virtual SPIError start_transaction();
+    virtual SPIError start_segment();
+    virtual SPIError validate_transaction(SPITransaction *t) const;
+
+    /// Run the current segment of the transaction at the head of the queue
+    void run();
+    /// Post run() to minar
+    void schedule();
+
+    SoftSPI _bus;
+    const PinName _mosi;
+    const PinName _miso;
+    const PinName _sclk;
+    volatile uint32_t _references;
+};
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#endif // MBED_DRIVERS_V2_SOFTSPI_HPP
@@ -0,0 +1,76 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016, ARM Limited, All Rights Reserved
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Find the source of an assertion reported by ID.
+
+MBED_ASSERT_ID, and MBED_ASSERT at YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL 1,
+report a failure as
+
+    mbed assertation failed: id <file id>:<line>
+
+where the file id is a hash of the base name of the source file (see
+MBED_FILE_ID in mbed_assert.h). This searches the given directories for
+files with a matching name and prints the failing line:
+
+    assert_decode.py 3c6c42cc:000000d5 source/ yotta_modules/
+"""
+
+import os
+import re
+import sys
+
+SOURCE_EXTENSIONS = ('.c', '.cpp', '.h', '.hpp')
+
+
+def file_id(name):
+    h = 0
+    for i, c in enumerate(reversed(name[-16:])):
+        h += ord(c) * (31 ** i)
+    return h & 0xffffffff
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+    m = re.search(r'([0-9a-fA-F]{8}):([0-9a-fA-F]{8})', argv[1])
+    if not m:
+        sys.stderr.write('expected <file id>:<line>, as printed by the target\n')
+        return 1
+    wanted = int(m.group(1), 16)
+    line = int(m.group(2), 16)
+
+    found = False
+    for root in argv[2:] or ['.']:
+        for dirpath, _, filenames in os.walk(root):
+            for name in filenames:
+                if not name.endswith(SOURCE_EXTENSIONS) or file_id(name) != wanted:
+                    continue
+                path = os.path.join(dirpath, name)
+                with open(path) as f:
+                    lines = f.readlines()
+                text = lines[line - 1].strip() if line <= len(lines) else ''
+                print('%s:%d: %s' % (path, line, text))
+                found = True
+    if not found:
+        sys.stderr.write('no source file matches id %08x\n' % wanted)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016, ARM Limited, All Rights Reserved
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Expand the zero runs in a coverage stream.
+
+With YOTTA_CFG_DEBUG_OPTIONS_COVERAGE_ZERO_RUNS enabled, retarget.cpp
+sends "zNN" for NN (hex) zero bytes. This filter rewrites the coverage
+payloads of a test log into the plain format greentea understands, where
+each zero byte is a '.'; with --binary it writes the decoded gcda files
+instead.
+
+    coverage_decode.py < test.log > expanded.log
+    coverage_decode.py --binary outdir < test.log
+"""
+
+import os
+import re
+import sys
+
+COVERAGE = re.compile(r'\{\{__coverage_start;([^;]*);([^}]*)\}\}')
+ZERO_RUN = re.compile(r'z([0-9a-fA-F]{2})')
+
+
+def expand(payload):
+    return ZERO_RUN.sub(lambda m: '.' * int(m.group(1), 16), payload)
+
+
+def decode(payload):
+    return bytearray.fromhex(expand(payload).replace('.', '00'))
+
+
+def main(argv):
+    log = sys.stdin.read()
+    if len(argv) == 3 and argv[1] == '--binary':
+        for path, payload in COVERAGE.findall(log):
+            out = os.path.join(argv[2], path.lstrip('/'))
+            if not os.path.isdir(os.path.dirname(out)):
+                os.makedirs(os.path.dirname(out))
+            with open(out, 'wb') as f:
+                f.write(decode(payload))
+    elif len(argv) == 1:
+        sys.stdout.write(COVERAGE.sub(
+            lambda m: '{{__coverage_start;%s;%s}}' % (m.group(1), expand(m.group(2))), log))
+    else:
+        sys.stderr.write(__doc__)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
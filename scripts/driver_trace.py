@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016, ARM Limited, All Rights Reserved
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Convert a driver trace to Chrome trace JSON.
+
+mbed_driver_trace_dump() prints each record as
+
+    trace:<timestamp>:<driver>:<event>:<argument>
+
+in hex, among any other output. This reads those lines from a capture of
+the serial port and writes JSON that chrome://tracing and Perfetto open,
+with one track per driver: transfers are spans from their start to their
+completion, and the other events are instants.
+
+    driver_trace.py capture.txt > trace.json
+"""
+
+import json
+import re
+import sys
+
+DRIVERS = {
+    1: 'SPI',
+    2: 'I2C',
+    3: 'Serial TX',
+    4: 'Serial RX',
+    5: 'I2C (v2)',
+    6: 'SPI (v2)',
+    7: 'Ticker',
+}
+
+QUEUE, START, IRQ, COMPLETE, CALLBACK, FIRE = range(1, 7)
+INSTANTS = {QUEUE: 'queue', IRQ: 'irq', CALLBACK: 'callback', FIRE: 'fire'}
+
+RECORD = re.compile(r'trace:([0-9a-fA-F]{8}):([0-9a-fA-F]{2}):([0-9a-fA-F]{2}):([0-9a-fA-F]{8})')
+LOST = re.compile(r'trace-lost:([0-9a-fA-F]{8})')
+
+
+def driver_name(driver):
+    return DRIVERS.get(driver, 'user %d' % driver)
+
+
+def convert(lines):
+    events = []
+    drivers = set()
+    open_spans = set()
+    base = None
+    last = 0
+    high = 0
+    for line in lines:
+        m = LOST.search(line)
+        if m:
+            events.append({'name': 'lost %d records' % int(m.group(1), 16), 'ph': 'i', 's': 'g',
+                           'pid': 0, 'tid': 0, 'ts': last})
+            continue
+        m = RECORD.search(line)
+        if not m:
+            continue
+        stamp, driver, event, arg = [int(g, 16) for g in m.groups()]
+        # The us_ticker wraps every 71 minutes, and the trace is in time order
+        if base is None:
+            base = stamp
+        elif stamp < (last + base - high) & 0xffffffff:
+            high += 1 << 32
+        ts = stamp + high - base
+        last = ts
+        drivers.add(driver)
+        e = {'pid': 0, 'tid': driver, 'ts': ts, 'args': {'arg': '0x%08x' % arg}}
+        if event == START:
+            if driver in open_spans:
+                # The completion of the previous transfer was not recorded
+                events.append({'ph': 'E', 'pid': 0, 'tid': driver, 'ts': ts})
+            open_spans.add(driver)
+            e.update(name='transfer', ph='B')
+        elif event == COMPLETE:
+            if driver not in open_spans:
+                # The transfer started before the oldest record
+                e.update(name='complete', ph='i', s='t')
+            else:
+                open_spans.discard(driver)
+                e.update(ph='E')
+        else:
+            e.update(name=INSTANTS.get(event, 'event %d' % event), ph='i', s='t')
+        events.append(e)
+    for driver in sorted(drivers):
+        events.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': driver,
+                       'args': {'name': driver_name(driver)}})
+    return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+
+def main(argv):
+    if len(argv) > 2:
+        sys.stderr.write(__doc__)
+        return 1
+    f = open(argv[1]) if len(argv) == 2 else sys.stdin
+    with f:
+        json.dump(convert(f), sys.stdout, indent=1)
+    sys.stdout.write('\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016, ARM Limited, All Rights Reserved
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Symbolise the samples streamed by SamplingProfiler.
+
+The profiler prints lines of hex samples among any other output,
+
+    prof:<pc> <pc> ...
+    prof:<pc>/<lr> <pc>/<lr> ...
+
+This maps each PC, and LR, to a function with the symbol table of the ELF
+and prints a flat profile, or with --folded, one line per caller;function
+pair for flamegraph.pl:
+
+    profile_symbolize.py app.elf capture.txt
+    profile_symbolize.py --folded app.elf capture.txt | flamegraph.pl > profile.svg
+
+The symbol table is read with arm-none-eabi-nm, or the tool given by --nm.
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+SAMPLE = re.compile(r'([0-9a-fA-F]{8})(?:/([0-9a-fA-F]{8}))?')
+DROPPED = re.compile(r'prof-dropped:([0-9a-fA-F]{8})')
+
+
+class Symbols(object):
+    def __init__(self, nm, elf):
+        out = subprocess.check_output([nm, '-n', '-S', '-C', '--defined-only', elf])
+        self.starts = []
+        self.ends = []
+        self.names = []
+        for line in out.decode('utf-8', 'replace').splitlines():
+            fields = line.split(None, 3)
+            if len(fields) != 4 or fields[2] not in 'tTwW':
+                continue
+            # Thumb function addresses have bit 0 set
+            start = int(fields[0], 16) & ~1
+            self.starts.append(start)
+            self.ends.append(start + int(fields[1], 16))
+            self.names.append(fields[3])
+
+    def lookup(self, addr):
+        if addr >= 0xfffffff0:
+            # EXC_RETURN: the sample was taken in an exception handler entered from elsewhere
+            return '[exception return]'
+        addr &= ~1
+        i = bisect.bisect_right(self.starts, addr) - 1
+        if i >= 0 and addr < self.ends[i]:
+            return self.names[i]
+        return '0x%08x' % addr
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('elf')
+    parser.add_argument('capture', nargs='?', type=argparse.FileType('r'), default=sys.stdin)
+    parser.add_argument('--folded', action='store_true', help='print folded stacks for flamegraph.pl')
+    parser.add_argument('--nm', default='arm-none-eabi-nm')
+    args = parser.parse_args(argv[1:])
+
+    symbols = Symbols(args.nm, args.elf)
+    counts = {}
+    total = 0
+    dropped = 0
+    for line in args.capture:
+        m = DROPPED.search(line)
+        if m:
+            dropped = int(m.group(1), 16)
+            continue
+        i = line.find('prof:')
+        if i < 0:
+            continue
+        for pc, lr in SAMPLE.findall(line[i + 5:]):
+            key = symbols.lookup(int(pc, 16))
+            if args.folded and lr:
+                key = symbols.lookup(int(lr, 16)) + ';' + key
+            counts[key] = counts.get(key, 0) + 1
+            total += 1
+
+    ranked = sorted(counts.items(), key=lambda kv: (-kv[1], kv[0]))
+    if args.folded:
+        for key, n in ranked:
+            print('%s %d' % (key, n))
+        return 0
+    print('%d samples, %d dropped' % (total, dropped))
+    for key, n in ranked:
+        print('%6.2f%% %8d  %s' % (100.0 * n / total, n, key))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/BitBang.h"
+#include "us_ticker_api.h"
+
+namespace mbed {
+
+uint32_t BitBangDelay::_loops_per_ms = 0;
+
+void BitBangDelay::calibrate() {
+    // Long enough to swamp the microsecond resolution of the ticker, short enough to go unnoticed at startup
+    const uint32_t loops = 20000;
+    uint32_t start = us_ticker_read();
+    spin(loops);
+    uint32_t elapsed = us_ticker_read() - start;
+    if (!elapsed) {
+        elapsed = 1;
+    }
+    uint32_t rate = (uint32_t)(((uint64_t)loops * 1000) / elapsed);
+    _loops_per_ms = rate ? rate : 1;
+}
+
+} // namespace mbed
@@ -19,12 +19,16 @@
 namespace mbed {
 
 FileBase *FileBase::_head = NULL;
+uint32_t  FileBase::_last_id = 0;
+uint32_t  FileBase::_generation = 0;
 
 FileBase::FileBase(const char *name, PathType t) : _next(NULL),
                                                    _name(name),
-                                                   _path_type(t) {
+                                                   _path_type(t),
+                                                   _id(0) {
     if (name != NULL) {
-        // put this object at head of the list
+        // put this object at head of the list, so ids decrease along the list
+        _id = ++_last_id;
         _next = _head;
         _head = this;
     } else {
@@ -44,6 +48,8 @@ FileBase::~FileBase() {
             }
             p->_next = _next;
         }
+        // cursors may point at this object, so they must be revalidated
+        _generation++;
     }
 }
 
@@ -71,6 +77,37 @@ FileBase *FileBase::get(int n) {
     return NULL;
 }
 
+FileBase *FileBase::iterate(FileBaseCursor &cursor) {
+    FileBase *p;
+    if (cursor.id == 0) {
+        // not started: skip anything newer than the start of the iteration
+        p = _head;
+        cursor.id = _last_id + 1;
+    } else if (cursor.generation == _generation) {
+        p = cursor.next;
+    } else {
+        // an object was removed, so find our place again from the last id
+        p = _head;
+        while (p != NULL && p->_id >= cursor.id) {
+            p = p->_next;
+        }
+    }
+    if (p == NULL) {
+        cursor.next = NULL;
+        cursor.generation = _generation;
+        return NULL;
+    }
+
+    cursor.id = p->_id;
+    cursor.next = p->_next;
+    cursor.generation = _generation;
+    return p;
+}
+
+uint32_t FileBase::getId(void) {
+    return _id;
+}
+
 const char* FileBase::getName(void) {
     return _name;
 }
@@ -21,16 +21,16 @@ namespace mbed {
 class BaseDirHandle : public DirHandle {
 public:
     /*
-      We keep track of our current location as the n'th object in the
-      FileSystemLike list. Using a Base* instead would cause problems if that
-      object were to be destroyed between readdirs.
-      Using this method does mean though that destroying/creating objects can
-      give unusual results from readdir.
+      We keep track of our current location with a FileBaseCursor, which
+      remembers the id of the last object returned rather than its index in
+      the list. This keeps readdir O(1) per entry, and objects created or
+      destroyed between readdirs are neither skipped nor returned twice.
+      The position reported by telldir is the id of the last entry returned.
     */
-    off_t n;
+    FileBaseCursor cursor;
     struct dirent cur_entry;
 
-    BaseDirHandle() : n(0), cur_entry() {
+    BaseDirHandle() : cursor(), cur_entry() {
     }
 
     virtual int closedir() {
@@ -39,27 +39,28 @@ public:
     }
 
     virtual struct dirent *readdir() {
-        FileBase *ptr = FileBase::get(n);
+        FileBase *ptr = FileBase::iterate(cursor);
         if (ptr == NULL) return NULL;
 
-        /* Increment n, so next readdir gets the next item */
-        n++;
-
         /* Setup cur entry and return a pointer to it */
         std::strncpy(cur_entry.d_name, ptr->getName(), NAME_MAX);
         return &cur_entry;
     }
 
     virtual off_t telldir() {
-        return n;
+        return cursor.id;
     }
 
     virtual void seekdir(off_t offset) {
-        n = offset;
+        cursor.id = offset;
+        cursor.next = NULL;
+        /* force the cursor to find its place again from the id */
+        cursor.generation--;
     }
 
     virtual void rewinddir() {
-        n = 0;
+        cursor.id = 0;
+        cursor.next = NULL;
     }
 };
 
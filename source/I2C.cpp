@@ -16,6 +16,10 @@
  */
 #include "mbed-drivers/I2C.h"
 #include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "mbed-drivers/driver_trace.h"
+#include "mbed-drivers/mbed_stats.h"
 
 #if DEVICE_I2C
 
@@ -23,9 +27,12 @@ namespace mbed {
 
 I2C *I2C::_owner = NULL;
 
+// All the I2C objects share one group, as they may share one peripheral
+static mbed_stats_t i2c_stats = MBED_STATS_INIT("i2c");
+
 I2C::I2C(PinName sda, PinName scl) :
 #if DEVICE_I2C_ASYNCH
-                                     _irq(this), _usage(DMA_USAGE_NEVER),
+                                     _irq(this), _usage(DMA_USAGE_NEVER), _busy(false),
 #endif
                                       _i2c(), _hz(100000) {
     // The init function also set the frequency to 100000
@@ -58,6 +65,11 @@ int I2C::write(int address, const char* data, int length, bool repeated) {
 
     int stop = (repeated) ? 0 : 1;
     int written = i2c_write(&_i2c, address, data, length, stop);
+    MBED_STATS_ADD(&i2c_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&i2c_stats, MBED_STATS_BYTES, length);
+    if (length != written) {
+        MBED_STATS_ADD(&i2c_stats, MBED_STATS_ERRORS, 1);
+    }
 
     return length != written;
 }
@@ -72,6 +84,11 @@ int I2C::read(int address, char* data, int length, bool repeated) {
 
     int stop = (repeated) ? 0 : 1;
     int read = i2c_read(&_i2c, address, data, length, stop);
+    MBED_STATS_ADD(&i2c_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&i2c_stats, MBED_STATS_BYTES, length);
+    if (length != read) {
+        MBED_STATS_ADD(&i2c_stats, MBED_STATS_ERRORS, 1);
+    }
 
     return length != read;
 }
@@ -99,32 +116,121 @@ int I2C::transfer(int address, char *tx_buffer, int tx_length, char *rx_buffer,
 }
 
 int I2C::transfer(int address, const Buffer& tx_buffer, const Buffer& rx_buffer, const event_callback_t& callback, int event, bool repeated) {
-    if (i2c_active(&_i2c)) {
-        return -1; // transaction ongoing
+    transaction_data_t td;
+    td.tx_buffer = tx_buffer;
+    td.rx_buffer = rx_buffer;
+    td.event = event;
+    td.callback = callback;
+    td.address = address;
+    td.repeated = repeated;
+    {
+        // The queue is checked and filled in one critical section, so a transfer completing in between cannot
+        // leave the new one stranded in the queue
+        util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        if (_busy) {
+            return queue_transfer(td);
+        }
+        if (i2c_active(&_i2c)) {
+            return -1; // another I2C object's transaction ongoing
+        }
+        _busy = true;
     }
-    aquire();
+    start_transfer(td);
+    return 0;
+}
 
-    _current_transaction.tx_buffer = tx_buffer;
-    _current_transaction.rx_buffer = rx_buffer;
-    _current_transaction.callback = callback;
-    int stop = (repeated) ? 0 : 1;
-    _irq.callback(&I2C::irq_handler_asynch);
-    i2c_transfer_asynch(&_i2c, tx_buffer.buf, tx_buffer.length, rx_buffer.buf, rx_buffer.length, address, stop, _irq.entry(), event, _usage);
+int I2C::queue_transfer(const transaction_data_t &td)
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    if (_transaction_buffer.full()) {
+        return -1;
+    }
+    _transaction_buffer.push(td);
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C, MBED_DRIVER_TRACE_QUEUE, 0);
+    MBED_STATS_MAX(&i2c_stats, MBED_STATS_QUEUE_HIGH_WATER, _transaction_buffer.size());
     return 0;
+#else
+    (void) td;
+    return -1;
+#endif
+}
+
+void I2C::start_transfer(const transaction_data_t &td)
+{
+    aquire();
+    _current_transaction = td;
+    int stop = (td.repeated) ? 0 : 1;
+    _irq.callback(&I2C::irq_handler_asynch);
+    // All the events are enabled, so that the end of every transfer is seen and the queue moves on; the callback
+    // only receives the events that were asked for.
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C, MBED_DRIVER_TRACE_START, td.tx_buffer.length);
+    MBED_STATS_ADD(&i2c_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&i2c_stats, MBED_STATS_BYTES, td.tx_buffer.length + td.rx_buffer.length);
+    MBED_STATS_START(_stats_start);
+    i2c_transfer_asynch(&_i2c, td.tx_buffer.buf, td.tx_buffer.length, td.rx_buffer.buf, td.rx_buffer.length,
+            td.address, stop, _irq.entry(), I2C_EVENT_ALL, _usage);
+}
+
+void I2C::dequeue_transaction()
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    transaction_data_t td;
+    bool dequeued;
+    {
+        util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        dequeued = _transaction_buffer.pop(td);
+        _busy = dequeued;
+    }
+    if (dequeued) {
+        start_transfer(td);
+    }
+#else
+    _busy = false;
+#endif
 }
 
 void I2C::abort_transfer(void)
 {
     i2c_abort_asynch(&_i2c);
+    dequeue_transaction();
+}
+
+void I2C::clear_transfer_buffer()
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    _transaction_buffer.reset();
+#endif
+}
+
+void I2C::abort_all_transfers()
+{
+    clear_transfer_buffer();
+    abort_transfer();
 }
 
 void I2C::irq_handler_asynch(void)
 {
     int event = i2c_irq_handler_asynch(&_i2c);
-    if (_current_transaction.callback && event) {
-        minar::Scheduler::postCallback(_current_transaction.callback.bind(_current_transaction.tx_buffer, _current_transaction.rx_buffer, event));
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C, MBED_DRIVER_TRACE_IRQ, event);
+    if (!event) {
+        return;
     }
-
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C, MBED_DRIVER_TRACE_COMPLETE, event);
+    MBED_STATS_COMPLETE(&i2c_stats, _stats_start);
+    if (event & I2C_EVENT_ALL & ~I2C_EVENT_TRANSFER_COMPLETE) {
+        MBED_STATS_ADD(&i2c_stats, MBED_STATS_ERRORS, 1);
+    }
+    if (_current_transaction.callback && (event & _current_transaction.event)) {
+        minar::Scheduler::postCallback(_current_transaction.callback.bind(_current_transaction.tx_buffer, _current_transaction.rx_buffer, event & _current_transaction.event));
+    }
+    // Every I2C event ends the transfer, so start the next one straight away
+    dequeue_transaction();
 }
 
 
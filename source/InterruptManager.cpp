@@ -18,6 +18,7 @@
 #if defined(NVIC_NUM_VECTORS)
 
 #include "mbed-drivers/InterruptManager.h"
+#include "mbed-drivers/mbed_stats.h"
 #include <string.h>
 
 #define CHAIN_INITIAL_SIZE    4
@@ -28,6 +29,8 @@ typedef void (*pvoidf)(void);
 
 InterruptManager* InterruptManager::_instance = (InterruptManager*)NULL;
 
+static mbed_stats_t interrupt_stats = MBED_STATS_INIT("interrupts");
+
 InterruptManager* InterruptManager::get() {
     if (NULL == _instance)
         _instance = new InterruptManager();
@@ -93,6 +96,7 @@ bool InterruptManager::remove_handler(pFunctionPointer_t handler, IRQn_Type irq)
 }
 
 void InterruptManager::irq_helper() {
+    MBED_STATS_ADD(&interrupt_stats, MBED_STATS_TRANSFERS, 1);
     _chains[__get_IPSR()]->call();
 }
 
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/Poller.h"
+#include "core-util/atomic_ops.h"
+#include "minar/minar.h"
+
+namespace mbed {
+
+Poller::Poller() : _pending(0) {
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES; i++) {
+        _entries[i].fh = NULL;
+    }
+}
+
+Poller::~Poller() {
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES; i++) {
+        if (_entries[i].fh != NULL) {
+            remove(_entries[i].fh);
+        }
+    }
+}
+
+int Poller::add(FileHandle *fh, short events, const event_callback_t &callback) {
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES; i++) {
+        if (_entries[i].fh == NULL) {
+            _entries[i].fh = fh;
+            _entries[i].events = events;
+            _entries[i].callback = callback;
+            fh->sigio(mbed::util::FunctionPointer(this, &Poller::notify));
+            /* The handle may already be ready, in which case sigio will not fire */
+            notify();
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int Poller::remove(FileHandle *fh) {
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES; i++) {
+        if (_entries[i].fh == fh) {
+            fh->sigio(mbed::util::FunctionPointer());
+            _entries[i].fh = NULL;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void Poller::notify() {
+    /* Called from interrupt context: coalesce notifications into a single dispatch */
+    uint32_t expected = 0;
+    if (mbed::util::atomic_cas<uint32_t>(const_cast<uint32_t *>(&_pending), &expected, 1)) {
+        minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &Poller::dispatch).bind());
+    }
+}
+
+void Poller::dispatch() {
+    _pending = 0;
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_POLLER_MAX_HANDLES; i++) {
+        FileHandle *fh = _entries[i].fh;
+        if (fh == NULL) {
+            continue;
+        }
+        short revents = fh->poll(_entries[i].events);
+        if (revents) {
+            _entries[i].callback(fh, revents);
+            /* Dispatch is edge triggered: only the next sigio() posts another.
+             * Polling again lets a handle that masks its notification while
+             * data is waiting, as Serial does, re-arm it now it has been read. */
+            if (_entries[i].fh == fh) {
+                fh->poll(_entries[i].events);
+            }
+        }
+    }
+}
+
+} // namespace mbed
@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/RamFileSystem.h"
+
+#include <cstring>
+
+#define RAMFS_EXTENT_SIZE   YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE
+#define RAMFS_NAME_MAX      YOTTA_CFG_MBED_DRIVERS_RAMFS_NAME_MAX
+#define RAMFS_NO_EXTENT     0xFFFF
+
+#ifndef O_ACCMODE
+#   define O_ACCMODE (O_RDONLY|O_WRONLY|O_RDWR)
+#endif
+
+namespace mbed {
+
+class RamDirHandle : public DirHandle {
+public:
+    RamDirHandle(RamFileSystem *fs) : _fs(fs), _n(0), _cur_entry() {
+    }
+
+    virtual int closedir() {
+        delete this;
+        return 0;
+    }
+
+    virtual struct dirent *readdir() {
+        while (_n < (off_t)_fs->_max_files) {
+            RamInode *inode = &_fs->_inodes[_n++];
+            if (inode->used) {
+                std::strncpy(_cur_entry.d_name, inode->name, NAME_MAX);
+                return &_cur_entry;
+            }
+        }
+        return NULL;
+    }
+
+    virtual off_t telldir() {
+        return _n;
+    }
+
+    virtual void seekdir(off_t offset) {
+        _n = offset;
+    }
+
+    virtual void rewinddir() {
+        _n = 0;
+    }
+
+protected:
+    RamFileSystem *_fs;
+    off_t _n;
+    struct dirent _cur_entry;
+};
+
+RamFileHandle::RamFileHandle() : _fs(NULL), _inode(NULL), _pos(0), _flags(0),
+                                 _extent(RAMFS_NO_EXTENT), _extent_base(0), _in_use(false) {
+}
+
+uint8_t *RamFileHandle::locate(off_t pos, size_t *avail) {
+    off_t base = _extent_base;
+    uint16_t e = _fs->walk(_inode, pos, _extent, &base);
+    if (e == RAMFS_NO_EXTENT) {
+        return NULL;
+    }
+    _extent = e;
+    _extent_base = base;
+    *avail = RAMFS_EXTENT_SIZE - (pos - base);
+    return _fs->extent(e) + (pos - base);
+}
+
+ssize_t RamFileHandle::write(const void* buffer, size_t length) {
+    if ((_flags & O_ACCMODE) == O_RDONLY) {
+        return -1;
+    }
+    if (_flags & O_APPEND) {
+        _pos = _inode->size;
+    }
+
+    size_t capacity = _fs->reserve(_inode, _pos, _pos + length);
+    if ((off_t)capacity <= _pos) {
+        return 0;
+    }
+    if (_pos + length > capacity) {
+        length = capacity - _pos;
+    }
+
+    const uint8_t *src = (const uint8_t *)buffer;
+    size_t done = 0;
+    while (done < length) {
+        size_t avail;
+        uint8_t *dst = locate(_pos, &avail);
+        if (dst == NULL) {
+            break;
+        }
+        size_t n = (length - done < avail) ? length - done : avail;
+        std::memcpy(dst, src + done, n);
+        done += n;
+        _pos += n;
+    }
+    if ((size_t)_pos > _inode->size) {
+        _inode->size = _pos;
+    }
+    return done;
+}
+
+ssize_t RamFileHandle::read(void* buffer, size_t length) {
+    if ((_flags & O_ACCMODE) == O_WRONLY) {
+        return -1;
+    }
+    if (_pos >= (off_t)_inode->size) {
+        return 0;
+    }
+    if (length > _inode->size - _pos) {
+        length = _inode->size - _pos;
+    }
+
+    uint8_t *dst = (uint8_t *)buffer;
+    size_t done = 0;
+    while (done < length) {
+        size_t avail;
+        const uint8_t *src = locate(_pos, &avail);
+        if (src == NULL) {
+            break;
+        }
+        size_t n = (length - done < avail) ? length - done : avail;
+        std::memcpy(dst + done, src, n);
+        done += n;
+        _pos += n;
+    }
+    return done;
+}
+
+int RamFileHandle::close() {
+    _inode->open_count--;
+    _inode = NULL;
+    _in_use = false;
+    return 0;
+}
+
+int RamFileHandle::isatty() {
+    return 0;
+}
+
+off_t RamFileHandle::lseek(off_t offset, int whence) {
+    off_t pos;
+    switch (whence) {
+        case SEEK_SET: pos = offset; break;
+        case SEEK_CUR: pos = _pos + offset; break;
+        case SEEK_END: pos = _inode->size + offset; break;
+        default: return -1;
+    }
+    if (pos < 0) {
+        return -1;
+    }
+    _pos = pos;
+    return _pos;
+}
+
+int RamFileHandle::fsync() {
+    // Nothing is buffered, so the arena is always up to date
+    return 0;
+}
+
+off_t RamFileHandle::flen() {
+    return _inode->size;
+}
+
+const void *RamFileHandle::map(off_t offset, size_t *length) {
+    if (offset < 0 || offset >= (off_t)_inode->size) {
+        return NULL;
+    }
+    size_t avail;
+    const uint8_t *p = locate(offset, &avail);
+    if (p == NULL) {
+        return NULL;
+    }
+    if (avail > _inode->size - offset) {
+        avail = _inode->size - offset;
+    }
+    if (*length > avail) {
+        *length = avail;
+    }
+    return p;
+}
+
+const void *RamFileHandle::mmap(off_t offset, size_t length) {
+    if (offset < 0 || length == 0 || offset + length > _inode->size) {
+        return NULL;
+    }
+    size_t avail;
+    const uint8_t *p = locate(offset, &avail);
+    if (p != NULL && length <= avail) {
+        return p;
+    }
+    return FileHandle::mmap(offset, length);
+}
+
+int RamFileHandle::munmap(const void *addr, size_t length) {
+    const uint8_t *p = (const uint8_t *)addr;
+    if (p >= _fs->_extents && p < _fs->_extents + (size_t)_fs->_nextents * RAMFS_EXTENT_SIZE) {
+        return 0;
+    }
+    return FileHandle::munmap(addr, length);
+}
+
+RamFileSystem::RamFileSystem(const char *name, void *arena, size_t size, unsigned max_files) :
+        FileSystemLike(name), _inodes(NULL), _links(NULL), _extents(NULL), _max_files(0),
+        _nextents(0), _free(RAMFS_NO_EXTENT), _nfree(0) {
+    /* Carve the arena into the inode table, the extent links and the extents */
+    uintptr_t start = (uintptr_t)arena;
+    uintptr_t end = start + size;
+    uintptr_t p = (start + sizeof(size_t) - 1) & ~(uintptr_t)(sizeof(size_t) - 1);
+    if (p + max_files * sizeof(RamInode) > end) {
+        return;
+    }
+    _inodes = (RamInode *)p;
+    _max_files = max_files;
+    p += max_files * sizeof(RamInode);
+
+    /* Extents are pointer aligned, so that mapped contents can hold any
+     * type; the links before them may leave up to a pointer's worth of padding */
+    const uintptr_t align = sizeof(void *);
+    if (end - p < align) {
+        return;
+    }
+    size_t n = (end - p - (align - 1)) / (RAMFS_EXTENT_SIZE + sizeof(uint16_t));
+    if (n >= RAMFS_NO_EXTENT) {
+        n = RAMFS_NO_EXTENT - 1;
+    }
+    _links = (uint16_t *)p;
+    _extents = (uint8_t *)((p + n * sizeof(uint16_t) + align - 1) & ~(align - 1));
+    _nextents = n;
+
+    std::memset(_inodes, 0, max_files * sizeof(RamInode));
+    /* Thread all the extents onto the free list */
+    for (uint16_t i = 0; i < _nextents; i++) {
+        _links[i] = (i + 1 < _nextents) ? i + 1 : RAMFS_NO_EXTENT;
+    }
+    _free = _nextents ? 0 : RAMFS_NO_EXTENT;
+    _nfree = _nextents;
+
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_RAMFS_MAX_OPEN; i++) {
+        _handles[i]._fs = this;
+    }
+}
+
+RamFileSystem::~RamFileSystem() {
+}
+
+uint8_t *RamFileSystem::extent(uint16_t index) {
+    return _extents + (size_t)index * RAMFS_EXTENT_SIZE;
+}
+
+uint16_t RamFileSystem::alloc_extent() {
+    uint16_t e = _free;
+    if (e != RAMFS_NO_EXTENT) {
+        _free = _links[e];
+        _links[e] = RAMFS_NO_EXTENT;
+        _nfree--;
+        /* Bytes past the end of a file always read as zero */
+        std::memset(extent(e), 0, RAMFS_EXTENT_SIZE);
+    }
+    return e;
+}
+
+void RamFileSystem::free_extents(RamInode *inode) {
+    uint16_t e = inode->first;
+    while (e != RAMFS_NO_EXTENT) {
+        uint16_t next = _links[e];
+        _links[e] = _free;
+        _free = e;
+        _nfree++;
+        e = next;
+    }
+    inode->first = RAMFS_NO_EXTENT;
+    inode->last = RAMFS_NO_EXTENT;
+    inode->extents = 0;
+    inode->size = 0;
+
+    /* Cached extents in open handles no longer belong to this file */
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_RAMFS_MAX_OPEN; i++) {
+        if (_handles[i]._inode == inode) {
+            _handles[i]._extent = RAMFS_NO_EXTENT;
+            _handles[i]._extent_base = 0;
+        }
+    }
+}
+
+size_t RamFileSystem::reserve(RamInode *inode, size_t start, size_t size) {
+    size_t have = (size_t)inode->extents * RAMFS_EXTENT_SIZE;
+    if (have >= size) {
+        return have;
+    }
+    size_t want = (size - have + RAMFS_EXTENT_SIZE - 1) / RAMFS_EXTENT_SIZE;
+    if (want > _nfree) {
+        /* Take what is left only if the write can begin in it, so that a
+         * write far past the end cannot drain the arena and then fail */
+        want = _nfree;
+        if (have + want * RAMFS_EXTENT_SIZE <= start) {
+            return have;
+        }
+    }
+    while (want--) {
+        uint16_t e = alloc_extent();
+        if (inode->first == RAMFS_NO_EXTENT) {
+            inode->first = e;
+        } else {
+            _links[inode->last] = e;
+        }
+        inode->last = e;
+        inode->extents++;
+    }
+    return (size_t)inode->extents * RAMFS_EXTENT_SIZE;
+}
+
+uint16_t RamFileSystem::walk(RamInode *inode, off_t pos, uint16_t hint, off_t *base) {
+    uint16_t e = hint;
+    off_t b = *base;
+    /* Extents are singly linked, so a hint past pos is no use */
+    if (e == RAMFS_NO_EXTENT || b > pos) {
+        e = inode->first;
+        b = 0;
+    }
+    while (e != RAMFS_NO_EXTENT && pos >= b + RAMFS_EXTENT_SIZE) {
+        e = _links[e];
+        b += RAMFS_EXTENT_SIZE;
+    }
+    *base = b;
+    return e;
+}
+
+RamInode *RamFileSystem::find(const char *filename) {
+    for (unsigned i = 0; i < _max_files; i++) {
+        if (_inodes[i].used && std::strcmp(_inodes[i].name, filename) == 0) {
+            return &_inodes[i];
+        }
+    }
+    return NULL;
+}
+
+FileHandle *RamFileSystem::open(const char *filename, int flags) {
+    if (std::strchr(filename, '/') != NULL || std::strlen(filename) > RAMFS_NAME_MAX || filename[0] == 0) {
+        return NULL;
+    }
+
+    RamFileHandle *fh = NULL;
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_RAMFS_MAX_OPEN; i++) {
+        if (!_handles[i]._in_use) {
+            fh = &_handles[i];
+            break;
+        }
+    }
+    if (fh == NULL) {
+        return NULL;
+    }
+
+    RamInode *inode = find(filename);
+    if (inode == NULL) {
+        if (!(flags & O_CREAT)) {
+            return NULL;
+        }
+        for (unsigned i = 0; i < _max_files; i++) {
+            if (!_inodes[i].used) {
+                inode = &_inodes[i];
+                break;
+            }
+        }
+        if (inode == NULL) {
+            return NULL;
+        }
+        std::strcpy(inode->name, filename);
+        inode->size = 0;
+        inode->first = RAMFS_NO_EXTENT;
+        inode->last = RAMFS_NO_EXTENT;
+        inode->extents = 0;
+        inode->open_count = 0;
+        inode->used = 1;
+    } else if ((flags & O_TRUNC) && (flags & O_ACCMODE) != O_RDONLY) {
+        free_extents(inode);
+    }
+
+    inode->open_count++;
+    fh->_inode = inode;
+    fh->_pos = 0;
+    fh->_flags = flags;
+    fh->_extent = RAMFS_NO_EXTENT;
+    fh->_extent_base = 0;
+    fh->_in_use = true;
+    return fh;
+}
+
+int RamFileSystem::remove(const char *filename) {
+    RamInode *inode = find(filename);
+    if (inode == NULL || inode->open_count) {
+        return -1;
+    }
+    free_extents(inode);
+    inode->used = 0;
+    return 0;
+}
+
+int RamFileSystem::rename(const char *oldname, const char *newname) {
+    RamInode *inode = find(oldname);
+    if (inode == NULL || std::strchr(newname, '/') != NULL || std::strlen(newname) > RAMFS_NAME_MAX) {
+        return -1;
+    }
+    RamInode *existing = find(newname);
+    if (existing == inode) {
+        return 0;
+    }
+    if (existing != NULL && remove(newname) != 0) {
+        return -1;
+    }
+    std::strcpy(inode->name, newname);
+    return 0;
+}
+
+DirHandle *RamFileSystem::opendir(const char *name) {
+    /* The namespace is flat, so only the root can be opened */
+    if (name[0] != 0) {
+        return NULL;
+    }
+    return new RamDirHandle(this);
+}
+
+const void *RamFileSystem::map(const char *filename, off_t offset, size_t *length) {
+    RamInode *inode = find(filename);
+    if (inode == NULL || offset < 0 || offset >= (off_t)inode->size) {
+        return NULL;
+    }
+    off_t base = 0;
+    uint16_t e = walk(inode, offset, RAMFS_NO_EXTENT, &base);
+    if (e == RAMFS_NO_EXTENT) {
+        return NULL;
+    }
+    size_t avail = RAMFS_EXTENT_SIZE - (offset - base);
+    if (avail > inode->size - offset) {
+        avail = inode->size - offset;
+    }
+    if (*length > avail) {
+        *length = avail;
+    }
+    return extent(e) + (offset - base);
+}
+
+size_t RamFileSystem::free_space() {
+    return (size_t)_nfree * RAMFS_EXTENT_SIZE;
+}
+
+} // namespace mbed
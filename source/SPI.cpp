@@ -18,6 +18,12 @@
 #include "minar/minar.h"
 #include "mbed-drivers/mbed_assert.h"
 #include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "mbed-drivers/driver_trace.h"
+#include "mbed-drivers/mbed_stats.h"
+#include "compiler-polyfill/attributes.h"
+
+#include <string.h>
 
 #if DEVICE_SPI
 namespace mbed {
@@ -59,6 +65,9 @@ void SPI::frequency(int hz) {
 
 SPI* SPI::_owner = NULL;
 
+// All the SPI objects share one group, as they may share one peripheral
+static mbed_stats_t spi_stats = MBED_STATS_INIT("spi");
+
 // ignore the fact there are multiple physical spis, and always update if it wasnt us last
 void SPI::aquire() {
      if (_owner != this) {
@@ -70,9 +79,51 @@ void SPI::aquire() {
 
 int SPI::write(int value) {
     aquire();
+    MBED_STATS_ADD(&spi_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&spi_stats, MBED_STATS_BYTES, (_bits + 7) / 8);
     return spi_master_write(&_spi, value);
 }
 
+int SPI::write(const void *tx, void *rx, size_t length) {
+    size_t width = _bits <= 8 ? 1 : _bits <= 16 ? 2 : 4;
+    if (length % width) {
+        return -1;
+    }
+    aquire();
+    MBED_STATS_ADD(&spi_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&spi_stats, MBED_STATS_BYTES, length);
+    spi_master_write_block(&_spi, tx, rx, length / width, width);
+    return length / width;
+}
+
+} // namespace mbed
+
+extern "C" __weak void spi_master_write_block(spi_t *obj, const void *tx, void *rx, size_t frames, size_t width) {
+    // The buffers need not be aligned, so frames are copied in and out byte-wise rather than loaded through a cast
+    const uint8_t *tx8 = static_cast<const uint8_t *>(tx);
+    uint8_t *rx8 = static_cast<uint8_t *>(rx);
+    for (size_t i = 0; i < frames; i++) {
+        uint32_t out = SPI_FILL_WORD;
+        if (tx8) {
+            switch (width) {
+                case 1: out = tx8[i]; break;
+                case 2: { uint16_t f; memcpy(&f, tx8 + 2 * i, 2); out = f; break; }
+                default: memcpy(&out, tx8 + 4 * i, 4); break;
+            }
+        }
+        uint32_t in = spi_master_write(obj, out);
+        if (rx8) {
+            switch (width) {
+                case 1: rx8[i] = in; break;
+                case 2: { uint16_t f = in; memcpy(rx8 + 2 * i, &f, 2); break; }
+                default: memcpy(rx8 + 4 * i, &in, 4); break;
+            }
+        }
+    }
+}
+
+namespace mbed {
+
 #if DEVICE_SPI_ASYNCH
 
 int SPI::transfer(const SPI::SPITransferAdder &td)
@@ -80,6 +131,7 @@ int SPI::transfer(const SPI::SPITransferAdder &td)
     bool queue;
     {
         CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
         queue = _busy;
         _busy = true;
     }
@@ -125,6 +177,7 @@ int SPI::queue_transfer(const transaction_data_t &td)
 {
 #if TRANSACTION_QUEUE_SIZE_SPI
     CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
     int result;
 
     transaction_t transaction(this, td);
@@ -132,6 +185,8 @@ int SPI::queue_transfer(const transaction_data_t &td)
         result = -1;
     } else {
         _transaction_buffer.push(transaction);
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI, MBED_DRIVER_TRACE_QUEUE, 0);
+        MBED_STATS_MAX(&spi_stats, MBED_STATS_QUEUE_HIGH_WATER, _transaction_buffer.size());
         result = 0;
     }
     return result;
@@ -145,6 +200,11 @@ void SPI::start_transfer(const transaction_data_t &td)
     aquire();
     _current_transaction = td;
     _irq.callback(&SPI::irq_handler_asynch);
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI, MBED_DRIVER_TRACE_START, td.tx_buffer.length);
+    MBED_STATS_ADD(&spi_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&spi_stats, MBED_STATS_BYTES,
+            td.tx_buffer.length > td.rx_buffer.length ? td.tx_buffer.length : td.rx_buffer.length);
+    MBED_STATS_START(_stats_start);
     spi_master_transfer(&_spi, td.tx_buffer.buf, td.tx_buffer.length, td.rx_buffer.buf, td.rx_buffer.length,
             _irq.entry(), td.event, _usage);
 }
@@ -162,6 +222,7 @@ void SPI::dequeue_transaction()
     bool dequeued;
     {
         CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
         dequeued = _transaction_buffer.pop(t);
         _busy = dequeued;
     }
@@ -178,6 +239,14 @@ void SPI::dequeue_transaction()
 void SPI::irq_handler_asynch(void)
 {
     int event = spi_irq_handler_asynch(&_spi);
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI, MBED_DRIVER_TRACE_IRQ, event);
+    if (event & SPI_EVENT_ALL) {
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI, MBED_DRIVER_TRACE_COMPLETE, event & SPI_EVENT_ALL);
+        MBED_STATS_COMPLETE(&spi_stats, _stats_start);
+        if (event & (SPI_EVENT_ERROR | SPI_EVENT_RX_OVERFLOW)) {
+            MBED_STATS_ADD(&spi_stats, MBED_STATS_ERRORS, 1);
+        }
+    }
     if (_current_transaction.callback && (event & SPI_EVENT_ALL)) {
         minar::Scheduler::postCallback(
                 _current_transaction.callback.bind(_current_transaction.tx_buffer, _current_transaction.rx_buffer,
@@ -210,21 +279,21 @@ SPI::SPITransferAdder::SPITransferAdder(const SPITransferAdder &a)
 }
 SPI::SPITransferAdder & SPI::SPITransferAdder::tx(void *txBuf, size_t txSize)
 {
-    MBED_ASSERT(!_td.tx_buffer.length);
+    MBED_ASSERT_ID(!_td.tx_buffer.length);
     _td.tx_buffer.buf = txBuf;
     _td.tx_buffer.length = txSize;
     return *this;
 }
 SPI::SPITransferAdder & SPI::SPITransferAdder::rx(void *rxBuf, size_t rxSize)
 {
-    MBED_ASSERT(!_td.rx_buffer.length);
+    MBED_ASSERT_ID(!_td.rx_buffer.length);
     _td.rx_buffer.buf = rxBuf;
     _td.rx_buffer.length = rxSize;
     return *this;
 }
 SPI::SPITransferAdder & SPI::SPITransferAdder::callback(const event_callback_t &cb, int event)
 {
-    MBED_ASSERT(!_td.callback);
+    MBED_ASSERT_ID(!_td.callback);
     _td.callback = cb;
     _td.event = event;
     return *this;
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/SamplingProfiler.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "core-util/FunctionPointer.h"
+#include "cmsis.h"
+
+#include <stdio.h>
+#include <new>
+
+#if defined(TOOLCHAIN_GCC)
+/* PendSV handler: pass the exception frame of the interrupted code, from the
+ * stack it was using, to SamplingProfiler::sample(). LR still holds
+ * EXC_RETURN, so sample() returns from the exception. Only instructions
+ * that mean the same in divided and unified syntax are used, and all are
+ * Thumb-1, so that it also runs on ARMv6-M. */
+extern "C" void sampling_profiler_sample(const uint32_t *frame) {
+    mbed::SamplingProfiler::sample(frame);
+}
+
+extern "C" __attribute__((naked)) void sampling_profiler_pendsv(void) {
+    __asm volatile(
+        "mov r1, lr\n"
+        "ldr r0, =4\n"
+        "tst r1, r0\n"
+        "beq 1f\n"
+        "mrs r0, psp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, msp\n"
+        "2:\n"
+        "ldr r1, =sampling_profiler_sample\n"
+        "bx r1\n"
+        ".ltorg\n"
+    );
+}
+#endif
+
+namespace mbed {
+
+// Stacked registers: r0, r1, r2, r3, r12, lr, pc, xpsr
+#define FRAME_LR 5
+#define FRAME_PC 6
+
+// Samples per line when streaming
+#define STREAM_LINE 8
+
+SamplingProfiler * volatile SamplingProfiler::_active = NULL;
+
+SamplingProfiler::SamplingProfiler(size_t capacity, bool with_lr) :
+        _buffer(NULL), _capacity(0), _head(0), _tail(0), _dropped(0), _reported(0), _period(0), _next(0),
+        _lr(with_lr), _running(false), _stream(NULL), _saved_vector(0), _saved_priority(0) {
+    set_capacity(capacity);
+}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+    delete[] _buffer;
+}
+
+int SamplingProfiler::start(uint32_t period_us, uint32_t stream_ms) {
+#if defined(TOOLCHAIN_GCC)
+    if (_buffer == NULL || period_us == 0) {
+        return -1;
+    }
+    {
+        util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        if (_active != NULL) {
+            return -1;
+        }
+        _active = this;
+    }
+    _period = period_us;
+    _running = true;
+    // PendSV must be below every other interrupt, so that it samples the code they interrupted rather than them
+    _saved_vector = NVIC_GetVector(PendSV_IRQn);
+    _saved_priority = NVIC_GetPriority(PendSV_IRQn);
+    NVIC_SetPriority(PendSV_IRQn, 0xFF);
+    NVIC_SetVector(PendSV_IRQn, (uint32_t)sampling_profiler_pendsv);
+    if (stream_ms) {
+        _stream = minar::Scheduler::postCallback(util::FunctionPointer(this, &SamplingProfiler::stream).bind())
+                .period(minar::milliseconds(stream_ms))
+                .getHandle();
+    }
+    _next = ticker_read(_ticker_data) + _period;
+    insert(_next);
+    return 0;
+#else
+    (void)period_us;
+    (void)stream_ms;
+    return -1;
+#endif
+}
+
+void SamplingProfiler::stop() {
+    if (!_running) {
+        return;
+    }
+    remove();
+    {
+        util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        SCB->ICSR = SCB_ICSR_PENDSVCLR_Msk;
+        NVIC_SetVector(PendSV_IRQn, _saved_vector);
+        NVIC_SetPriority(PendSV_IRQn, _saved_priority);
+        _running = false;
+        _active = NULL;
+    }
+    if (_stream) {
+        minar::Scheduler::cancelCallback(_stream);
+        _stream = NULL;
+    }
+}
+
+void SamplingProfiler::set_period(uint32_t period_us) {
+    if (period_us) {
+        _period = period_us;
+    }
+}
+
+int SamplingProfiler::set_capacity(size_t capacity) {
+    if (_running) {
+        return -1;
+    }
+    delete[] _buffer;
+    // One slot is always left empty, so that a full ring can be told from an empty one
+    _buffer = new (std::nothrow) uint32_t[(capacity + 1) * (_lr ? 2 : 1)];
+    _capacity = _buffer ? capacity + 1 : 0;
+    _head = 0;
+    _tail = 0;
+    return _buffer ? 0 : -1;
+}
+
+void SamplingProfiler::handler() {
+    _next += _period;
+    timestamp_t now = ticker_read(_ticker_data);
+    if ((int)(_next - now) <= 0) {
+        // Samples were missed, perhaps with interrupts disabled; carry on from now rather than catching up
+        _next = now + _period;
+    }
+    insert(_next);
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+void SamplingProfiler::sample(const uint32_t *frame) {
+    SamplingProfiler *p = _active;
+    if (p == NULL) {
+        return;
+    }
+    // Only PendSV writes _head, and only read() writes _tail
+    uint32_t head = p->_head;
+    uint32_t next = head + 1 == p->_capacity ? 0 : head + 1;
+    if (next == p->_tail) {
+        p->_dropped++;
+        return;
+    }
+    if (p->_lr) {
+        p->_buffer[head * 2] = frame[FRAME_PC];
+        p->_buffer[head * 2 + 1] = frame[FRAME_LR];
+    } else {
+        p->_buffer[head] = frame[FRAME_PC];
+    }
+    p->_head = next;
+}
+
+size_t SamplingProfiler::read(uint32_t *samples, size_t count) {
+    size_t words = _lr ? 2 : 1;
+    size_t n = 0;
+    uint32_t tail = _tail;
+    while (n < count && tail != _head) {
+        for (size_t i = 0; i < words; i++) {
+            samples[n * words + i] = _buffer[tail * words + i];
+        }
+        n++;
+        tail = tail + 1 == _capacity ? 0 : tail + 1;
+        _tail = tail;
+    }
+    return n;
+}
+
+void SamplingProfiler::stream() {
+    uint32_t batch[STREAM_LINE * 2];
+    size_t n;
+    // A ring's worth at most, so that a fast sampling rate cannot keep minar here
+    for (size_t lines = 0; lines <= _capacity / STREAM_LINE; lines++) {
+        n = read(batch, STREAM_LINE);
+        if (n == 0) {
+            break;
+        }
+        printf("prof:");
+        for (size_t i = 0; i < n; i++) {
+            if (_lr) {
+                printf(i ? " %08lx/%08lx" : "%08lx/%08lx", (unsigned long)batch[i * 2],
+                       (unsigned long)batch[i * 2 + 1]);
+            } else {
+                printf(i ? " %08lx" : "%08lx", (unsigned long)batch[i]);
+            }
+        }
+        printf("\r\n");
+    }
+    if (_dropped != _reported) {
+        _reported = _dropped;
+        printf("prof-dropped:%08lx\r\n", (unsigned long)_reported);
+    }
+}
+
+} // namespace mbed
@@ -32,6 +32,77 @@ int Serial::_putc(int c) {
     return _base_putc(c);
 }
 
+short Serial::poll(short events) {
+    short revents = 0;
+    if ((events & POLLIN) && readable()) {
+        revents |= POLLIN;
+    }
+    if ((events & POLLOUT) && writeable()) {
+        revents |= POLLOUT;
+    }
+    /* Re-arm the notification once the received data has been consumed */
+    if (_sigio && !readable()) {
+        serial_irq_set(&_serial, (SerialIrq)RxIrq, 1);
+    }
+    return revents;
+}
+
+mbed::util::FunctionPointer Serial::sigio(const mbed::util::FunctionPointer &func) {
+    mbed::util::FunctionPointer last = _sigio;
+    _sigio = func;
+    if (_sigio) {
+        _rx_notify.attach(this, &Serial::sigio_irq);
+        serial_irq_set(&_serial, (SerialIrq)RxIrq, 1);
+    } else {
+        _rx_notify = mbed::util::FunctionPointer();
+        /* Leave the interrupt to a handler attached to RxIrq */
+        if (!_irq[RxIrq]) {
+            serial_irq_set(&_serial, (SerialIrq)RxIrq, 0);
+        }
+    }
+    return last;
+}
+
+void Serial::sigio_irq() {
+    /* The receive interrupt is level triggered, so leave it masked until
+     * poll() finds the data has been read, or it will fire continuously.
+     * A handler attached to RxIrq reads the data itself, so then the
+     * interrupt stays on for it. */
+    if (!_irq[RxIrq]) {
+        serial_irq_set(&_serial, (SerialIrq)RxIrq, 0);
+    }
+    _sigio.call();
+}
+
+#if DEVICE_SERIAL_ASYNCH
+int Serial::read_async(void *buffer, size_t length, const io_callback_t &callback) {
+    if (SerialBase::read(buffer, length, event_callback_t(this, &Serial::read_async_done)) != 0) {
+        return -1;
+    }
+    /* The completion is posted to the scheduler, so it cannot run before this */
+    _read_async_callback = callback;
+    return 0;
+}
+
+int Serial::write_async(const void *buffer, size_t length, const io_callback_t &callback) {
+    if (SerialBase::write(const_cast<void *>(buffer), length, event_callback_t(this, &Serial::write_async_done)) != 0) {
+        return -1;
+    }
+    _write_async_callback = callback;
+    return 0;
+}
+
+void Serial::read_async_done(Buffer buffer, int event) {
+    ssize_t n = (event & SERIAL_EVENT_RX_COMPLETE) ? buffer.length : -1;
+    _read_async_callback(buffer, n);
+}
+
+void Serial::write_async_done(Buffer buffer, int event) {
+    ssize_t n = (event & SERIAL_EVENT_TX_COMPLETE) ? buffer.length : -1;
+    _write_async_callback(buffer, n);
+}
+#endif
+
 } // namespace mbed
 
 #endif
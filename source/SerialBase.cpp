@@ -17,11 +17,15 @@
 #include "mbed-drivers/SerialBase.h"
 #include "mbed-drivers/wait_api.h"
 #include "minar/minar.h"
+#include "mbed-drivers/driver_trace.h"
+#include "mbed-drivers/mbed_stats.h"
 
 #if DEVICE_SERIAL
 
 namespace mbed {
 
+static mbed_stats_t serial_stats = MBED_STATS_INIT("serial");
+
 SerialBase::SerialBase(PinName tx, PinName rx) :
 #if DEVICE_SERIAL_ASYNCH
                                                  _thunk_irq(this), _tx_usage(DMA_USAGE_NEVER),
@@ -55,20 +59,31 @@ void SerialBase::attach(void (*fptr)(void), IrqType type) {
         _irq[type].attach(fptr);
         serial_irq_set(&_serial, (SerialIrq)type, 1);
     } else {
-        serial_irq_set(&_serial, (SerialIrq)type, 0);
+        _irq[type] = mbed::util::FunctionPointer();
+        /* Serial::sigio() may still need the receive interrupt */
+        if (type != RxIrq || !_rx_notify) {
+            serial_irq_set(&_serial, (SerialIrq)type, 0);
+        }
     }
 }
 
 void SerialBase::_irq_handler(uint32_t id, SerialIrq irq_type) {
     SerialBase *handler = (SerialBase*)id;
-    handler->_irq[irq_type].call();
+    if (handler->_irq[irq_type]) {
+        handler->_irq[irq_type].call();
+    }
+    if (irq_type == RxIrq && handler->_rx_notify) {
+        handler->_rx_notify.call();
+    }
 }
 
 int SerialBase::_base_getc() {
+    MBED_STATS_ADD(&serial_stats, MBED_STATS_BYTES, 1);
     return serial_getc(&_serial);
 }
 
 int SerialBase::_base_putc(int c) {
+    MBED_STATS_ADD(&serial_stats, MBED_STATS_BYTES, 1);
     serial_putc(&_serial, c);
     return c;
 }
@@ -130,6 +145,10 @@ void SerialBase::start_write(const Buffer& buffer, char buffer_width, const even
     _current_tx_transaction.callback = callback;
     _current_tx_transaction.buffer = buffer;
     _thunk_irq.callback(&SerialBase::interrupt_handler_asynch);
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SERIAL_TX, MBED_DRIVER_TRACE_START, buffer.length);
+    MBED_STATS_ADD(&serial_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&serial_stats, MBED_STATS_BYTES, buffer.length);
+    MBED_STATS_START(_stats_tx_start);
     serial_tx_asynch(&_serial, buffer.buf, buffer.length, 0, _thunk_irq.entry(), event, _tx_usage);
 }
 
@@ -181,6 +200,9 @@ void SerialBase::start_read(const Buffer& buffer, char buffer_width, const event
     _current_rx_transaction.callback = callback;
     _current_rx_transaction.buffer = buffer;
     _thunk_irq.callback(&SerialBase::interrupt_handler_asynch);
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SERIAL_RX, MBED_DRIVER_TRACE_START, buffer.length);
+    MBED_STATS_ADD(&serial_stats, MBED_STATS_TRANSFERS, 1);
+    MBED_STATS_ADD(&serial_stats, MBED_STATS_BYTES, buffer.length);
     serial_rx_asynch(&_serial, buffer.buf, buffer.length, 0, _thunk_irq.entry(), event, char_match, _rx_usage);
 }
 
@@ -188,11 +210,22 @@ void SerialBase::interrupt_handler_asynch(void)
 {
     int event = serial_irq_handler_asynch(&_serial);
     int rx_event = event & SERIAL_EVENT_RX_MASK;
+    if (rx_event) {
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SERIAL_RX, MBED_DRIVER_TRACE_COMPLETE, rx_event);
+        if (rx_event & (SERIAL_EVENT_RX_OVERRUN_ERROR | SERIAL_EVENT_RX_FRAMING_ERROR | SERIAL_EVENT_RX_PARITY_ERROR |
+                        SERIAL_EVENT_RX_OVERFLOW)) {
+            MBED_STATS_ADD(&serial_stats, MBED_STATS_ERRORS, 1);
+        }
+    }
     if (_current_rx_transaction.callback && rx_event) {
         minar::Scheduler::postCallback(_current_rx_transaction.callback.bind(_current_rx_transaction.buffer, rx_event));
     }
 
     int tx_event = event & SERIAL_EVENT_TX_MASK;
+    if (tx_event) {
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SERIAL_TX, MBED_DRIVER_TRACE_COMPLETE, tx_event);
+        MBED_STATS_COMPLETE(&serial_stats, _stats_tx_start);
+    }
     if (_current_tx_transaction.callback && tx_event) {
         minar::Scheduler::postCallback(_current_tx_transaction.callback.bind(_current_tx_transaction.buffer, tx_event));
     }
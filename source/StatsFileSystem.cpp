@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/StatsFileSystem.h"
+
+#include <cstring>
+
+#ifndef O_ACCMODE
+#   define O_ACCMODE (O_RDONLY|O_WRONLY|O_RDWR)
+#endif
+
+namespace mbed {
+
+class StatsDirHandle : public DirHandle {
+public:
+    StatsDirHandle() : _n(0), _cur_entry() {
+    }
+
+    virtual int closedir() {
+        delete this;
+        return 0;
+    }
+
+    virtual struct dirent *readdir() {
+        mbed_stats_t *s = mbed_stats_groups();
+        for (off_t i = 0; s != NULL && i < _n; i++) {
+            s = s->next;
+        }
+        if (s == NULL) {
+            return NULL;
+        }
+        _n++;
+        std::strncpy(_cur_entry.d_name, s->name, NAME_MAX);
+        return &_cur_entry;
+    }
+
+    virtual off_t telldir() {
+        return _n;
+    }
+
+    virtual void seekdir(off_t offset) {
+        _n = offset;
+    }
+
+    virtual void rewinddir() {
+        _n = 0;
+    }
+
+protected:
+    off_t _n;
+    struct dirent _cur_entry;
+};
+
+StatsFileHandle::StatsFileHandle() : _length(0), _pos(0), _in_use(false) {
+}
+
+ssize_t StatsFileHandle::write(const void* buffer, size_t length) {
+    (void)buffer;
+    (void)length;
+    return -1;
+}
+
+ssize_t StatsFileHandle::read(void* buffer, size_t length) {
+    if (_pos >= (off_t)_length) {
+        return 0;
+    }
+    if (length > _length - _pos) {
+        length = _length - _pos;
+    }
+    std::memcpy(buffer, _text + _pos, length);
+    _pos += length;
+    return length;
+}
+
+int StatsFileHandle::close() {
+    _in_use = false;
+    return 0;
+}
+
+int StatsFileHandle::isatty() {
+    return 0;
+}
+
+off_t StatsFileHandle::lseek(off_t offset, int whence) {
+    off_t pos;
+    switch (whence) {
+        case SEEK_SET: pos = offset; break;
+        case SEEK_CUR: pos = _pos + offset; break;
+        case SEEK_END: pos = _length + offset; break;
+        default: return -1;
+    }
+    if (pos < 0) {
+        return -1;
+    }
+    _pos = pos;
+    return _pos;
+}
+
+int StatsFileHandle::fsync() {
+    return 0;
+}
+
+off_t StatsFileHandle::flen() {
+    return _length;
+}
+
+StatsFileSystem::StatsFileSystem(const char *name) : FileSystemLike(name) {
+}
+
+FileHandle *StatsFileSystem::open(const char *filename, int flags) {
+    if ((flags & O_ACCMODE) != O_RDONLY) {
+        return NULL;
+    }
+    const mbed_stats_t *stats = mbed_stats_find(filename);
+    if (stats == NULL) {
+        return NULL;
+    }
+    for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_STATS_MAX_OPEN; i++) {
+        StatsFileHandle *fh = &_handles[i];
+        if (!fh->_in_use) {
+            int n = mbed_stats_format(stats, fh->_text, sizeof(fh->_text));
+            if (n < 0) {
+                return NULL;
+            }
+            // A snapshot that did not fit is cut short rather than refused
+            fh->_length = (size_t)n < sizeof(fh->_text) ? n : sizeof(fh->_text) - 1;
+            fh->_pos = 0;
+            fh->_in_use = true;
+            return fh;
+        }
+    }
+    return NULL;
+}
+
+DirHandle *StatsFileSystem::opendir(const char *name) {
+    /* The namespace is flat, so only the root can be opened */
+    if (name[0] != 0) {
+        return NULL;
+    }
+    return new StatsDirHandle();
+}
+
+} // namespace mbed
@@ -15,36 +15,60 @@
  * limitations under the License.
  */
 #include "mbed-drivers/Stream.h"
+#include "mbed-drivers/mbed_alloc_trace.h"
+#include <cstring>
 
 namespace mbed {
 
 Stream::Stream(const char *name) : FileLike(name), _file(NULL) {
-    /* open ourselves */
-    char buf[12]; /* :0x12345678 + null byte */
-    std::sprintf(buf, ":%p", this);
-    _file = std::fopen(buf, "w+");
-    setbuf(_file, NULL);
 }
 
 Stream::~Stream() {
-    fclose(_file);
+    if (_file != NULL) {
+        fclose(_file);
+    }
+}
+
+std::FILE *Stream::file() {
+    if (_file == NULL) {
+        /* open ourselves */
+        char buf[12]; /* :0x12345678 + null byte */
+        std::sprintf(buf, ":%p", this);
+        // The C library allocates the FILE, out of sight of operator new
+        MBED_ALLOC_NOTE(sizeof(std::FILE));
+        _file = std::fopen(buf, "w+");
+        setbuf(_file, NULL);
+    }
+    return _file;
 }
 
 int Stream::putc(int c) {
+    /* Without a FILE there is no buffered state to keep in order with */
+    if (_file == NULL) {
+        return _putc(c);
+    }
     fflush(_file);
     return std::fputc(c, _file);
 }
 int Stream::puts(const char *s) {
+    if (_file == NULL) {
+        size_t length = std::strlen(s);
+        return (write(s, length) == (ssize_t)length) ? 0 : EOF;
+    }
     fflush(_file);
     return std::fputs(s, _file);
 }
 int Stream::getc() {
+    if (_file == NULL) {
+        return _getc();
+    }
     fflush(_file);
     return std::fgetc(_file);
 }
 char* Stream::gets(char *s, int size) {
-    fflush(_file);
-    return std::fgets(s,size,_file);
+    std::FILE *f = file();
+    fflush(f);
+    return std::fgets(s,size,f);
 }
 
 int Stream::close() {
@@ -90,11 +114,18 @@ off_t Stream::flen() {
     return 0;
 }
 
+const void *Stream::mmap(off_t offset, size_t length) {
+    /* a stream has no contents to map */
+    (void) offset, (void) length;
+    return NULL;
+}
+
 int Stream::printf(const char* format, ...) {
     std::va_list arg;
     va_start(arg, format);
-    fflush(_file);
-    int r = vfprintf(_file, format, arg);
+    std::FILE *f = file();
+    fflush(f);
+    int r = vfprintf(f, format, arg);
     va_end(arg);
     return r;
 }
@@ -102,21 +133,24 @@ int Stream::printf(const char* format, ...) {
 int Stream::scanf(const char* format, ...) {
     std::va_list arg;
     va_start(arg, format);
-    fflush(_file);
-    int r = vfscanf(_file, format, arg);
+    std::FILE *f = file();
+    fflush(f);
+    int r = vfscanf(f, format, arg);
     va_end(arg);
     return r;
 }
 
 int Stream::vprintf(const char* format, std::va_list args) {
-    fflush(_file);
-    int r = vfprintf(_file, format, args);
+    std::FILE *f = file();
+    fflush(f);
+    int r = vfprintf(f, format, args);
     return r;
 }
 
 int Stream::vscanf(const char* format, std::va_list args) {
-    fflush(_file);
-    int r = vfscanf(_file, format, args);
+    std::FILE *f = file();
+    fflush(f);
+    int r = vfscanf(f, format, args);
     return r;
 }
 
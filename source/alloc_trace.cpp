@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed_alloc_trace.h"
+#include "mbed-drivers/mbed_error.h"
+#include "compiler-polyfill/attributes.h"
+#include "cmsis.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#define ALLOC_TRACE_SITES YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE_SITES
+
+static mbed_alloc_site_t sites[ALLOC_TRACE_SITES];
+static size_t nsites;
+static uint32_t untracked;
+static volatile int sealed;
+static volatile int in_hook;
+
+extern "C" {
+
+void mbed_alloc_trace_record(void *caller, size_t size) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    size_t i;
+    for (i = 0; i < nsites && sites[i].caller != caller; i++);
+    if (i == nsites && nsites < ALLOC_TRACE_SITES) {
+        sites[i].caller = caller;
+        sites[i].count = 0;
+        sites[i].bytes = 0;
+        nsites++;
+    }
+    if (i < nsites) {
+        sites[i].count++;
+        sites[i].bytes += size;
+    } else {
+        untracked++;
+    }
+    // The hook may allocate, for example to print, so it is not called again for those allocations
+    int trap = sealed && !in_hook;
+    if (trap) {
+        in_hook = 1;
+    }
+    __set_PRIMASK(primask);
+    if (trap) {
+        mbed_alloc_sealed_hook(caller, size);
+        in_hook = 0;
+    }
+}
+
+const mbed_alloc_site_t *mbed_alloc_trace_sites(size_t *count) {
+    *count = nsites;
+    return sites;
+}
+
+uint32_t mbed_alloc_trace_untracked(void) {
+    return untracked;
+}
+
+void mbed_alloc_trace_reset(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    nsites = 0;
+    untracked = 0;
+    __set_PRIMASK(primask);
+}
+
+void mbed_alloc_trace_report(void) {
+    size_t n;
+    const mbed_alloc_site_t *s = mbed_alloc_trace_sites(&n);
+    for (size_t i = 0; i < n; i++) {
+        printf("alloc:%08lx %lu %lu\r\n", (unsigned long)(uintptr_t)s[i].caller, (unsigned long)s[i].count,
+               (unsigned long)s[i].bytes);
+    }
+    if (untracked) {
+        printf("alloc-untracked:%lu\r\n", (unsigned long)untracked);
+    }
+}
+
+void mbed_alloc_seal(void) {
+    sealed = 1;
+}
+
+void mbed_alloc_unseal(void) {
+    sealed = 0;
+}
+
+int mbed_alloc_sealed(void) {
+    return sealed;
+}
+
+__weak void mbed_alloc_sealed_hook(void *caller, size_t size) {
+    error("Heap allocation of %u bytes from %p after the heap was sealed\r\n", (unsigned)size, caller);
+}
+
+} // extern "C"
+
+#if YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE
+
+/* The replacements allocate with malloc() and free with free(), as the
+ * library versions do, so memory can be freed by either. */
+static void *trace_alloc(void *caller, std::size_t size, bool nothrow) {
+    mbed_alloc_trace_record(caller, size);
+    void *p = malloc(size ? size : 1);
+    if (p == NULL && !nothrow) {
+        error("Out of memory in operator new\r\n");
+    }
+    return p;
+}
+
+void *operator new(std::size_t size) {
+    return trace_alloc(MBED_ALLOC_CALLER, size, false);
+}
+
+void *operator new[](std::size_t size) {
+    return trace_alloc(MBED_ALLOC_CALLER, size, false);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) throw() {
+    return trace_alloc(MBED_ALLOC_CALLER, size, true);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) throw() {
+    return trace_alloc(MBED_ALLOC_CALLER, size, true);
+}
+
+void operator delete(void *p) throw() {
+    free(p);
+}
+
+void operator delete[](void *p) throw() {
+    free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) throw() {
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) throw() {
+    free(p);
+}
+
+#endif
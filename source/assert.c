@@ -31,3 +31,28 @@ void mbed_assert_internal(const char *expr, const char *file, int line)
 #endif
     mbed_die();
 }
+
+void mbed_assert_id(uint32_t file_id, int line)
+{
+#if DEVICE_STDIO_MESSAGES
+    /* Formatted by hand, so that assertions do not pull in printf */
+    static const char hex[] = "0123456789abcdef";
+    char msg[] = "mbed assertation failed: id 00000000:00000000\n";
+    char *p = msg + sizeof(msg) - 2;
+    uint32_t value = (uint32_t)line;
+    for (int i = 0; i < 8; i++) {
+        *--p = hex[value & 0xf];
+        value >>= 4;
+    }
+    p--;
+    for (int i = 0; i < 8; i++) {
+        *--p = hex[file_id & 0xf];
+        file_id >>= 4;
+    }
+    fputs(msg, stderr);
+#else
+    (void)file_id;
+    (void)line;
+#endif
+    mbed_die();
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "compiler-polyfill/attributes.h"
+#include "us_ticker_api.h"
+#include "cmsis.h"
+
+#if defined(TARGET_LIKE_CORTEX_M3) || defined(TARGET_LIKE_CORTEX_M4) || defined(TARGET_LIKE_CORTEX_M7)
+#define CRITICAL_PROFILE_DWT 1
+#else
+#define CRITICAL_PROFILE_DWT 0
+#endif
+
+static mbed_critical_site_t *sites = NULL;
+
+__weak uint32_t mbed_critical_profile_clock(void) {
+#if CRITICAL_PROFILE_DWT
+    return DWT->CYCCNT;
+#else
+    return us_ticker_read();
+#endif
+}
+
+void mbed_critical_profile_start(void) {
+#if CRITICAL_PROFILE_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (mbed_critical_site_t *s = sites; s != NULL; s = s->next) {
+        s->count = 0;
+        s->max = 0;
+        s->max_caller = NULL;
+        memset(s->histogram, 0, sizeof(s->histogram));
+    }
+    __set_PRIMASK(primask);
+}
+
+void mbed_critical_profile_record(mbed_critical_site_t *site, uint32_t start, void *caller) {
+    uint32_t ticks = mbed_critical_profile_clock() - start;
+    site->count++;
+    if (!site->listed) {
+        // Sites are only ever added, at the head
+        site->listed = 1;
+        site->next = sites;
+        sites = site;
+    }
+    if (ticks >= site->max) {
+        site->max = ticks;
+        site->max_caller = caller;
+    }
+    unsigned bin = 0;
+    for (uint32_t t = ticks >> 1; t && bin < YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE_BINS - 1; t >>= 1) {
+        bin++;
+    }
+    site->histogram[bin]++;
+}
+
+mbed_critical_site_t *mbed_critical_profile_sites(void) {
+    return sites;
+}
+
+/* Order sites by their longest duration, then by address so that the order is total */
+static int site_before(const mbed_critical_site_t *a, const mbed_critical_site_t *b) {
+    return a->max > b->max || (a->max == b->max && (uintptr_t)a > (uintptr_t)b);
+}
+
+void mbed_critical_profile_report(void) {
+    /* Print the first site in order after the last one printed, until all
+     * have been. This is quadratic, but needs no memory and there are few sites. */
+    const mbed_critical_site_t *last = NULL;
+    printf("critical sections: count, max ticks, max caller, histogram by powers of two\r\n");
+    for (;;) {
+        const mbed_critical_site_t *next = NULL;
+        for (const mbed_critical_site_t *s = sites; s != NULL; s = s->next) {
+            if ((last == NULL || site_before(last, s)) && (next == NULL || site_before(s, next))) {
+                next = s;
+            }
+        }
+        if (next == NULL) {
+            break;
+        }
+        printf("%s:%d %lu %lu %p", next->file, next->line, (unsigned long)next->count,
+               (unsigned long)next->max, next->max_caller);
+        for (unsigned i = 0; i < YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE_BINS; i++) {
+            printf(" %lu", (unsigned long)next->histogram[i]);
+        }
+        printf("\r\n");
+        last = next;
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "mbed-drivers/driver_trace.h"
+#include "us_ticker_api.h"
+#include "cmsis.h"
+
+#define TRACE_SIZE YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE_SIZE
+#define TRACE_MASK (TRACE_SIZE - 1)
+
+#if TRACE_SIZE & TRACE_MASK
+#error YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE_SIZE must be a power of two
+#endif
+
+static mbed_driver_trace_record_t ring[TRACE_SIZE];
+/* The position of the next record to be written, which only ever increases */
+static volatile uint32_t head;
+/* The position of the next record to be drained; only the drain uses it */
+static uint32_t tail;
+
+static uint32_t reserve(void) {
+#if defined(TARGET_LIKE_CORTEX_M3) || defined(TARGET_LIKE_CORTEX_M4) || defined(TARGET_LIKE_CORTEX_M7)
+    uint32_t i;
+    do {
+        i = __LDREXW(&head);
+    } while (__STREXW(i + 1, &head));
+    return i;
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t i = head++;
+    __set_PRIMASK(primask);
+    return i;
+#endif
+}
+
+void mbed_driver_trace(uint8_t driver, uint8_t event, uint32_t arg) {
+    uint32_t i = reserve();
+    mbed_driver_trace_record_t *r = &ring[i & TRACE_MASK];
+    r->timestamp = us_ticker_read();
+    r->arg = arg;
+    r->driver = driver;
+    r->event = event;
+    __DMB();
+    r->sequence = (uint16_t)i;
+}
+
+size_t mbed_driver_trace_drain(mbed_driver_trace_record_t *records, size_t count, uint32_t *lost) {
+    uint32_t dropped = 0;
+    size_t n = 0;
+    while (n < count) {
+        uint32_t h = head;
+        if (h - tail > TRACE_SIZE) {
+            dropped += h - tail - TRACE_SIZE;
+            tail = h - TRACE_SIZE;
+        }
+        if (tail == h) {
+            break;
+        }
+        mbed_driver_trace_record_t r = ring[tail & TRACE_MASK];
+        __DMB();
+        if (head - tail > TRACE_SIZE) {
+            // The record was overwritten while it was copied, so start again from the oldest one left
+            continue;
+        }
+        if (r.sequence != (uint16_t)tail) {
+            // The record is still being written
+            break;
+        }
+        records[n++] = r;
+        tail++;
+    }
+    if (lost) {
+        *lost = dropped;
+    }
+    return n;
+}
+
+void mbed_driver_trace_dump(void) {
+    mbed_driver_trace_record_t records[16];
+    // Stop after a ring's worth, in case events are recorded as fast as they are printed
+    for (unsigned rounds = 0; rounds <= TRACE_SIZE / 16; rounds++) {
+        uint32_t lost;
+        size_t n = mbed_driver_trace_drain(records, sizeof(records) / sizeof(records[0]), &lost);
+        if (!n && !lost) {
+            break;
+        }
+        if (lost) {
+            printf("trace-lost:%08lx\r\n", (unsigned long)lost);
+        }
+        for (size_t i = 0; i < n; i++) {
+            printf("trace:%08lx:%02x:%02x:%08lx\r\n", (unsigned long)records[i].timestamp, records[i].driver,
+                   records[i].event, (unsigned long)records[i].arg);
+        }
+    }
+}
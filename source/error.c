@@ -24,7 +24,15 @@
 #endif
 
 __weak void error(const char* format, ...) {
-#if DEVICE_STDIO_MESSAGES
+#if DEVICE_STDIO_MESSAGES && defined(YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL) && YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL < 2
+    /* Below the full assertion level, print the message unformatted (or not
+     * at all, at level 0) so that errors do not pull in printf */
+#if YOTTA_CFG_MBED_DRIVERS_ASSERT_LEVEL == 1
+    fputs(format, stderr);
+#else
+    (void)format;
+#endif
+#elif DEVICE_STDIO_MESSAGES
     va_list arg;
     va_start(arg, format);
     vfprintf(stderr, format, arg);
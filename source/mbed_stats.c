@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "mbed-drivers/mbed_stats.h"
+#include "us_ticker_api.h"
+#include "cmsis.h"
+
+#if defined(TARGET_LIKE_CORTEX_M3) || defined(TARGET_LIKE_CORTEX_M4) || defined(TARGET_LIKE_CORTEX_M7)
+#define STATS_EXCLUSIVE 1
+#else
+#define STATS_EXCLUSIVE 0
+#endif
+
+static mbed_stats_t *groups = NULL;
+
+static const char *const counter_names[MBED_STATS_COUNTERS] = {
+    "transfers",
+    "bytes",
+    "errors",
+    "queue_high_water",
+    "completions",
+    "latency_total_us",
+};
+
+static void enlist(mbed_stats_t *stats) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!stats->listed) {
+        // Groups are only ever added, at the head
+        stats->listed = 1;
+        stats->next = groups;
+        groups = stats;
+    }
+    __set_PRIMASK(primask);
+}
+
+void mbed_stats_init(mbed_stats_t *stats, const char *name) {
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+}
+
+void mbed_stats_add(mbed_stats_t *stats, unsigned counter, uint32_t n) {
+    volatile uint32_t *c = &stats->counters[counter];
+#if STATS_EXCLUSIVE
+    uint32_t v;
+    do {
+        v = __LDREXW(c);
+    } while (__STREXW(v + n, c));
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *c += n;
+    __set_PRIMASK(primask);
+#endif
+    if (!stats->listed) {
+        enlist(stats);
+    }
+}
+
+void mbed_stats_max(mbed_stats_t *stats, unsigned counter, uint32_t value) {
+    volatile uint32_t *c = &stats->counters[counter];
+#if STATS_EXCLUSIVE
+    uint32_t v;
+    do {
+        v = __LDREXW(c);
+        if (v >= value) {
+            __CLREX();
+            break;
+        }
+    } while (__STREXW(value, c));
+#else
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (*c < value) {
+        *c = value;
+    }
+    __set_PRIMASK(primask);
+#endif
+    if (!stats->listed) {
+        enlist(stats);
+    }
+}
+
+uint32_t mbed_stats_clock(void) {
+    return us_ticker_read();
+}
+
+void mbed_stats_complete(mbed_stats_t *stats, uint32_t start) {
+    mbed_stats_add(stats, MBED_STATS_LATENCY_US, mbed_stats_clock() - start);
+    mbed_stats_add(stats, MBED_STATS_COMPLETIONS, 1);
+}
+
+mbed_stats_t *mbed_stats_find(const char *name) {
+    for (mbed_stats_t *s = groups; s != NULL; s = s->next) {
+        if (strcmp(s->name, name) == 0) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+mbed_stats_t *mbed_stats_groups(void) {
+    return groups;
+}
+
+int mbed_stats_format(const mbed_stats_t *stats, char *buffer, size_t size) {
+    uint32_t counters[MBED_STATS_COUNTERS];
+    int length = 0;
+    for (unsigned i = 0; i < MBED_STATS_COUNTERS; i++) {
+        counters[i] = stats->counters[i];
+    }
+    for (unsigned i = 0; i <= MBED_STATS_COUNTERS; i++) {
+        size_t left = (size_t)length < size ? size - length : 0;
+        int n;
+        if (i < MBED_STATS_COUNTERS) {
+            n = snprintf(buffer + size - left, left, "%s %lu\n", counter_names[i], (unsigned long)counters[i]);
+        } else {
+            uint32_t completions = counters[MBED_STATS_COMPLETIONS];
+            n = snprintf(buffer + size - left, left, "latency_avg_us %lu\n",
+                         (unsigned long)(completions ? counters[MBED_STATS_LATENCY_US] / completions : 0));
+        }
+        if (n < 0) {
+            return n;
+        }
+        length += n;
+    }
+    return length;
+}
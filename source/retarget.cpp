@@ -18,13 +18,18 @@
 #include "mbed-drivers/FileHandle.h"
 #include "mbed-drivers/FileSystemLike.h"
 #include "mbed-drivers/FilePath.h"
+#include "mbed-drivers/Poller.h"
+#include "mbed-drivers/Timeout.h"
 #include "serial_api.h"
 #include "compiler-polyfill/attributes.h"
 #include "cmsis.h"
+#include "mbed-drivers/mbed_alloc_trace.h"
 #include <errno.h>
+#include <new>
 #include "minar/minar.h"
 #include "mbed-hal/init_api.h"
 #include "mbed-hal/serial_api.h"
+#include "mbed-hal/sleep_api.h"
 #include "core_generic.h"
 
 #if defined(__ARMCC_VERSION)
@@ -66,6 +71,24 @@
 
 #define STDIO_DEFAULT_BAUD YOTTA_CFG_MBED_OS_STDIO_DEFAULT_BAUD
 
+/* Size of the interrupt-fed stdin buffer; 0 reads stdin directly from the
+ * UART, one character at a time */
+#ifndef YOTTA_CFG_MBED_OS_STDIO_RX_BUFFER_SIZE
+#define YOTTA_CFG_MBED_OS_STDIO_RX_BUFFER_SIZE 128
+#endif
+
+/* Echo input and handle backspace, making complete lines available to
+ * stdin only once return is pressed */
+#ifndef YOTTA_CFG_MBED_OS_STDIO_LINE_EDITING
+#define YOTTA_CFG_MBED_OS_STDIO_LINE_EDITING 0
+#endif
+
+#define STDIO_RX_BUFFER_SIZE YOTTA_CFG_MBED_OS_STDIO_RX_BUFFER_SIZE
+
+#if STDIO_RX_BUFFER_SIZE & (STDIO_RX_BUFFER_SIZE - 1)
+#error "YOTTA_CFG_MBED_OS_STDIO_RX_BUFFER_SIZE must be a power of 2"
+#endif
+
 
 using namespace mbed;
 #ifdef YOTTA_CFG_DEBUG_OPTIONS_COVERAGE
@@ -76,6 +99,10 @@ using namespace mbed;
 #include "mbed-drivers/test_env.h"
 #endif
 
+#ifndef YOTTA_CFG_DEBUG_OPTIONS_COVERAGE_ZERO_RUNS
+#define YOTTA_CFG_DEBUG_OPTIONS_COVERAGE_ZERO_RUNS 0
+#endif
+
 bool coverage_report = false;
 const int gcov_fd = 'g' + ((int)'c' << 8);
 
@@ -128,10 +155,187 @@ FileHandle::~FileHandle() {
     }
 }
 
+const void *FileHandle::mmap(off_t offset, size_t length) {
+    /* remember our current position */
+    off_t pos = lseek(0, SEEK_CUR);
+    if (pos == -1 || offset < 0 || length == 0) return NULL;
+    if (lseek(offset, SEEK_SET) != offset) {
+        lseek(pos, SEEK_SET);
+        return NULL;
+    }
+
+    char *window = new (std::nothrow) char[length];
+    size_t done = 0;
+    while (window != NULL && done < length) {
+        ssize_t n = read(window + done, length - done);
+        if (n <= 0) {
+            /* the region runs past the end of the file */
+            delete[] window;
+            window = NULL;
+        } else {
+            done += n;
+        }
+    }
+    lseek(pos, SEEK_SET);
+    return window;
+}
+
+int FileHandle::munmap(const void *addr, size_t length) {
+    (void) length;
+    delete[] (const char *)addr;
+    return 0;
+}
+
+int FileHandle::read_async(void *buffer, size_t length, const io_callback_t &callback) {
+    ssize_t n = read(buffer, length);
+    minar::Scheduler::postCallback(io_callback_t(callback).bind(Buffer(buffer, length), n));
+    return 0;
+}
+
+int FileHandle::write_async(const void *buffer, size_t length, const io_callback_t &callback) {
+    ssize_t n = write(buffer, length);
+    minar::Scheduler::postCallback(io_callback_t(callback).bind(Buffer(const_cast<void *>(buffer), length), n));
+    return 0;
+}
+
 #if DEVICE_SERIAL
 
 #include "mbed-drivers/Serial.h"
 
+#if STDIO_RX_BUFFER_SIZE
+/* The stdio filehandles, reading from a buffer filled by the receive
+ * interrupt of the stdio serial port, so bursts of input are not lost and
+ * a read returns everything received so far.
+ */
+class StdioHandle : public FileHandle {
+public:
+    StdioHandle() : _serial(NULL), _head(0), _line(0), _tail(0) {
+    }
+
+    void attach(Serial *serial) {
+        _serial = serial;
+        _serial->attach(this, &StdioHandle::rx_irq, SerialBase::RxIrq);
+    }
+
+    virtual ssize_t write(const void* buffer, size_t length) {
+        return static_cast<FileHandle *>(_serial)->write(buffer, length);
+    }
+
+    virtual ssize_t read(void* buffer, size_t length) {
+        /* wait for at least one character (or line) */
+        while (_line == _tail) {
+            __disable_irq();
+            if (_line == _tail) {
+                sleep();
+            }
+            __enable_irq();
+        }
+        uint32_t n = _line - _tail;
+        if (n > length) {
+            n = length;
+        }
+        char *ptr = (char *)buffer;
+        for (uint32_t i = 0; i < n; i++) {
+            ptr[i] = _buf[(_tail + i) & (STDIO_RX_BUFFER_SIZE - 1)];
+        }
+        _tail += n;
+        return n;
+    }
+
+    virtual int close() {
+        return 0;
+    }
+
+    virtual int isatty() {
+        return 1;
+    }
+
+    virtual off_t lseek(off_t offset, int whence) {
+        (void) offset, (void) whence;
+        return -1;
+    }
+
+    virtual int fsync() {
+        return 0;
+    }
+
+    virtual short poll(short events) {
+        short revents = _serial->poll(events & POLLOUT);
+        if ((events & POLLIN) && _line != _tail) {
+            revents |= POLLIN;
+        }
+        return revents;
+    }
+
+    virtual mbed::util::FunctionPointer sigio(const mbed::util::FunctionPointer &func) {
+        mbed::util::FunctionPointer last = _sigio;
+        _sigio = func;
+        return last;
+    }
+
+protected:
+    void echo(const char *s, size_t length) {
+#if YOTTA_CFG_MBED_OS_STDIO_LINE_EDITING
+        static_cast<FileHandle *>(_serial)->write(s, length);
+#else
+        (void) s, (void) length;
+#endif
+    }
+
+    void rx_irq() {
+        uint32_t line = _line;
+        while (_serial->readable()) {
+            char c;
+            static_cast<FileHandle *>(_serial)->read(&c, 1);
+#if YOTTA_CFG_MBED_OS_STDIO_LINE_EDITING
+            if (c == '\b' || c == 0x7f) {
+                if (_head != _line) {
+                    _head--;
+                    echo("\b \b", 3);
+                }
+                continue;
+            }
+            if (c == '\r') {
+                c = '\n';
+            }
+#endif
+            if (_head - _tail == STDIO_RX_BUFFER_SIZE) {
+                /* full: drop the character */
+                continue;
+            }
+            _buf[_head++ & (STDIO_RX_BUFFER_SIZE - 1)] = c;
+            if (c == '\n') {
+                echo("\r\n", 2);
+            } else {
+                echo(&c, 1);
+            }
+            /* a full buffer ends the line, so the reader can drain it */
+            if (!YOTTA_CFG_MBED_OS_STDIO_LINE_EDITING || c == '\n' || _head - _tail == STDIO_RX_BUFFER_SIZE) {
+                _line = _head;
+            }
+        }
+        if (_line != line && _sigio) {
+            _sigio.call();
+        }
+    }
+
+    Serial *_serial;
+    mbed::util::FunctionPointer _sigio;
+    char _buf[STDIO_RX_BUFFER_SIZE];
+    /* Free-running indices: [_tail, _line) is ready to read, [_line, _head)
+     * is the line still being edited */
+    volatile uint32_t _head;
+    volatile uint32_t _line;
+    volatile uint32_t _tail;
+};
+
+/* Constructed on first use, as get_stdio_serial() may be called from
+ * another file's static initializers before this file's have run */
+static StdioHandle &get_stdio_handle() {
+    static StdioHandle stdio_handle;
+    return stdio_handle;
+}
+#endif
 
 namespace mbed {
 
@@ -141,6 +345,9 @@ Serial& get_stdio_serial()
     static Serial stdio_serial(STDIO_UART_TX, STDIO_UART_RX);
     if (!stdio_uart_inited) {
         stdio_serial.baud(STDIO_DEFAULT_BAUD);
+#if STDIO_RX_BUFFER_SIZE
+        get_stdio_handle().attach(&stdio_serial);
+#endif
         stdio_uart_inited = true;
     }
     return stdio_serial;
@@ -149,6 +356,62 @@ Serial& get_stdio_serial()
 } // namespace mbed
 #endif
 
+/* Write straight to the stdio serial port, bypassing the stdio buffering of
+ * the Serial stream */
+static void stdio_write(const void *buffer, size_t length) {
+#if DEVICE_SERIAL
+    static_cast<FileHandle &>(get_stdio_serial()).write(buffer, length);
+#else
+    (void) buffer, (void) length;
+#endif
+}
+
+#ifdef YOTTA_CFG_DEBUG_OPTIONS_COVERAGE
+/* Encode the coverage stream as hex, in blocks written directly to the
+ * serial port. Greentea replaces '.' with "00"; with zero runs enabled,
+ * "zNN" stands for NN (hex) zero bytes and the stream must be passed through
+ * scripts/coverage_decode.py first.
+ */
+static void coverage_write(const unsigned char *buffer, unsigned int length) {
+    static const char hex[] = "0123456789abcdef";
+    char block[64];
+    unsigned int n = 0;
+
+    /* keep the stream in order with anything already printed */
+    fflush(stdout);
+    unsigned int i = 0;
+    while (i < length) {
+        if (n > sizeof(block) - 3) {
+            stdio_write(block, n);
+            n = 0;
+        }
+        unsigned char b = buffer[i];
+        if (b == 0x00) {
+#if YOTTA_CFG_DEBUG_OPTIONS_COVERAGE_ZERO_RUNS
+            unsigned int run = 1;
+            while (i + run < length && run < 0xff && buffer[i + run] == 0x00) {
+                run++;
+            }
+            if (run > 3) {
+                block[n++] = 'z';
+                block[n++] = hex[run >> 4];
+                block[n++] = hex[run & 0xf];
+                i += run;
+                continue;
+            }
+#endif
+            // About 30-35% of coverage stream are bytes with value 0x00
+            block[n++] = '.';
+        } else {
+            block[n++] = hex[b >> 4];
+            block[n++] = hex[b & 0xf];
+        }
+        i++;
+    }
+    stdio_write(block, n);
+}
+#endif
+
 static void init_serial() {
 #if DEVICE_SERIAL
     get_stdio_serial();
@@ -281,25 +544,12 @@ extern "C" int PREFIX(_write)(FILEHANDLE fh, const unsigned char *buffer, unsign
     (void) mode;
     int n; // n is the number of bytes written
     if (fh < 3) {
-#if DEVICE_SERIAL
-        for (unsigned int i = 0; i < length; i++) {
-            get_stdio_serial().putc(buffer[i]);
-        }
-#endif
+        stdio_write(buffer, length);
         n = length;
     }
 #ifdef YOTTA_CFG_DEBUG_OPTIONS_COVERAGE
     else if(coverage_report && fh == gcov_fd) {
-        for (unsigned int i = 0; i < length; i++) {
-            if (0x00 == buffer[i]) {
-                // Very simple coverage stream compression
-                // Observation: About 30-35% of coverage stream are bytes with value 0x00
-                // Greentea will pick up '.' and replace with "00"
-                printf(".");
-            } else {
-                printf("%02x", buffer[i]);
-            }
-        }
+        coverage_write(buffer, length);
         n = length;
     }
 #endif
@@ -329,11 +579,16 @@ extern "C" int PREFIX(_read)(FILEHANDLE fh, unsigned char *buffer, unsigned int
     }
 #endif
     if (fh < 3) {
+#if DEVICE_SERIAL && STDIO_RX_BUFFER_SIZE
+        get_stdio_serial();
+        n = get_stdio_handle().read(buffer, length);
+#else
         // only read a character at a time from stdin
 #if DEVICE_SERIAL
         *buffer = get_stdio_serial().getc();
 #endif
         n = 1;
+#endif
     } else {
         FileHandle* fhc = filehandles[fh-3];
         if (fhc == NULL) return -1;
@@ -505,6 +760,124 @@ extern "C" int mkdir(const char *path, mode_t mode) {
     return fs->mkdir(fp.fileName(), mode);
 }
 
+static FileHandle *get_filehandle(int fd) {
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fd < 3) {
+#if DEVICE_SERIAL && STDIO_RX_BUFFER_SIZE
+        get_stdio_serial();
+        return &get_stdio_handle();
+#elif DEVICE_SERIAL
+        return &get_stdio_serial();
+#else
+        return NULL;
+#endif
+    }
+    if (fd - 3 >= (int)(sizeof(filehandles)/sizeof(*filehandles))) {
+        return NULL;
+    }
+    return filehandles[fd-3];
+}
+
+static volatile bool poll_woken;
+static volatile bool poll_expired;
+
+static void poll_wake() {
+    poll_woken = true;
+}
+
+static void poll_timeout() {
+    poll_expired = true;
+    poll_woken = true;
+}
+
+/* The callbacks poll() displaces while it waits, such as a Poller's, by descriptor */
+static mbed::util::FunctionPointer poll_saved[3 + YOTTA_CFG_MBED_MAX_FILEHANDLES];
+
+/* The handle for fds[i], or NULL if there is none or an earlier entry has the
+ * same one, as the standard streams do, so each callback is swapped once */
+static FileHandle *poll_handle(struct pollfd fds[], nfds_t i) {
+    FileHandle *fhc = get_filehandle(fds[i].fd);
+    for (nfds_t j = 0; fhc != NULL && j < i; j++) {
+        if (get_filehandle(fds[j].fd) == fhc) {
+            return NULL;
+        }
+    }
+    return fhc;
+}
+
+static void poll_sigio(struct pollfd fds[], nfds_t nfds) {
+    for (nfds_t i = 0; i < nfds; i++) {
+        FileHandle *fhc = poll_handle(fds, i);
+        if (fhc != NULL) {
+            poll_saved[fds[i].fd] = fhc->sigio(mbed::util::FunctionPointer(poll_wake));
+        }
+    }
+}
+
+static void poll_restore(struct pollfd fds[], nfds_t nfds) {
+    for (nfds_t i = 0; i < nfds; i++) {
+        FileHandle *fhc = poll_handle(fds, i);
+        if (fhc != NULL) {
+            mbed::util::FunctionPointer &saved = poll_saved[fds[i].fd];
+            fhc->sigio(saved);
+            /* Notifications that came while poll() waited were not passed on */
+            if (saved) {
+                saved.call();
+            }
+            saved = mbed::util::FunctionPointer();
+        }
+    }
+}
+
+extern "C" int poll(struct pollfd fds[], nfds_t nfds, int timeout) {
+    Timeout timer;
+    poll_expired = false;
+    if (timeout > 0) {
+        timer.attach_us(poll_timeout, (timestamp_t)timeout * 1000);
+    }
+    if (timeout != 0) {
+        poll_sigio(fds, nfds);
+    }
+
+    int count;
+    while (true) {
+        poll_woken = false;
+        count = 0;
+        for (nfds_t i = 0; i < nfds; i++) {
+            fds[i].revents = 0;
+            if (fds[i].fd < 0) {
+                continue;
+            }
+            FileHandle *fhc = get_filehandle(fds[i].fd);
+            if (fhc == NULL) {
+                fds[i].revents = POLLNVAL;
+            } else {
+                fds[i].revents = fhc->poll(fds[i].events);
+            }
+            if (fds[i].revents) {
+                count++;
+            }
+        }
+        if (count || timeout == 0 || poll_expired) {
+            break;
+        }
+        /* A pending interrupt still wakes the core with interrupts masked,
+         * so a notification between the check and the sleep is not lost. */
+        __disable_irq();
+        if (!poll_woken) {
+            sleep();
+        }
+        __enable_irq();
+    }
+
+    if (timeout != 0) {
+        poll_restore(fds, nfds);
+    }
+    return count;
+}
+
 #if defined(TOOLCHAIN_GCC) || defined(TARGET_LIKE_CLANG)
 /* prevents the exception handling name demangling code getting pulled in */
 #include "mbed-drivers/mbed_error.h"
@@ -552,9 +925,18 @@ extern "C" void __iar_argc_argv() {
 
 // the user should set up their application in app_start
 extern void app_start(int, char**);
+
+static void start_app(int argc, char **argv) {
+    app_start(argc, argv);
+#if YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE && YOTTA_CFG_MBED_DRIVERS_ALLOC_SEAL
+    // Initialization is over, so from here on the heap may not be used
+    mbed_alloc_seal();
+#endif
+}
+
 extern "C" int main(void) {
     minar::Scheduler::postCallback(
-        mbed::util::FunctionPointer2<void, int, char**>(&app_start).bind(0, NULL)
+        mbed::util::FunctionPointer2<void, int, char**>(&start_app).bind(0, NULL)
     );
     return minar::Scheduler::start();
 }
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2006-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "rtc_api.h"
+
+#include <time.h>
+#include "mbed-drivers/rtc_time.h"
+#include "mbed-drivers/TimerEvent.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "us_ticker_api.h"
+
+#if defined(TOOLCHAIN_GCC)
+#include <sys/time.h>
+#endif
+
+/* How often, in seconds, the software clock is checked against the RTC. This
+ * also extends the 32-bit us_ticker, so it must be less than its wrap period
+ * of about 71 minutes. */
+#ifndef YOTTA_CFG_MBED_DRIVERS_SOFT_RTC_SYNC_INTERVAL
+#define YOTTA_CFG_MBED_DRIVERS_SOFT_RTC_SYNC_INTERVAL 600
+#endif
+
+#if YOTTA_CFG_MBED_DRIVERS_SOFT_RTC_SYNC_INTERVAL >= 4294
+#error "YOTTA_CFG_MBED_DRIVERS_SOFT_RTC_SYNC_INTERVAL must be less than the us_ticker wrap period"
+#endif
+
+#define SOFT_RTC_SYNC_INTERVAL_US ((timestamp_t)YOTTA_CFG_MBED_DRIVERS_SOFT_RTC_SYNC_INTERVAL * 1000000)
+
+namespace {
+
+/* A wall clock kept by the us_ticker. It is read from the RTC on first use,
+ * then only checked against it every sync interval, so reading the time
+ * does not touch the RTC.
+ */
+class SoftRTC : public mbed::TimerEvent {
+public:
+    SoftRTC() : _started(false), _last(0), _high(0), _sec(0), _next(0) {
+    }
+
+    time_t read(uint32_t *usec) {
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        if (!_started) {
+            time_t t = 0;
+#if DEVICE_RTC
+            if (!(rtc_isenabled())) {
+                rtc_init();
+                rtc_write(0);
+            }
+            t = rtc_read();
+#endif
+            start(t);
+        }
+        uint64_t now = ticks();
+        advance(now);
+        if (usec != NULL) {
+            *usec = 1000000 - (uint32_t)(_next - now);
+        }
+        return _sec;
+    }
+
+    void write(time_t t) {
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+#if DEVICE_RTC
+        rtc_init();
+        rtc_write(t);
+#endif
+        if (_started) {
+            set(t, ticks());
+        } else {
+            start(t);
+        }
+    }
+
+protected:
+    virtual void handler() {
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        uint64_t now = ticks();
+        advance(now);
+#if DEVICE_RTC
+        /* The software clock runs up to a second behind the RTC, since the
+         * phase of the RTC second is unknown; only correct larger errors,
+         * keeping the sub-second phase */
+        time_t diff = rtc_read() - _sec;
+        if (diff >= 2 || diff <= -1) {
+            _sec += diff;
+        }
+#endif
+        insert(event.timestamp + SOFT_RTC_SYNC_INTERVAL_US);
+    }
+
+    void start(time_t t) {
+        _started = true;
+        set(t, ticks());
+        insert(us_ticker_read() + SOFT_RTC_SYNC_INTERVAL_US);
+    }
+
+    void set(time_t t, uint64_t now) {
+        _sec = t;
+        _next = now + 1000000;
+    }
+
+    /* Move _sec on to the second containing now */
+    void advance(uint64_t now) {
+        if (now >= _next) {
+            /* the handler runs every sync interval, so this fits in 32 bits */
+            uint32_t n = (uint32_t)(now - _next) / 1000000 + 1;
+            _sec += n;
+            _next += (uint64_t)n * 1000000;
+        }
+    }
+
+    /* The us_ticker extended to 64 bits */
+    uint64_t ticks() {
+        uint32_t t = us_ticker_read();
+        if (t < _last) {
+            _high += (uint64_t)1 << 32;
+        }
+        _last = t;
+        return _high | t;
+    }
+
+    bool _started;
+    uint32_t _last;
+    uint64_t _high;
+    time_t _sec;        /**< The current second */
+    uint64_t _next;     /**< The tick at which the next second starts */
+};
+
+/* Constructed on first use, so time() works during static initialisation */
+SoftRTC &soft_rtc() {
+    static SoftRTC rtc;
+    return rtc;
+}
+
+} // namespace
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if defined (__ICCARM__)
+time_t __time32(time_t *timer)
+#else
+time_t time(time_t *timer)
+#endif
+
+{
+    time_t t = soft_rtc().read(NULL);
+
+    if (timer != NULL) {
+        *timer = t;
+    }
+    return t;
+}
+
+void set_time(time_t t) {
+    soft_rtc().write(t);
+}
+
+uint64_t time_us(void) {
+    uint32_t usec;
+    time_t t = soft_rtc().read(&usec);
+    return (uint64_t)t * 1000000 + usec;
+}
+
+#if defined(TOOLCHAIN_GCC)
+int _gettimeofday(struct timeval *tv, void *tz) {
+    (void) tz;
+    uint32_t usec;
+    tv->tv_sec = soft_rtc().read(&usec);
+    tv->tv_usec = usec;
+    return 0;
+}
+#endif
+
+clock_t clock() {
+    clock_t t = us_ticker_read();
+    t /= 1000000 / CLOCKS_PER_SEC; // convert to processor time
+    return t;
+}
+
+#ifdef __cplusplus
+}
+#endif
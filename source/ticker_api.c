@@ -17,6 +17,15 @@
 #include <stddef.h>
 #include "ticker_api.h"
 #include "cmsis.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "mbed-drivers/driver_trace.h"
+#include "mbed-drivers/mbed_stats.h"
+
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+static mbed_stats_t ticker_stats = MBED_STATS_INIT("ticker");
+/* Events pending across all the ticker queues, changed with interrupts disabled */
+static uint32_t pending;
+#endif
 
 void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler handler) {
     data->interface->init();
@@ -40,6 +49,13 @@ void ticker_irq_handler(const ticker_data_t *const data) {
             //      point to the following one and execute its handler
             ticker_event_t *p = data->queue->head;
             data->queue->head = data->queue->head->next;
+            MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_TICKER, MBED_DRIVER_TRACE_FIRE, p->id);
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+            pending--;
+            mbed_stats_add(&ticker_stats, MBED_STATS_TRANSFERS, 1);
+            mbed_stats_add(&ticker_stats, MBED_STATS_COMPLETIONS, 1);
+            mbed_stats_add(&ticker_stats, MBED_STATS_LATENCY_US, data->interface->read() - p->timestamp);
+#endif
             if (data->queue->event_handler != NULL) {
                 (*data->queue->event_handler)(p->id); // NOTE: the handler can set new events
             }
@@ -57,6 +73,7 @@ void ticker_irq_handler(const ticker_data_t *const data) {
 void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, uint32_t id) {
     /* disable interrupts for the duration of the function */
     __disable_irq();
+    MBED_CRITICAL_PROFILE_ENTER();
 
     // initialise our data
     obj->timestamp = timestamp;
@@ -84,17 +101,25 @@ void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, t
     }
     /* if we're at the end p will be NULL, which is correct */
     obj->next = p;
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    mbed_stats_max(&ticker_stats, MBED_STATS_QUEUE_HIGH_WATER, ++pending);
+#endif
 
+    MBED_CRITICAL_PROFILE_EXIT();
     __enable_irq();
 }
 
 void ticker_remove_event(const ticker_data_t *const data, ticker_event_t *obj) {
     __disable_irq();
+    MBED_CRITICAL_PROFILE_ENTER();
 
     // remove this object from the list
     if (data->queue->head == obj) {
         // first in the list, so just drop me
         data->queue->head = obj->next;
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+        pending--;
+#endif
         if (data->queue->head == NULL) {
             data->interface->disable_interrupt();
         } else {
@@ -106,12 +131,16 @@ void ticker_remove_event(const ticker_data_t *const data, ticker_event_t *obj) {
         while (p != NULL) {
             if (p->next == obj) {
                 p->next = obj->next;
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+                pending--;
+#endif
                 break;
             }
             p = p->next;
         }
     }
 
+    MBED_CRITICAL_PROFILE_EXIT();
     __enable_irq();
 }
 
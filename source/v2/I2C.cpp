@@ -24,6 +24,7 @@
 #include "minar/minar.h"
 #include "ualloc/ualloc.h"
 #include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
 #include "PeripheralPins.h"
 #include "mbed-drivers/mbed_error.h"
 
@@ -44,6 +45,7 @@ I2CTransaction::I2CTransaction(uint16_t address, uint32_t hz, bool irqsafe, I2C
 I2CTransaction::~I2CTransaction()
 {
     mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
     _current = _root;
     while (_current) {
         detail::I2CSegment * next = _current->get_next();
@@ -91,6 +93,7 @@ detail::I2CSegment * I2CTransaction::new_segment()
     }
     s->set_next(nullptr);
     mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
     if (_root == nullptr) {
         _root = s;
         _current = s;
@@ -123,8 +126,74 @@ void I2CTransaction::process_event(uint32_t event)
     }
 }
 
+I2CScan::I2CScan() : _next(0), _last(0)
+{
+    reset(0, 0);
+}
+
+void I2CScan::reset(uint8_t first, uint8_t last)
+{
+    for (size_t i = 0; i < sizeof(_found)/sizeof(_found[0]); i++) {
+        _found[i] = 0;
+    }
+    _next = first;
+    _last = last;
+}
+
+bool I2CScan::present(uint8_t address) const
+{
+    address &= 0x7f;
+    return (_found[address / 32] >> (address % 32)) & 1;
+}
+
+size_t I2CScan::count() const
+{
+    size_t n = 0;
+    for (size_t i = 0; i < sizeof(_found)/sizeof(_found[0]); i++) {
+        for (uint32_t w = _found[i]; w; w &= w - 1) {
+            n++;
+        }
+    }
+    return n;
+}
+
+bool I2CScan::probed(I2CTransaction *t, uint32_t event)
+{
+    if ((event & I2C_EVENT_TRANSFER_COMPLETE) && !(event & (I2C_EVENT_ALL & ~I2C_EVENT_TRANSFER_COMPLETE))) {
+        _found[_next / 32] |= 1UL << (_next % 32);
+    }
+    if (_next >= _last) {
+        return false;
+    }
+    _next++;
+    // The HAL takes 8-bit addresses
+    t->address(_next << 1);
+    return true;
+}
+
 I2C::I2C(PinName sda, PinName scl) :
-    _hz(100000)
+    _hz(100000), _owner(nullptr), TransactionPool(nullptr), SegmentPool(nullptr)
+{
+    init(sda, scl);
+}
+
+I2C::I2C(PinName sda, PinName scl, mbed::util::PoolAllocator *TransactionPool, mbed::util::PoolAllocator *SegmentPool) :
+    _hz(100000), _owner(nullptr), TransactionPool(TransactionPool), SegmentPool(SegmentPool)
+{
+    init(sda, scl);
+}
+
+I2C::I2C(PinName sda, PinName scl, detail::I2CResourceManager &owner, mbed::util::PoolAllocator *TransactionPool,
+         mbed::util::PoolAllocator *SegmentPool) :
+    _hz(100000), _owner(&owner), TransactionPool(TransactionPool), SegmentPool(SegmentPool)
+{
+    if (I2CError::None != _owner->init(sda, scl)) {
+        _owner = nullptr;
+        error("I2C init failed with an error");
+    }
+}
+
+void I2C::init(PinName sda, PinName scl)
 {
     // Select the appropriate I2C Resource Manager
     uint32_t i2c_sda = pinmap_peripheral(sda, PinMap_I2C_SDA);
@@ -167,6 +236,26 @@ I2C::TransferAdder I2C::transfer_to_irqsafe(int address)
     return t;
 }
 
+I2CError I2C::scan(I2CScan &result, const event_callback_t &done, uint8_t first, uint8_t last)
+{
+    if (first > last || last > 0x7f) {
+        return I2CError::InvalidAddress;
+    }
+    result.reset(first, last);
+    // Zero-segment transactions need no segment pool
+    I2CTransaction * t = new_transaction(first << 1, _hz, TransactionPool != nullptr, this);
+    if (!t) {
+        return I2CError::NullTransaction;
+    }
+    t->set_done_irq_cb(I2CTransaction::DoneCallback(&result, &I2CScan::probed));
+    t->add_event(I2C_EVENT_ALL, done);
+    I2CError rc = post_transaction(t);
+    if (rc != I2CError::None) {
+        free(t);
+    }
+    return rc;
+}
+
 I2CError I2C::post_transaction(I2CTransaction *t)
 {
     if (!_owner) {
@@ -232,7 +321,7 @@ void I2C::free(I2CTransaction *t)
 }
 
 I2C::TransferAdder::TransferAdder(I2C *i2c, int address, uint32_t hz, bool irqsafe) :
-    _i2c(i2c), _posted(false), _irqsafe(irqsafe), _rc(I2CError::None)
+    _xact(nullptr), _i2c(i2c), _posted(false), _irqsafe(irqsafe), _rc(I2CError::None)
 {
     CORE_UTIL_ASSERT(!irqsafe || (irqsafe && i2c->TransactionPool && i2c->SegmentPool));
     if (irqsafe && (!i2c->TransactionPool || !i2c->SegmentPool)) {
@@ -258,7 +347,7 @@ I2CError I2C::TransferAdder::apply()
             _posted = true;
         }
     }
-    return I2CError::None;
+    return _rc;
 }
 
 I2C::TransferAdder & I2C::TransferAdder::on(uint32_t event, const event_callback_t & cb)
@@ -289,8 +378,8 @@ I2C::TransferAdder::~TransferAdder()
 {
     apply();
     // If the transaction has not been posted, the TransferAdder still owns it, so it must be freed.
-    if (!_posted) {
-        delete _xact;
+    if (!_posted && _xact) {
+        _i2c->free(_xact);
     }
 }
 
@@ -336,7 +425,7 @@ I2C::TransferAdder & I2C::TransferAdder::tx(const Buffer & buf)
 
 I2C::TransferAdder & I2C::TransferAdder::tx_ephemeral(void *buf, size_t len)
 {
-    if(len > mbed::drivers::v2::EphemeralBuffer::ephemeralSize) {
+    if(len > detail::I2CSegment::ephemeralSize) {
         _rc = I2CError::BufferSize;
     } else {
         detail::I2CSegment * s = new_segment(detail::I2CDirection::Transmit);
@@ -368,7 +457,7 @@ I2C::TransferAdder & I2C::TransferAdder::rx(const Buffer & buf)
 I2C::TransferAdder & I2C::TransferAdder::rx(size_t len)
 {
 
-    if(len > mbed::drivers::v2::EphemeralBuffer::ephemeralSize) {
+    if(len > detail::I2CSegment::ephemeralSize) {
         _rc = I2CError::BufferSize;
     } else {
         detail::I2CSegment * s = new_segment(detail::I2CDirection::Receive);
@@ -21,10 +21,16 @@
 
 #include "mbed-drivers/v2/I2C.hpp"
 #include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "mbed-drivers/driver_trace.h"
+#include "mbed-drivers/mbed_stats.h"
 #include "core-util/atomic_ops.h"
 #include "core-util/assert.h"
 #include "minar/minar.h"
 
+#include <cstdio>
+#include <cstring>
+
 namespace mbed {
 namespace drivers {
 namespace v2 {
@@ -43,12 +49,20 @@ I2CError I2CResourceManager::post_transaction(I2CTransaction *t)
 
     // This can't be lock free because of the need to call append() on _TransactionQueue.
     mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
     I2CTransaction * tx = _TransactionQueue;
+    MBED_STATS_ADD(&_stats, MBED_STATS_TRANSFERS, 1);
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    MBED_STATS_MAX(&_stats, MBED_STATS_QUEUE_HIGH_WATER, ++_stats_queued);
+#endif
 
     if (tx) {
         tx->append(t);
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_QUEUE, 0);
     } else {
         _TransactionQueue = t;
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_START, 0);
+        MBED_STATS_START(_stats_start);
         return start_transaction();
     }
     return I2CError::None;
@@ -70,12 +84,20 @@ void I2CResourceManager::process_event(uint32_t event)
     if (!event) {
         return;
     }
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_IRQ, event);
     // Fire the irqcallback for the segment
     t->call_irq_cb(event);
     {
         // This isn't done with atomics due to the side-effects.
         mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
 
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+        // Pings have no segments
+        if (detail::I2CSegment *s = t->get_current()) {
+            MBED_STATS_ADD(&_stats, MBED_STATS_BYTES, s->get_len());
+        }
+#endif
         // If there is another segment to process, advance the segment pointer
         // Record whether there was another segment
         bool TransactionDone = !t->advance_segment();
@@ -83,14 +105,32 @@ void I2CResourceManager::process_event(uint32_t event)
         // or there was a complete event and the next segment is nullptr
         if ((event & I2C_EVENT_ALL & ~I2C_EVENT_TRANSFER_COMPLETE) ||
                 ((event & I2C_EVENT_TRANSFER_COMPLETE) && TransactionDone)) {
+            MBED_STATS_COMPLETE(&_stats, _stats_start);
+            if (event & I2C_EVENT_ALL & ~I2C_EVENT_TRANSFER_COMPLETE) {
+                MBED_STATS_ADD(&_stats, MBED_STATS_ERRORS, 1);
+            }
+            // The transaction may ask to be run again straight away, without going through minar
+            if (t->call_done_irq_cb(event)) {
+                MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_START, 0);
+                MBED_STATS_ADD(&_stats, MBED_STATS_TRANSFERS, 1);
+                MBED_STATS_START(_stats_start);
+                start_transaction();
+                return;
+            }
             // fire the handler
+            MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_COMPLETE, event);
             minar::Scheduler::postCallback(
                 I2C_event_callback_t(this, &I2CResourceManager::handle_event).bind(t,event)
             );
             // Advance to the next transaction
             _TransactionQueue = t->get_next();
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+            _stats_queued--;
+#endif
             if (_TransactionQueue) {
                 // Initiate the next transaction
+                MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_START, 0);
+                MBED_STATS_START(_stats_start);
                 start_transaction();
             } else {
             }
@@ -102,16 +142,27 @@ void I2CResourceManager::process_event(uint32_t event)
 
 void I2CResourceManager::handle_event(I2CTransaction *t, uint32_t event)
 {
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_I2C_V2, MBED_DRIVER_TRACE_CALLBACK, event);
     t->process_event(event);
     // This happens after the callbacks have all been called
     t->get_issuer()->free(t);
 }
 
-I2CResourceManager::I2CResourceManager() : _TransactionQueue(nullptr) {}
+I2CResourceManager::I2CResourceManager() : _TransactionQueue(nullptr)
+{
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    // Only the hardware resource managers know their peripheral, so they rename the group after it
+    std::strcpy(_stats_name, "softi2c");
+    mbed_stats_init(&_stats, _stats_name);
+    _stats_start = 0;
+    _stats_queued = 0;
+#endif
+}
 
 I2CResourceManager::~I2CResourceManager()
 {
     mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
     while (_TransactionQueue) {
         I2CTransaction * tx = (_TransactionQueue);
         _TransactionQueue = tx->get_next();
@@ -129,7 +180,11 @@ public:
         _id(id),
         _references(0),
         _handler(handler)
-    {}
+    {
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+        std::snprintf(_stats_name, sizeof(_stats_name), "i2c%u", (unsigned)id);
+#endif
+    }
 
     virtual I2CError init(PinName sda, PinName scl)
     {
@@ -197,6 +252,7 @@ public:
             return I2CError::Busy; // transaction ongoing
         }
         mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
         I2CTransaction * t = _TransactionQueue;
         CORE_UTIL_ASSERT(t != nullptr);
         if (!t) {
@@ -0,0 +1,172 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+
+#include "mbed-drivers/v2/I2CPoller.hpp"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "core-util/assert.h"
+#include "ticker_api.h"
+#include <cstring>
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+I2CPoller::Entry::Entry(uint16_t address, const void *cmd, size_t cmd_len, size_t sample_len, uint32_t period) :
+    _next(nullptr), _address(address), _cmd(cmd), _cmd_len(cmd ? cmd_len : 0), _sample_len(sample_len),
+    _period(period ? period : 1), _on_sample(), _busy(false), _front(0), _sequence(0), _errors(0), _overruns(0)
+{
+    CORE_UTIL_ASSERT(sample_len && sample_len <= YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE);
+    if (_sample_len > YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE) {
+        _sample_len = YOTTA_CFG_MBED_DRIVERS_I2C_POLLER_SAMPLE_SIZE;
+    }
+}
+
+void I2CPoller::Entry::on_sample(const sample_callback_t &cb)
+{
+    _on_sample = cb;
+}
+
+uint32_t I2CPoller::Entry::sample(void *buf) const
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    std::memcpy(buf, _slots[_front], _sample_len);
+    return _sequence;
+}
+
+void I2CPoller::Entry::complete(I2CTransaction *t, uint32_t event)
+{
+    (void) t;
+    bool ok = (event & I2C_EVENT_TRANSFER_COMPLETE) &&
+        !(event & (I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK));
+    {
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        if (ok) {
+            // The back slot now holds the new sample
+            _front ^= 1;
+            _sequence++;
+        } else {
+            _errors++;
+        }
+        _busy = false;
+    }
+    if (ok && _on_sample) {
+        _on_sample(this);
+    }
+}
+
+I2CPoller::I2CPoller(I2C &i2c, uint32_t tick_us) :
+    _i2c(i2c), _tick_us(tick_us), _tick(0), _entries(nullptr), _running(false)
+{}
+
+I2CPoller::~I2CPoller()
+{
+    stop();
+}
+
+void I2CPoller::add(Entry &e)
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    for (Entry *p = _entries; p; p = p->_next) {
+        if (p == &e) {
+            return;
+        }
+    }
+    e._next = _entries;
+    _entries = &e;
+}
+
+void I2CPoller::remove(Entry &e)
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    for (Entry **p = &_entries; *p; p = &(*p)->_next) {
+        if (*p == &e) {
+            *p = e._next;
+            e._next = nullptr;
+            break;
+        }
+    }
+}
+
+void I2CPoller::start()
+{
+    if (!_running) {
+        _running = true;
+        _tick = 0;
+        insert(ticker_read(_ticker_data) + _tick_us);
+    }
+}
+
+void I2CPoller::stop()
+{
+    _running = false;
+    TimerEvent::remove();
+}
+
+void I2CPoller::handler()
+{
+    _tick++;
+    {
+        // Queue every poll that is due on this tick together, so they run back to back
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        for (Entry *e = _entries; e; e = e->_next) {
+            if (_tick % e->_period == 0) {
+                post(e);
+            }
+        }
+    }
+    if (_running) {
+        insert(event.timestamp + _tick_us);
+    }
+}
+
+void I2CPoller::post(Entry *e)
+{
+    if (e->_busy) {
+        e->_overruns++;
+        return;
+    }
+    I2C::TransferAdder adder = _i2c.transfer_to_irqsafe(e->_address);
+    // The command stays valid while the entry is polled, so it is not copied, and can be any length
+    if (e->_cmd_len) {
+        adder.tx(const_cast<void *>(e->_cmd), e->_cmd_len);
+    }
+    I2CError rc = adder
+        .rx(e->_slots[e->_front ^ 1], e->_sample_len)
+        .on(I2C_EVENT_ALL, I2C::event_callback_t(e, &Entry::complete))
+        .apply();
+    if (rc == I2CError::None) {
+        e->_busy = true;
+    } else {
+        e->_errors++;
+    }
+}
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_I2C && DEVICE_I2C_ASYNCH
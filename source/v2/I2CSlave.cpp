@@ -0,0 +1,265 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_I2CSLAVE && DEVICE_I2C_ASYNCH
+
+#include "mbed-drivers/v2/I2CSlave.hpp"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "core-util/assert.h"
+#include <cstring>
+#include <new>
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+namespace detail {
+
+HWI2CSlaveBus::HWI2CSlaveBus(PinName sda, PinName scl) : _i2c()
+{
+    i2c_init(&_i2c, sda, scl);
+    i2c_slave_mode(&_i2c, 1);
+}
+
+void HWI2CSlaveBus::address(uint8_t address)
+{
+    // The HAL takes the address in 8-bit form
+    i2c_slave_address(&_i2c, 0, (uint32_t)address << 1, 0xFE);
+}
+
+void HWI2CSlaveBus::frequency(uint32_t hz)
+{
+    i2c_frequency(&_i2c, hz);
+}
+
+int HWI2CSlaveBus::receive()
+{
+    return i2c_slave_receive(&_i2c);
+}
+
+int HWI2CSlaveBus::read(uint8_t *buf, size_t len)
+{
+    return i2c_slave_read(&_i2c, reinterpret_cast<char *>(buf), len);
+}
+
+int HWI2CSlaveBus::write(const uint8_t *buf, size_t len)
+{
+    return i2c_slave_write(&_i2c, reinterpret_cast<const char *>(buf), len);
+}
+
+} // namespace detail
+
+I2CSlave::I2CSlave(PinName sda, PinName scl, uint8_t address) :
+    _bus(new detail::HWI2CSlaveBus(sda, scl)), _owns_bus(true), _map(nullptr), _size(0), _reg(0),
+    _staged(nullptr), _staged_len(0), _pool(nullptr), _on_write(), _on_read(), _poll_handle(nullptr)
+{
+    _bus->address(address);
+}
+
+I2CSlave::I2CSlave(detail::I2CSlaveBus *bus, uint8_t address) :
+    _bus(bus), _owns_bus(false), _map(nullptr), _size(0), _reg(0),
+    _staged(nullptr), _staged_len(0), _pool(nullptr), _on_write(), _on_read(), _poll_handle(nullptr)
+{
+    CORE_UTIL_ASSERT(bus != nullptr);
+    _bus->address(address);
+}
+
+I2CSlave::~I2CSlave()
+{
+    stop();
+    if (_owns_bus) {
+        delete _bus;
+    }
+}
+
+void I2CSlave::registers(void *map, size_t size)
+{
+    CORE_UTIL_ASSERT(size <= 256);
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    _map = static_cast<uint8_t *>(map);
+    _size = size > 256 ? 256 : size;
+    _reg = 0;
+}
+
+void I2CSlave::stage(const void *buf, size_t len)
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    _staged = static_cast<const uint8_t *>(buf);
+    _staged_len = len;
+}
+
+void I2CSlave::segment_pool(mbed::util::PoolAllocator *pool)
+{
+    _pool = pool;
+}
+
+void I2CSlave::on_write(const write_callback_t &cb)
+{
+    _on_write = cb;
+}
+
+void I2CSlave::on_read(const read_callback_t &cb)
+{
+    _on_read = cb;
+}
+
+void I2CSlave::start()
+{
+    if (!_poll_handle) {
+        _poll_handle = minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &I2CSlave::poll).bind())
+                .period(minar::milliseconds(YOTTA_CFG_MBED_DRIVERS_I2C_SLAVE_POLL_INTERVAL_MS))
+                .getHandle();
+    }
+}
+
+void I2CSlave::stop()
+{
+    if (_poll_handle) {
+        minar::Scheduler::cancelCallback(_poll_handle);
+        _poll_handle = nullptr;
+    }
+}
+
+void I2CSlave::poll()
+{
+    switch (_bus->receive()) {
+        case detail::I2CSlaveBus::ReadAddressed:
+            serve_read();
+            break;
+        case detail::I2CSlaveBus::WriteGeneral:
+            serve_write(true);
+            break;
+        case detail::I2CSlaveBus::WriteAddressed:
+            serve_write(false);
+            break;
+        default:
+            break;
+    }
+}
+
+void I2CSlave::serve_read()
+{
+    static const uint8_t fill = 0xFF;
+    const uint8_t *src;
+    size_t len;
+    bool staged;
+    bool mapped = false;
+    uint8_t reg;
+    {
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        reg = _reg;
+        staged = _staged_len != 0;
+        if (staged) {
+            src = _staged;
+            len = _staged_len;
+            _staged_len = 0;
+        } else if (_map && reg < _size) {
+            src = _map + reg;
+            len = _size - reg;
+            mapped = true;
+        } else {
+            // Reads beyond the map see an idle bus
+            src = &fill;
+            len = 1;
+        }
+    }
+    int n = _bus->write(src, len);
+    if (n < 0) {
+        n = 0;
+    }
+    if ((size_t)n > len) {
+        n = len;
+    }
+    // The pointer stops at the end of the map, which only wraps it to 0 when the map is 256 bytes
+    if (mapped) {
+        _reg = (uint8_t)(reg + n);
+    }
+    if (_on_read) {
+        minar::Scheduler::postCallback(
+            read_callback_t(this, &I2CSlave::deliver_read).bind(reg, n)
+        );
+    }
+}
+
+void I2CSlave::serve_write(bool general)
+{
+    int n = _bus->read(_rx, sizeof(_rx));
+    if (general || n <= 0) {
+        return;
+    }
+    if ((size_t)n > sizeof(_rx)) {
+        n = sizeof(_rx);
+    }
+    uint8_t reg = _rx[0];
+    size_t len = n - 1;
+    {
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        size_t stored = 0;
+        if (_map && reg < _size) {
+            stored = len < _size - reg ? len : _size - reg;
+            std::memcpy(_map + reg, _rx + 1, stored);
+        }
+        _reg = (uint8_t)(reg + stored);
+    }
+    // A write of just the register address only moves the register pointer
+    if (!len || !_on_write) {
+        return;
+    }
+    detail::I2CSegment *s = nullptr;
+    if (_pool && len <= detail::I2CSegment::ephemeralSize) {
+        void *space = _pool->alloc();
+        if (space) {
+            s = new(space) detail::I2CSegment();
+            s->set_dir(detail::I2CDirection::Receive);
+            s->set_ephemeral(_rx + 1, len);
+        }
+    }
+    minar::Scheduler::postCallback(
+        write_callback_t(this, &I2CSlave::deliver_write).bind(reg, len, s)
+    );
+}
+
+void I2CSlave::deliver_write(uint8_t reg, size_t len, detail::I2CSegment *s)
+{
+    if (_on_write) {
+        _on_write(reg, len, s);
+    }
+    if (s) {
+        s->~I2CSegment();
+        _pool->free(s);
+    }
+}
+
+void I2CSlave::deliver_read(uint8_t reg, size_t len)
+{
+    if (_on_read) {
+        _on_read(reg, len);
+    }
+}
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_I2CSLAVE && DEVICE_I2C_ASYNCH
@@ -0,0 +1,347 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/v2/RegisterMap.hpp"
+#include "minar/minar.h"
+#include <cstring>
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+RegisterCache::RegisterCache(RegisterBus &bus, uint8_t *shadow, uint32_t *valid, uint32_t *dirty, uint32_t *vol,
+                             size_t size) :
+    _bus(bus), _shadow(shadow), _valid(valid), _dirty(dirty), _volatile(vol), _size(size),
+    _op(Idle), _op_reg(0), _op_len(0), _flush_posted(false),
+    _rd_pending(false), _rd_reg(0), _rd_len(0), _rd_buf(nullptr), _rd_done(),
+    _flush_done(), _flush_status(0)
+{}
+
+bool RegisterCache::in_range(uint8_t reg, size_t len) const
+{
+    return len && reg + len <= _size;
+}
+
+void RegisterCache::set_volatile(uint8_t reg, size_t count)
+{
+    for (size_t i = reg; i < reg + count && i < _size; i++) {
+        set(_volatile, i);
+        clear(_valid, i);
+    }
+}
+
+int RegisterCache::refresh(uint8_t reg, size_t len, const done_t &done)
+{
+    return queue_read(reg, nullptr, len, done);
+}
+
+int RegisterCache::read(uint8_t reg, void *buf, size_t len, const done_t &done)
+{
+    if (!in_range(reg, len) || buf == nullptr) {
+        return -1;
+    }
+    for (size_t i = reg; i < reg + len; i++) {
+        if (!test(_valid, i)) {
+            return queue_read(reg, buf, len, done);
+        }
+    }
+    std::memcpy(buf, _shadow + reg, len);
+    minar::Scheduler::postCallback(done_t(done).bind(0));
+    return 0;
+}
+
+int RegisterCache::write(uint8_t reg, const void *buf, size_t len)
+{
+    if (!in_range(reg, len) || buf == nullptr) {
+        return -1;
+    }
+    std::memcpy(_shadow + reg, buf, len);
+    for (size_t i = reg; i < reg + len; i++) {
+        set(_dirty, i);
+        if (!test(_volatile, i)) {
+            set(_valid, i);
+        }
+    }
+    schedule_flush();
+    return 0;
+}
+
+int RegisterCache::update(uint8_t reg, uint8_t mask, uint8_t value)
+{
+    if (!in_range(reg, 1) || !test(_valid, reg)) {
+        return -1;
+    }
+    uint8_t v = (_shadow[reg] & ~mask) | (value & mask);
+    if (v == _shadow[reg] && !test(_dirty, reg)) {
+        // The device already holds this value
+        return 0;
+    }
+    _shadow[reg] = v;
+    set(_dirty, reg);
+    schedule_flush();
+    return 0;
+}
+
+int RegisterCache::get(uint8_t reg, uint8_t *value) const
+{
+    if (!in_range(reg, 1) || !test(_valid, reg)) {
+        return -1;
+    }
+    *value = _shadow[reg];
+    return 0;
+}
+
+void RegisterCache::flush(const done_t &done)
+{
+    if (!_flush_done) {
+        _flush_status = 0;
+    }
+    _flush_done = done;
+    run();
+}
+
+void RegisterCache::invalidate()
+{
+    for (size_t i = 0; i < (_size + 31) / 32; i++) {
+        _valid[i] = 0;
+    }
+}
+
+bool RegisterCache::is_dirty() const
+{
+    if (_op == Writing) {
+        return true;
+    }
+    for (size_t i = 0; i < (_size + 31) / 32; i++) {
+        if (_dirty[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int RegisterCache::queue_read(uint8_t reg, void *buf, size_t len, const done_t &done)
+{
+    if (!in_range(reg, len) || len > sizeof(_scratch) || _rd_pending) {
+        return -1;
+    }
+    _rd_pending = true;
+    _rd_reg = reg;
+    _rd_len = len;
+    _rd_buf = buf;
+    _rd_done = done;
+    run();
+    return 0;
+}
+
+void RegisterCache::schedule_flush()
+{
+    if (!_flush_posted) {
+        _flush_posted = true;
+        minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &RegisterCache::flush_posted).bind());
+    }
+}
+
+void RegisterCache::flush_posted()
+{
+    _flush_posted = false;
+    run();
+}
+
+void RegisterCache::run()
+{
+    if (_op != Idle) {
+        return;
+    }
+    // Dirty registers are written before any read, so that a read sees the writes that were made before it
+    if (write_next_run()) {
+        return;
+    }
+    if (_flush_done) {
+        minar::Scheduler::postCallback(_flush_done.bind(_flush_status));
+        _flush_done = done_t();
+        _flush_status = 0;
+    }
+    if (_rd_pending) {
+        _op = Reading;
+        int rc = _bus.read(_rd_reg, _scratch, _rd_len, done_t(this, &RegisterCache::bus_done));
+        if (rc) {
+            bus_done(rc);
+        }
+    }
+}
+
+bool RegisterCache::write_next_run()
+{
+    size_t first = 0;
+    while (true) {
+        while (first < _size && !test(_dirty, first)) {
+            first++;
+        }
+        if (first >= _size) {
+            return false;
+        }
+        // Coalesce the adjacent dirty registers into one burst
+        size_t len = 1;
+        while (first + len < _size && len < YOTTA_CFG_MBED_DRIVERS_REGISTER_MAP_MAX_BURST &&
+                test(_dirty, first + len)) {
+            len++;
+        }
+        // Registers made dirty again while the burst is in flight are written by a later burst
+        for (size_t i = first; i < first + len; i++) {
+            clear(_dirty, i);
+        }
+        _op = Writing;
+        _op_reg = first;
+        _op_len = len;
+        int rc = _bus.write(first, _shadow + first, len, done_t(this, &RegisterCache::bus_done));
+        if (rc == 0) {
+            return true;
+        }
+        _op = Idle;
+        // The device may not hold the cached values any more
+        for (size_t i = first; i < first + len; i++) {
+            clear(_valid, i);
+        }
+        if (!_flush_status) {
+            _flush_status = rc;
+        }
+        first += len;
+    }
+}
+
+void RegisterCache::bus_done(int status)
+{
+    Operation op = _op;
+    _op = Idle;
+    if (op == Writing) {
+        if (status) {
+            for (size_t i = _op_reg; i < _op_reg + _op_len; i++) {
+                clear(_valid, i);
+            }
+            if (!_flush_status) {
+                _flush_status = status;
+            }
+        }
+    } else if (op == Reading) {
+        uint8_t *buf = static_cast<uint8_t *>(_rd_buf);
+        for (size_t i = 0; status == 0 && i < _rd_len; i++) {
+            size_t r = _rd_reg + i;
+            bool pending = test(_dirty, r);
+            bool vol = test(_volatile, r);
+            // Keep values written since the read started; they have not reached the device yet
+            if (!pending) {
+                _shadow[r] = _scratch[i];
+                if (!vol) {
+                    set(_valid, r);
+                }
+            }
+            if (buf) {
+                buf[i] = (pending && !vol) ? _shadow[r] : _scratch[i];
+            }
+        }
+        _rd_pending = false;
+        minar::Scheduler::postCallback(_rd_done.bind(status));
+        _rd_done = done_t();
+    }
+    run();
+}
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+I2CRegisterBus::I2CRegisterBus(I2C &i2c, uint16_t address) :
+    _i2c(i2c), _address(address), _done()
+{}
+
+int I2CRegisterBus::read(uint8_t reg, void *buf, size_t len, const done_t &done)
+{
+    _done = done;
+    I2CError rc = _i2c.transfer_to(_address)
+        .tx_ephemeral(&reg, 1)
+        .rx(buf, len)
+        .on(I2C_EVENT_ALL, I2C::event_callback_t(this, &I2CRegisterBus::complete))
+        .apply();
+    return rc == I2CError::None ? 0 : -1;
+}
+
+int I2CRegisterBus::write(uint8_t reg, const void *buf, size_t len, const done_t &done)
+{
+    if (len > sizeof(_buf) - 1) {
+        return -1;
+    }
+    // I2C segments must alternate direction, so the register address and data are sent from one buffer
+    _buf[0] = reg;
+    std::memcpy(_buf + 1, buf, len);
+    _done = done;
+    I2CError rc = _i2c.transfer_to(_address)
+        .tx(_buf, len + 1)
+        .on(I2C_EVENT_ALL, I2C::event_callback_t(this, &I2CRegisterBus::complete))
+        .apply();
+    return rc == I2CError::None ? 0 : -1;
+}
+
+void I2CRegisterBus::complete(I2CTransaction *t, uint32_t event)
+{
+    (void) t;
+    bool ok = (event & I2C_EVENT_TRANSFER_COMPLETE) &&
+        !(event & (I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK));
+    _done(ok ? 0 : -1);
+}
+#endif
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+SPIRegisterBus::SPIRegisterBus(SPI &spi, DigitalOut &cs, uint8_t read_flag, uint8_t write_flag) :
+    _spi(spi), _cs(cs), _read_flag(read_flag), _write_flag(write_flag), _done()
+{}
+
+int SPIRegisterBus::read(uint8_t reg, void *buf, size_t len, const done_t &done)
+{
+    uint8_t cmd = reg | _read_flag;
+    _done = done;
+    SPIError rc = _spi.transfer_to(_cs)
+        .tx_ephemeral(&cmd, 1)
+        .rx(buf, len)
+        .on(SPI_EVENT_ALL, SPI::event_callback_t(this, &SPIRegisterBus::complete))
+        .apply();
+    return rc == SPIError::None ? 0 : -1;
+}
+
+int SPIRegisterBus::write(uint8_t reg, const void *buf, size_t len, const done_t &done)
+{
+    if (len > sizeof(_buf) - 1) {
+        return -1;
+    }
+    _buf[0] = reg | _write_flag;
+    std::memcpy(_buf + 1, buf, len);
+    _done = done;
+    SPIError rc = _spi.transfer_to(_cs)
+        .tx(_buf, len + 1)
+        .on(SPI_EVENT_ALL, SPI::event_callback_t(this, &SPIRegisterBus::complete))
+        .apply();
+    return rc == SPIError::None ? 0 : -1;
+}
+
+void SPIRegisterBus::complete(SPITransaction *t, uint32_t event)
+{
+    (void) t;
+    bool ok = (event & SPI_EVENT_COMPLETE) && !(event & (SPI_EVENT_ERROR | SPI_EVENT_RX_OVERFLOW));
+    _done(ok ? 0 : -1);
+}
+#endif
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
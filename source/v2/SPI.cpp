@@ -0,0 +1,432 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#include "mbed-drivers/v2/SPI.hpp"
+#include "mbed-drivers/v2/EphemeralBuffer.hpp"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "PeripheralPins.h"
+#include "mbed-drivers/mbed_error.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+SPITransaction::SPITransaction(DigitalOut *cs, uint8_t bits, uint8_t mode, spi_bitorder_t order, uint32_t hz,
+                               bool irqsafe, SPI *issuer):
+    _next(nullptr),
+    _cs(cs),
+    _root(nullptr),
+    _current(nullptr),
+    _hz(hz),
+    _bits(bits),
+    _mode(mode),
+    _order(order),
+    _irqsafe(irqsafe),
+    _issuer(issuer)
+{}
+
+SPITransaction::~SPITransaction()
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    _current = _root;
+    while (_current) {
+        detail::SPISegment * next = _current->get_next();
+        _issuer->free(_current, _irqsafe);
+        _current = next;
+    }
+}
+
+void SPITransaction::append(SPITransaction *t)
+{
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t) {
+        return;
+    }
+    // Append is called from within a critical section, so an atomic_cas is not necessary
+    SPITransaction * tail = this;
+    while (tail->_next) {
+        tail = tail->_next;
+    }
+    tail->_next = t;
+}
+
+void SPITransaction::call_irq_cb(uint32_t event)
+{
+    if (_current) {
+        _current->call_irq_cb(event);
+    }
+}
+
+bool SPITransaction::advance_segment()
+{
+    if (!_current) {
+        return false;
+    }
+    _current = _current->get_next();
+    return _current != nullptr;
+}
+
+detail::SPISegment * SPITransaction::new_segment()
+{
+    detail::SPISegment * s = _issuer->new_segment(_irqsafe);
+    CORE_UTIL_ASSERT(s != nullptr);
+    if (!s) {
+        return nullptr;
+    }
+    s->set_next(nullptr);
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    if (_root == nullptr) {
+        _root = s;
+    } else {
+        _current->set_next(s);
+    }
+    _current = s;
+    return s;
+}
+
+bool SPITransaction::add_event(uint32_t event, const event_callback_t & cb)
+{
+    size_t i;
+    for (i = 0; i < SPI_TRANSACTION_NHANDLERS; i++) {
+        if (!_handlers[i]) {
+            _handlers[i].set(cb, event);
+            break;
+        }
+    }
+    return i < SPI_TRANSACTION_NHANDLERS;
+}
+
+void SPITransaction::process_event(uint32_t event)
+{
+    size_t i;
+    for (i = 0; i < SPI_TRANSACTION_NHANDLERS; i++) {
+        if (_handlers[i] && _handlers[i].matches(event)) {
+            _handlers[i].call(this, event);
+        }
+    }
+}
+
+SPI::SPI(PinName mosi, PinName miso, PinName sclk) :
+    _hz(1000000), _bits(8), _mode(0), _order(SPI_MSB), _owner(nullptr),
+    TransactionPool(nullptr), SegmentPool(nullptr)
+{
+    init(mosi, miso, sclk);
+}
+
+SPI::SPI(PinName mosi, PinName miso, PinName sclk, mbed::util::PoolAllocator *TransactionPool,
+         mbed::util::PoolAllocator *SegmentPool) :
+    _hz(1000000), _bits(8), _mode(0), _order(SPI_MSB), _owner(nullptr),
+    TransactionPool(TransactionPool), SegmentPool(SegmentPool)
+{
+    init(mosi, miso, sclk);
+}
+
+SPI::SPI(PinName mosi, PinName miso, PinName sclk, detail::SPIResourceManager &owner,
+         mbed::util::PoolAllocator *TransactionPool, mbed::util::PoolAllocator *SegmentPool) :
+    _hz(1000000), _bits(8), _mode(0), _order(SPI_MSB), _owner(&owner),
+    TransactionPool(TransactionPool), SegmentPool(SegmentPool)
+{
+    if (SPIError::None != _owner->init(mosi, miso, sclk)) {
+        _owner = nullptr;
+        error("SPI init failed with an error");
+    }
+}
+
+void SPI::init(PinName mosi, PinName miso, PinName sclk)
+{
+    // Select the appropriate SPI Resource Manager
+    uint32_t spi_mosi = pinmap_peripheral(mosi, PinMap_SPI_MOSI);
+    uint32_t spi_miso = pinmap_peripheral(miso, PinMap_SPI_MISO);
+    uint32_t spi_sclk = pinmap_peripheral(sclk, PinMap_SPI_SCLK);
+    uint32_t peripheral = pinmap_merge(pinmap_merge(spi_mosi, spi_miso), spi_sclk);
+    CORE_UTIL_ASSERT(peripheral != (uint32_t)NC);
+    if (peripheral == (uint32_t)NC) {
+        return;
+    }
+    uint32_t ownerID = pinmap_peripheral_instance(peripheral, PinMap_SPI_SCLK);
+    CORE_UTIL_ASSERT(ownerID != (uint32_t)NC);
+    _owner = detail::get_spi_owner(ownerID);
+    if (!_owner || SPIError::None != _owner->init(mosi, miso, sclk)) {
+        _owner = nullptr;
+        error("SPI init failed with an error");
+    }
+}
+
+SPI::~SPI()
+{
+    if (_owner) {
+        _owner->release();
+    }
+}
+
+void SPI::format(uint8_t bits, uint8_t mode, spi_bitorder_t order)
+{
+    _bits = bits;
+    _mode = mode;
+    _order = order;
+}
+
+void SPI::frequency(uint32_t hz)
+{
+    _hz = hz;
+}
+
+SPI::TransferAdder SPI::transfer_to(DigitalOut &cs)
+{
+    TransferAdder t(this, &cs, false);
+    return t;
+}
+
+SPI::TransferAdder SPI::transfer_to_irqsafe(DigitalOut &cs)
+{
+    TransferAdder t(this, &cs, true);
+    return t;
+}
+
+SPIError SPI::post_transaction(SPITransaction *t)
+{
+    if (!_owner) {
+        return SPIError::InvalidMaster;
+    }
+    return _owner->post_transaction(t);
+}
+
+detail::SPISegment * SPI::new_segment(bool irqsafe)
+{
+    detail::SPISegment * newseg = nullptr;
+    if (irqsafe) {
+        if (!SegmentPool) {
+            return nullptr;
+        }
+        void * space = SegmentPool->alloc();
+        if (!space) {
+            return nullptr;
+        }
+        newseg = new(space) detail::SPISegment();
+    } else {
+        newseg = new detail::SPISegment();
+    }
+    return newseg;
+}
+
+SPITransaction * SPI::new_transaction(DigitalOut *cs, bool irqsafe)
+{
+    SPITransaction * t;
+    if (irqsafe) {
+        if (!TransactionPool) {
+            return nullptr;
+        }
+        void *space = TransactionPool->alloc();
+        if (!space) {
+            return nullptr;
+        }
+        t = new(space) SPITransaction(cs, _bits, _mode, _order, _hz, irqsafe, this);
+    } else {
+        t = new SPITransaction(cs, _bits, _mode, _order, _hz, irqsafe, this);
+    }
+    return t;
+}
+
+void SPI::free(detail::SPISegment *s, bool irqsafe)
+{
+    if (irqsafe) {
+        s->~SPISegment();
+        SegmentPool->free(s);
+    } else {
+        delete s;
+    }
+}
+
+void SPI::free(SPITransaction *t)
+{
+    if (t->is_irqsafe()) {
+        t->~SPITransaction();
+        TransactionPool->free(t);
+    } else {
+        delete t;
+    }
+}
+
+SPI::TransferAdder::TransferAdder(SPI *spi, DigitalOut *cs, bool irqsafe) :
+    _xact(nullptr), _spi(spi), _posted(false), _irqsafe(irqsafe), _rc(SPIError::None)
+{
+    CORE_UTIL_ASSERT(!irqsafe || (spi->TransactionPool && spi->SegmentPool));
+    if (irqsafe && (!spi->TransactionPool || !spi->SegmentPool)) {
+        _rc = SPIError::MissingPoolAllocator;
+        return;
+    }
+    _xact = spi->new_transaction(cs, irqsafe);
+    CORE_UTIL_ASSERT(_xact != nullptr);
+    if (!_xact) {
+        _rc = SPIError::NullTransaction;
+        return;
+    }
+}
+
+SPIError SPI::TransferAdder::apply()
+{
+    if (_rc != SPIError::None) {
+        return _rc;
+    }
+    if (!_posted) {
+        _rc = _spi->post_transaction(_xact);
+        if (_rc == SPIError::None) {
+            _posted = true;
+        }
+    }
+    return _rc;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::on(uint32_t event, const event_callback_t & cb)
+{
+    if (_rc == SPIError::None) {
+        _xact->add_event(event, cb);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::on(uint32_t event, event_callback_t && cb)
+{
+    if (_rc == SPIError::None) {
+        _xact->add_event(event, cb);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::frequency(uint32_t hz)
+{
+    if (_rc == SPIError::None) {
+        _xact->frequency(hz);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::format(uint8_t bits, uint8_t mode, spi_bitorder_t order)
+{
+    if (_rc == SPIError::None) {
+        _xact->format(bits, mode, order);
+    }
+    return *this;
+}
+
+SPI::TransferAdder::~TransferAdder()
+{
+    apply();
+    // If the transaction has not been posted, the TransferAdder still owns it, so it must be freed.
+    if (!_posted && _xact) {
+        _spi->free(_xact);
+    }
+}
+
+detail::SPISegment * SPI::TransferAdder::new_segment()
+{
+    detail::SPISegment * s = nullptr;
+    if (_rc == SPIError::None && _xact) {
+        s = _xact->new_segment();
+        CORE_UTIL_ASSERT(s != nullptr);
+        if (!s) {
+            _rc = SPIError::NullSegment;
+        }
+    }
+    return s;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::tx(void *buf, size_t len)
+{
+    detail::SPISegment * s = new_segment();
+    if (s) {
+        s->tx().set(buf, len);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::tx(const Buffer & buf)
+{
+    detail::SPISegment * s = new_segment();
+    if (s) {
+        s->tx().set(buf);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::tx_ephemeral(const void *buf, size_t len)
+{
+    if (len > mbed::drivers::v2::EphemeralBuffer::ephemeralSize) {
+        _rc = SPIError::BufferSize;
+    } else {
+        detail::SPISegment * s = new_segment();
+        if (s) {
+            s->tx().set_ephemeral(const_cast<void *>(buf), len);
+        }
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::rx(void *buf, size_t len)
+{
+    detail::SPISegment * s = new_segment();
+    if (s) {
+        s->rx().set(buf, len);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::rx(const Buffer & buf)
+{
+    detail::SPISegment * s = new_segment();
+    if (s) {
+        s->rx().set(buf);
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::rx(size_t len)
+{
+    if (len > mbed::drivers::v2::EphemeralBuffer::ephemeralSize) {
+        _rc = SPIError::BufferSize;
+    } else {
+        detail::SPISegment * s = new_segment();
+        if (s) {
+            s->rx().set_ephemeral(nullptr, len);
+        }
+    }
+    return *this;
+}
+
+SPI::TransferAdder & SPI::TransferAdder::txrx(void *txbuf, size_t txlen, void *rxbuf, size_t rxlen)
+{
+    detail::SPISegment * s = new_segment();
+    if (s) {
+        s->tx().set(txbuf, txlen);
+        s->rx().set(rxbuf, rxlen);
+    }
+    return *this;
+}
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif
@@ -0,0 +1,361 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#include "mbed-drivers/v2/SPI.hpp"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "mbed-drivers/driver_trace.h"
+#include "mbed-drivers/mbed_stats.h"
+#include "core-util/atomic_ops.h"
+#include "core-util/assert.h"
+#include "minar/minar.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+namespace detail {
+
+SPIError SPIResourceManager::post_transaction(SPITransaction *t)
+{
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t) {
+        return SPIError::NullTransaction;
+    }
+    SPIError rc = validate_transaction(t);
+    if (rc != SPIError::None) {
+        return rc;
+    }
+
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    SPITransaction * tx = _TransactionQueue;
+    MBED_STATS_ADD(&_stats, MBED_STATS_TRANSFERS, 1);
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    MBED_STATS_MAX(&_stats, MBED_STATS_QUEUE_HIGH_WATER, ++_stats_queued);
+#endif
+
+    if (tx) {
+        tx->append(t);
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI_V2, MBED_DRIVER_TRACE_QUEUE, 0);
+    } else {
+        _TransactionQueue = t;
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI_V2, MBED_DRIVER_TRACE_START, 0);
+        MBED_STATS_START(_stats_start);
+        return start_transaction();
+    }
+    return SPIError::None;
+}
+
+void SPIResourceManager::process_event(uint32_t event)
+{
+    SPITransaction * t = _TransactionQueue;
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t || !event) {
+        return;
+    }
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI_V2, MBED_DRIVER_TRACE_IRQ, event);
+    // Fire the irqcallback for the segment
+    t->call_irq_cb(event);
+
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    SPISegment * s = t->get_current();
+    MBED_STATS_ADD(&_stats, MBED_STATS_BYTES,
+                   s->tx().get_len() > s->rx().get_len() ? s->tx().get_len() : s->rx().get_len());
+#endif
+    bool TransactionDone = !t->advance_segment();
+    if ((event & SPI_EVENT_ALL & ~SPI_EVENT_COMPLETE) ||
+            ((event & SPI_EVENT_COMPLETE) && TransactionDone)) {
+        // The transaction is over, so let go of the device before anything else uses the bus
+        t->select(false);
+        MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI_V2, MBED_DRIVER_TRACE_COMPLETE, event);
+        MBED_STATS_COMPLETE(&_stats, _stats_start);
+        if (event & SPI_EVENT_ALL & ~SPI_EVENT_COMPLETE) {
+            MBED_STATS_ADD(&_stats, MBED_STATS_ERRORS, 1);
+        }
+        minar::Scheduler::postCallback(
+            SPI_event_callback_t(this, &SPIResourceManager::handle_event).bind(t, event)
+        );
+        _TransactionQueue = t->get_next();
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+        _stats_queued--;
+#endif
+        if (_TransactionQueue) {
+            MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI_V2, MBED_DRIVER_TRACE_START, 0);
+            MBED_STATS_START(_stats_start);
+            start_transaction();
+        }
+    } else if (!TransactionDone) {
+        start_segment();
+    }
+}
+
+void SPIResourceManager::handle_event(SPITransaction *t, uint32_t event)
+{
+    MBED_DRIVER_TRACE(MBED_DRIVER_TRACE_SPI_V2, MBED_DRIVER_TRACE_CALLBACK, event);
+    t->process_event(event);
+    // This happens after the callbacks have all been called
+    t->get_issuer()->free(t);
+}
+
+SPIResourceManager::SPIResourceManager() : _TransactionQueue(nullptr)
+{
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    // Only the hardware resource managers know their peripheral, so they rename the group after it
+    std::strcpy(_stats_name, "softspi");
+    mbed_stats_init(&_stats, _stats_name);
+    _stats_start = 0;
+    _stats_queued = 0;
+#endif
+}
+
+SPIResourceManager::~SPIResourceManager()
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    while (_TransactionQueue) {
+        SPITransaction * tx = (_TransactionQueue);
+        _TransactionQueue = tx->get_next();
+        tx->get_issuer()->free(tx);
+    }
+}
+
+class HWSPIResourceManager : public SPIResourceManager
+{
+public:
+    HWSPIResourceManager(const size_t id, void(*handler)(void)):
+        _mosi(NC),
+        _miso(NC),
+        _sclk(NC),
+        _spi(),
+        _id(id),
+        _references(0),
+        _handler(handler)
+    {
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+        std::snprintf(_stats_name, sizeof(_stats_name), "spi%u", (unsigned)id);
+#endif
+    }
+
+    virtual SPIError init(PinName mosi, PinName miso, PinName sclk)
+    {
+        // As for I2C, only one init is permitted until all references have been dropped
+        if (_references == 0 && (_mosi != NC || _miso != NC || _sclk != NC)) {
+            return SPIError::DeinitInProgress;
+        }
+        if (mbed::util::atomic_incr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1) == 1) {
+            spi_init(&_spi, mosi, miso, sclk);
+            _mosi = mosi;
+            _miso = miso;
+            _sclk = sclk;
+        } else {
+            CORE_UTIL_ASSERT_MSG(_mosi == mosi && _miso == miso && _sclk == sclk,
+                                 "Each SPI peripheral may only be used on one set of pins");
+            if (_mosi != mosi || _miso != miso || _sclk != sclk) {
+                return SPIError::PinMismatch;
+            }
+        }
+        return SPIError::None;
+    }
+
+    virtual void release()
+    {
+        if (mbed::util::atomic_decr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1) == 0) {
+            spi_free(&_spi);
+            _mosi = NC;
+            _miso = NC;
+            _sclk = NC;
+        }
+    }
+
+    virtual SPIError start_segment()
+    {
+        SPITransaction * t = _TransactionQueue;
+        CORE_UTIL_ASSERT(t != nullptr);
+        if (!t) {
+            return SPIError::NullTransaction;
+        }
+        SPISegment * s = t->get_current();
+        CORE_UTIL_ASSERT(s != nullptr);
+        if (!s) {
+            return SPIError::NullSegment;
+        }
+        EphemeralBuffer & tx = s->tx();
+        EphemeralBuffer & rx = s->rx();
+        spi_master_transfer(&_spi, tx.get_len() ? tx.get_buf() : nullptr, tx.get_len(),
+                            rx.get_len() ? rx.get_buf() : nullptr, rx.get_len(),
+                            (uint32_t)_handler, SPI_EVENT_ALL, DMA_USAGE_NEVER);
+        return SPIError::None;
+    }
+
+    virtual SPIError start_transaction()
+    {
+        if (spi_active(&_spi)) {
+            return SPIError::Busy; // transaction ongoing
+        }
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        SPITransaction * t = _TransactionQueue;
+        CORE_UTIL_ASSERT(t != nullptr);
+        if (!t) {
+            return SPIError::NullTransaction;
+        }
+        // Every transaction carries its own format, so there is no "last owner" to compare against
+        spi_format(&_spi, t->bits(), t->mode(), t->order());
+        spi_frequency(&_spi, t->frequency());
+        t->reset_current();
+        t->select(true);
+        return start_segment();
+    }
+
+    virtual SPIError validate_transaction(SPITransaction *t) const
+    {
+        if (t->bits() < 4 || t->bits() > 16 || t->mode() > 3) {
+            return SPIError::InvalidFormat;
+        }
+        t->reset_current();
+        if (t->get_current() == nullptr) {
+            return SPIError::NullSegment;
+        }
+        return SPIError::None;
+    }
+
+    void irq_handler()
+    {
+        // SPI_EVENT_INTERNAL_TRANSFER_COMPLETE is only for the HAL; SPI_EVENT_COMPLETE is always requested
+        uint32_t event = spi_irq_handler_asynch(&_spi) & SPI_EVENT_ALL;
+        if (event) {
+            process_event(event);
+        }
+    }
+
+protected:
+    PinName _mosi;
+    PinName _miso;
+    PinName _sclk;
+    spi_t _spi;
+    const size_t _id;
+    volatile uint32_t _references;
+    void (*const _handler)(void);
+};
+
+template <size_t N>
+struct HWSPIResourceManagers : public HWSPIResourceManagers<N-1> {
+public:
+    HWSPIResourceManagers() : rm(N, irq_handler_asynch) {}
+
+private:
+    HWSPIResourceManager rm;
+
+    static void irq_handler_asynch(void)
+    {
+        HWSPIResourceManager *rm = static_cast<HWSPIResourceManager *>(get_spi_owner(N));
+        rm->irq_handler();
+    }
+
+public:
+    SPIResourceManager * get_rm(size_t I)
+    {
+        CORE_UTIL_ASSERT(I <= N);
+        if (I > N) {
+            return nullptr;
+        } else if (I == N) {
+            return &rm;
+        } else {
+            return HWSPIResourceManagers<N-1>::get_rm(I);
+        }
+    }
+};
+
+template <>
+struct HWSPIResourceManagers<0> {
+public:
+    HWSPIResourceManagers() : rm(0, irq_handler_asynch) {}
+
+private:
+    HWSPIResourceManager rm;
+
+    static void irq_handler_asynch(void)
+    {
+        HWSPIResourceManager *rm = static_cast<HWSPIResourceManager *>(get_spi_owner(0));
+        rm->irq_handler();
+    }
+
+public:
+    SPIResourceManager * get_rm(size_t I)
+    {
+        CORE_UTIL_ASSERT(I == 0);
+        if (I) {
+            return nullptr;
+        } else {
+            return &rm;
+        }
+    }
+};
+
+SPIResourceManager * get_spi_owner(int I)
+{
+    // Trap a failed pinmap_merge()
+    CORE_UTIL_ASSERT_MSG(I >=0, "The mosi, miso, sclk combination must exist in the peripheral pin map");
+    if (I < 0) {
+        return nullptr;
+    }
+    static struct HWSPIResourceManagers<MODULES_SIZE_SPI-1> HWManagers;
+    if (I < MODULES_SIZE_SPI) {
+        return HWManagers.get_rm(I);
+    } else {
+        CORE_UTIL_ASSERT(false);
+        return nullptr;
+    }
+}
+
+SPIEventHandler::SPIEventHandler():_cb(), _eventmask(0) {}
+
+void SPIEventHandler::call(SPITransaction *t, uint32_t event)
+{
+    _cb(t,event);
+}
+
+void SPIEventHandler::set(const SPI_event_callback_t &cb, uint32_t event)
+{
+    _cb = cb;
+    _eventmask = event;
+}
+
+bool SPIEventHandler::matches(uint32_t event) const
+{
+    return (_eventmask & event) != 0;
+}
+
+SPIEventHandler::operator bool() const
+{
+    return _eventmask && _cb;
+}
+
+} // namespace detail
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+#endif // DEVICE_SPI && DEVICE_SPI_ASYNCH
@@ -0,0 +1,406 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
+
+#include "mbed-drivers/v2/Serial.hpp"
+#include "mbed-drivers/v2/EphemeralBuffer.hpp"
+#include "minar/minar.h"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "PeripheralPins.h"
+#include "mbed-drivers/mbed_error.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+SerialTransaction::SerialTransaction(detail::SerialDirection dir, bool irqsafe, Serial *issuer):
+    _next(nullptr),
+    _root(nullptr),
+    _current(nullptr),
+    _dir(dir),
+    _irqsafe(irqsafe),
+    _issuer(issuer)
+{}
+
+SerialTransaction::~SerialTransaction()
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    _current = _root;
+    while (_current) {
+        detail::SerialSegment * next = _current->get_next();
+        _issuer->free(_current, _irqsafe);
+        _current = next;
+    }
+}
+
+void SerialTransaction::append(SerialTransaction *t)
+{
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t) {
+        return;
+    }
+    // Append is called from within a critical section, so an atomic_cas is not necessary
+    SerialTransaction * tail = this;
+    while (tail->_next) {
+        tail = tail->_next;
+    }
+    tail->_next = t;
+}
+
+void SerialTransaction::call_irq_cb(uint32_t event)
+{
+    if (_current) {
+        _current->call_irq_cb(event);
+    }
+}
+
+bool SerialTransaction::advance_segment()
+{
+    if (!_current) {
+        return false;
+    }
+    _current = _current->get_next();
+    return _current != nullptr;
+}
+
+detail::SerialSegment * SerialTransaction::new_segment()
+{
+    detail::SerialSegment * s = _issuer->new_segment(_irqsafe);
+    CORE_UTIL_ASSERT(s != nullptr);
+    if (!s) {
+        return nullptr;
+    }
+    s->set_next(nullptr);
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    if (_root == nullptr) {
+        _root = s;
+    } else {
+        _current->set_next(s);
+    }
+    _current = s;
+    return s;
+}
+
+bool SerialTransaction::add_event(uint32_t event, const event_callback_t & cb)
+{
+    size_t i;
+    for (i = 0; i < SERIAL_TRANSACTION_NHANDLERS; i++) {
+        if (!_handlers[i]) {
+            _handlers[i].set(cb, event);
+            break;
+        }
+    }
+    return i < SERIAL_TRANSACTION_NHANDLERS;
+}
+
+void SerialTransaction::process_event(uint32_t event)
+{
+    size_t i;
+    for (i = 0; i < SERIAL_TRANSACTION_NHANDLERS; i++) {
+        if (_handlers[i] && _handlers[i].matches(event)) {
+            _handlers[i].call(this, event);
+        }
+    }
+}
+
+Serial::Serial(PinName tx, PinName rx) :
+    _owner(nullptr), TransactionPool(nullptr), SegmentPool(nullptr)
+{
+    init(tx, rx);
+}
+
+Serial::Serial(PinName tx, PinName rx, mbed::util::PoolAllocator *TransactionPool,
+               mbed::util::PoolAllocator *SegmentPool) :
+    _owner(nullptr), TransactionPool(TransactionPool), SegmentPool(SegmentPool)
+{
+    init(tx, rx);
+}
+
+void Serial::init(PinName tx, PinName rx)
+{
+    // Select the appropriate Serial Resource Manager
+    uint32_t uart_tx = pinmap_peripheral(tx, PinMap_UART_TX);
+    uint32_t uart_rx = pinmap_peripheral(rx, PinMap_UART_RX);
+    uint32_t peripheral = pinmap_merge(uart_tx, uart_rx);
+    CORE_UTIL_ASSERT(peripheral != (uint32_t)NC);
+    if (peripheral == (uint32_t)NC) {
+        return;
+    }
+    uint32_t ownerID = pinmap_peripheral_instance(peripheral, tx != NC ? PinMap_UART_TX : PinMap_UART_RX);
+    CORE_UTIL_ASSERT(ownerID != (uint32_t)NC);
+    _owner = detail::get_serial_owner(ownerID);
+    if (!_owner || SerialError::None != _owner->init(tx, rx)) {
+        _owner = nullptr;
+        error("Serial init failed with an error");
+    }
+}
+
+Serial::~Serial()
+{
+    if (_owner) {
+        _owner->release();
+    }
+}
+
+void Serial::baud(int baudrate)
+{
+    if (_owner) {
+        _owner->baud(baudrate);
+    }
+}
+
+void Serial::format(int bits, SerialParity parity, int stop_bits)
+{
+    if (_owner) {
+        _owner->format(bits, parity, stop_bits);
+    }
+}
+
+Serial::TransferAdder Serial::write()
+{
+    TransferAdder t(this, detail::SerialDirection::Transmit, false);
+    return t;
+}
+
+Serial::TransferAdder Serial::write_irqsafe()
+{
+    TransferAdder t(this, detail::SerialDirection::Transmit, true);
+    return t;
+}
+
+Serial::TransferAdder Serial::read()
+{
+    TransferAdder t(this, detail::SerialDirection::Receive, false);
+    return t;
+}
+
+Serial::TransferAdder Serial::read_irqsafe()
+{
+    TransferAdder t(this, detail::SerialDirection::Receive, true);
+    return t;
+}
+
+SerialError Serial::post_transaction(SerialTransaction *t)
+{
+    if (!_owner) {
+        return SerialError::InvalidPort;
+    }
+    return _owner->post_transaction(t);
+}
+
+detail::SerialSegment * Serial::new_segment(bool irqsafe)
+{
+    detail::SerialSegment * newseg = nullptr;
+    if (irqsafe) {
+        if (!SegmentPool) {
+            return nullptr;
+        }
+        void * space = SegmentPool->alloc();
+        if (!space) {
+            return nullptr;
+        }
+        newseg = new(space) detail::SerialSegment();
+    } else {
+        newseg = new detail::SerialSegment();
+    }
+    return newseg;
+}
+
+SerialTransaction * Serial::new_transaction(detail::SerialDirection dir, bool irqsafe)
+{
+    SerialTransaction * t;
+    if (irqsafe) {
+        if (!TransactionPool) {
+            return nullptr;
+        }
+        void *space = TransactionPool->alloc();
+        if (!space) {
+            return nullptr;
+        }
+        t = new(space) SerialTransaction(dir, irqsafe, this);
+    } else {
+        t = new SerialTransaction(dir, irqsafe, this);
+    }
+    return t;
+}
+
+void Serial::free(detail::SerialSegment *s, bool irqsafe)
+{
+    if (irqsafe) {
+        s->~SerialSegment();
+        SegmentPool->free(s);
+    } else {
+        delete s;
+    }
+}
+
+void Serial::free(SerialTransaction *t)
+{
+    if (t->is_irqsafe()) {
+        t->~SerialTransaction();
+        TransactionPool->free(t);
+    } else {
+        delete t;
+    }
+}
+
+Serial::TransferAdder::TransferAdder(Serial *serial, detail::SerialDirection dir, bool irqsafe) :
+    _xact(nullptr), _serial(serial), _posted(false), _irqsafe(irqsafe), _rc(SerialError::None)
+{
+    CORE_UTIL_ASSERT(!irqsafe || (serial->TransactionPool && serial->SegmentPool));
+    if (irqsafe && (!serial->TransactionPool || !serial->SegmentPool)) {
+        _rc = SerialError::MissingPoolAllocator;
+        return;
+    }
+    _xact = serial->new_transaction(dir, irqsafe);
+    CORE_UTIL_ASSERT(_xact != nullptr);
+    if (!_xact) {
+        _rc = SerialError::NullTransaction;
+        return;
+    }
+}
+
+SerialError Serial::TransferAdder::apply()
+{
+    if (_rc != SerialError::None) {
+        return _rc;
+    }
+    if (!_posted) {
+        _rc = _serial->post_transaction(_xact);
+        if (_rc == SerialError::None) {
+            _posted = true;
+        }
+    }
+    return _rc;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::on(uint32_t event, const event_callback_t & cb)
+{
+    if (_rc == SerialError::None) {
+        _xact->add_event(event, cb);
+    }
+    return *this;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::on(uint32_t event, event_callback_t && cb)
+{
+    if (_rc == SerialError::None) {
+        _xact->add_event(event, cb);
+    }
+    return *this;
+}
+
+Serial::TransferAdder::~TransferAdder()
+{
+    apply();
+    // If the transaction has not been posted, the TransferAdder still owns it, so it must be freed.
+    if (!_posted && _xact) {
+        _serial->free(_xact);
+    }
+}
+
+detail::SerialSegment * Serial::TransferAdder::new_segment(detail::SerialDirection d)
+{
+    detail::SerialSegment * s = nullptr;
+    if (_rc == SerialError::None && _xact) {
+        CORE_UTIL_ASSERT_MSG(_xact->get_dir() == d, "tx() is only valid on write() and rx() on read()");
+        if (_xact->get_dir() != d) {
+            _rc = SerialError::NullSegment;
+            return nullptr;
+        }
+        s = _xact->new_segment();
+        CORE_UTIL_ASSERT(s != nullptr);
+        if (!s) {
+            _rc = SerialError::NullSegment;
+        }
+    }
+    return s;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::tx(const void *buf, size_t len)
+{
+    detail::SerialSegment * s = new_segment(detail::SerialDirection::Transmit);
+    if (s) {
+        s->set(const_cast<void *>(buf), len);
+    }
+    return *this;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::tx(const Buffer & buf)
+{
+    detail::SerialSegment * s = new_segment(detail::SerialDirection::Transmit);
+    if (s) {
+        s->set(buf);
+    }
+    return *this;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::tx_ephemeral(const void *buf, size_t len)
+{
+    if (len > mbed::drivers::v2::EphemeralBuffer::ephemeralSize) {
+        _rc = SerialError::BufferSize;
+    } else {
+        detail::SerialSegment * s = new_segment(detail::SerialDirection::Transmit);
+        if (s) {
+            s->set_ephemeral(const_cast<void *>(buf), len);
+        }
+    }
+    return *this;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::rx(void *buf, size_t len)
+{
+    detail::SerialSegment * s = new_segment(detail::SerialDirection::Receive);
+    if (s) {
+        s->set(buf, len);
+    }
+    return *this;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::rx(const Buffer & buf)
+{
+    detail::SerialSegment * s = new_segment(detail::SerialDirection::Receive);
+    if (s) {
+        s->set(buf);
+    }
+    return *this;
+}
+
+Serial::TransferAdder & Serial::TransferAdder::rx(size_t len)
+{
+    if (len > mbed::drivers::v2::EphemeralBuffer::ephemeralSize) {
+        _rc = SerialError::BufferSize;
+    } else {
+        detail::SerialSegment * s = new_segment(detail::SerialDirection::Receive);
+        if (s) {
+            s->set_ephemeral(nullptr, len);
+        }
+    }
+    return *this;
+}
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif
@@ -0,0 +1,318 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
+
+#include "mbed-drivers/v2/Serial.hpp"
+#include "core-util/CriticalSectionLock.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "core-util/atomic_ops.h"
+#include "core-util/assert.h"
+#include "minar/minar.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+namespace detail {
+
+SerialError SerialResourceManager::post_transaction(SerialTransaction *t)
+{
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t) {
+        return SerialError::NullTransaction;
+    }
+    t->reset_current();
+    if (t->get_current() == nullptr) {
+        return SerialError::NullSegment;
+    }
+
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    SerialTransaction * volatile & q = queue(t->get_dir());
+
+    if (q) {
+        q->append(t);
+    } else {
+        q = t;
+        return start_transaction(t->get_dir());
+    }
+    return SerialError::None;
+}
+
+void SerialResourceManager::process_event(SerialDirection d, uint32_t event)
+{
+    SerialTransaction * volatile & q = queue(d);
+    SerialTransaction * t = q;
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t || !event) {
+        return;
+    }
+    const uint32_t complete = (d == SerialDirection::Transmit) ? SERIAL_EVENT_TX_COMPLETE : SERIAL_EVENT_RX_COMPLETE;
+    // Fire the irqcallback for the segment
+    t->call_irq_cb(event);
+
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    bool TransactionDone = !t->advance_segment();
+    if ((event & ~complete) || TransactionDone) {
+        minar::Scheduler::postCallback(
+            Serial_event_callback_t(this, &SerialResourceManager::handle_event).bind(t, event)
+        );
+        // Keep the UART busy: the next transaction starts before returning from the interrupt
+        q = t->get_next();
+        if (q) {
+            start_transaction(d);
+        }
+    } else {
+        start_segment(d);
+    }
+}
+
+void SerialResourceManager::handle_event(SerialTransaction *t, uint32_t event)
+{
+    t->process_event(event);
+    // This happens after the callbacks have all been called
+    t->get_issuer()->free(t);
+}
+
+SerialResourceManager::SerialResourceManager() : _TxQueue(nullptr), _RxQueue(nullptr) {}
+
+SerialResourceManager::~SerialResourceManager()
+{
+    mbed::util::CriticalSectionLock lock;
+    MBED_CRITICAL_PROFILE();
+    while (_TxQueue) {
+        SerialTransaction * tx = _TxQueue;
+        _TxQueue = tx->get_next();
+        tx->get_issuer()->free(tx);
+    }
+    while (_RxQueue) {
+        SerialTransaction * rx = _RxQueue;
+        _RxQueue = rx->get_next();
+        rx->get_issuer()->free(rx);
+    }
+}
+
+class HWSerialResourceManager : public SerialResourceManager
+{
+public:
+    HWSerialResourceManager(const size_t id, void(*handler)(void)):
+        _tx(NC),
+        _rx(NC),
+        _serial(),
+        _id(id),
+        _references(0),
+        _handler(handler)
+    {}
+
+    virtual SerialError init(PinName tx, PinName rx)
+    {
+        // As for I2C, only one init is permitted until all references have been dropped
+        if (_references == 0 && (_tx != NC || _rx != NC)) {
+            return SerialError::DeinitInProgress;
+        }
+        if (mbed::util::atomic_incr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1) == 1) {
+            serial_init(&_serial, tx, rx);
+            _tx = tx;
+            _rx = rx;
+        } else {
+            CORE_UTIL_ASSERT_MSG(_tx == tx && _rx == rx, "Each UART may only be used on one set of pins");
+            if (_tx != tx || _rx != rx) {
+                return SerialError::PinMismatch;
+            }
+        }
+        return SerialError::None;
+    }
+
+    virtual void release()
+    {
+        if (mbed::util::atomic_decr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1) == 0) {
+            serial_free(&_serial);
+            _tx = NC;
+            _rx = NC;
+        }
+    }
+
+    virtual void baud(int baudrate)
+    {
+        serial_baud(&_serial, baudrate);
+    }
+
+    virtual void format(int bits, SerialParity parity, int stop_bits)
+    {
+        serial_format(&_serial, bits, parity, stop_bits);
+    }
+
+    virtual SerialError start_segment(SerialDirection d)
+    {
+        SerialTransaction * t = queue(d);
+        CORE_UTIL_ASSERT(t != nullptr);
+        if (!t) {
+            return SerialError::NullTransaction;
+        }
+        SerialSegment * s = t->get_current();
+        CORE_UTIL_ASSERT(s != nullptr);
+        if (!s) {
+            return SerialError::NullSegment;
+        }
+        if (d == SerialDirection::Transmit) {
+            serial_tx_asynch(&_serial, s->get_buf(), s->get_len(), 0, (uint32_t)_handler,
+                             SERIAL_EVENT_TX_ALL, DMA_USAGE_NEVER);
+        } else {
+            serial_rx_asynch(&_serial, s->get_buf(), s->get_len(), 0, (uint32_t)_handler,
+                             SERIAL_EVENT_RX_ALL, SERIAL_RESERVED_CHAR_MATCH, DMA_USAGE_NEVER);
+        }
+        return SerialError::None;
+    }
+
+    virtual SerialError start_transaction(SerialDirection d)
+    {
+        if (d == SerialDirection::Transmit ? serial_tx_active(&_serial) : serial_rx_active(&_serial)) {
+            return SerialError::Busy;
+        }
+        mbed::util::CriticalSectionLock lock;
+        MBED_CRITICAL_PROFILE();
+        SerialTransaction * t = queue(d);
+        CORE_UTIL_ASSERT(t != nullptr);
+        if (!t) {
+            return SerialError::NullTransaction;
+        }
+        t->reset_current();
+        return start_segment(d);
+    }
+
+    void irq_handler()
+    {
+        // One interrupt can report both directions
+        uint32_t event = serial_irq_handler_asynch(&_serial);
+        if (event & SERIAL_EVENT_TX_ALL) {
+            process_event(SerialDirection::Transmit, event & SERIAL_EVENT_TX_ALL);
+        }
+        if (event & SERIAL_EVENT_RX_ALL) {
+            process_event(SerialDirection::Receive, event & SERIAL_EVENT_RX_ALL);
+        }
+    }
+
+protected:
+    PinName _tx;
+    PinName _rx;
+    serial_t _serial;
+    const size_t _id;
+    volatile uint32_t _references;
+    void (*const _handler)(void);
+};
+
+template <size_t N>
+struct HWSerialResourceManagers : public HWSerialResourceManagers<N-1> {
+public:
+    HWSerialResourceManagers() : rm(N, irq_handler_asynch) {}
+
+private:
+    HWSerialResourceManager rm;
+
+    static void irq_handler_asynch(void)
+    {
+        HWSerialResourceManager *rm = static_cast<HWSerialResourceManager *>(get_serial_owner(N));
+        rm->irq_handler();
+    }
+
+public:
+    SerialResourceManager * get_rm(size_t I)
+    {
+        CORE_UTIL_ASSERT(I <= N);
+        if (I > N) {
+            return nullptr;
+        } else if (I == N) {
+            return &rm;
+        } else {
+            return HWSerialResourceManagers<N-1>::get_rm(I);
+        }
+    }
+};
+
+template <>
+struct HWSerialResourceManagers<0> {
+public:
+    HWSerialResourceManagers() : rm(0, irq_handler_asynch) {}
+
+private:
+    HWSerialResourceManager rm;
+
+    static void irq_handler_asynch(void)
+    {
+        HWSerialResourceManager *rm = static_cast<HWSerialResourceManager *>(get_serial_owner(0));
+        rm->irq_handler();
+    }
+
+public:
+    SerialResourceManager * get_rm(size_t I)
+    {
+        CORE_UTIL_ASSERT(I == 0);
+        if (I) {
+            return nullptr;
+        } else {
+            return &rm;
+        }
+    }
+};
+
+SerialResourceManager * get_serial_owner(int I)
+{
+    // Trap a failed pinmap_merge()
+    CORE_UTIL_ASSERT_MSG(I >=0, "The tx, rx combination must exist in the peripheral pin map");
+    if (I < 0) {
+        return nullptr;
+    }
+    static struct HWSerialResourceManagers<MODULES_SIZE_SERIAL-1> HWManagers;
+    if (I < MODULES_SIZE_SERIAL) {
+        return HWManagers.get_rm(I);
+    } else {
+        CORE_UTIL_ASSERT(false);
+        return nullptr;
+    }
+}
+
+SerialEventHandler::SerialEventHandler():_cb(), _eventmask(0) {}
+
+void SerialEventHandler::call(SerialTransaction *t, uint32_t event)
+{
+    _cb(t,event);
+}
+
+void SerialEventHandler::set(const Serial_event_callback_t &cb, uint32_t event)
+{
+    _cb = cb;
+    _eventmask = event;
+}
+
+bool SerialEventHandler::matches(uint32_t event) const
+{
+    return (_eventmask & event) != 0;
+}
+
+SerialEventHandler::operator bool() const
+{
+    return _eventmask && _cb;
+}
+
+} // namespace detail
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+#endif // DEVICE_SERIAL && DEVICE_SERIAL_ASYNCH
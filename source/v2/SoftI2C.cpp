@@ -0,0 +1,120 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+
+#include "mbed-drivers/v2/SoftI2C.hpp"
+#include "minar/minar.h"
+#include "core-util/atomic_ops.h"
+#include "core-util/assert.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+SoftI2CResourceManager::SoftI2CResourceManager(PinName sda, PinName scl) :
+    _bus(sda, scl), _sda(sda), _scl(scl), _references(0)
+{}
+
+I2CError SoftI2CResourceManager::init(PinName sda, PinName scl)
+{
+    CORE_UTIL_ASSERT_MSG(_sda == sda && _scl == scl, "A SoftI2CResourceManager is bound to the pins it was created on");
+    if (_sda != sda || _scl != scl) {
+        return I2CError::PinMismatch;
+    }
+    mbed::util::atomic_incr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1);
+    return I2CError::None;
+}
+
+void SoftI2CResourceManager::release()
+{
+    mbed::util::atomic_decr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1);
+}
+
+I2CError SoftI2CResourceManager::start_transaction()
+{
+    I2CTransaction * t = _TransactionQueue;
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t) {
+        return I2CError::NullTransaction;
+    }
+    t->reset_current();
+    schedule();
+    return I2CError::None;
+}
+
+I2CError SoftI2CResourceManager::start_segment()
+{
+    schedule();
+    return I2CError::None;
+}
+
+I2CError SoftI2CResourceManager::validate_transaction(I2CTransaction *t) const
+{
+    if (t->address() > 0xFF) {
+        return I2CError::InvalidAddress;
+    }
+    return I2CError::None;
+}
+
+void SoftI2CResourceManager::schedule()
+{
+    // start_transaction() and start_segment() may be called from IRQ context, and with interrupts disabled
+    minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &SoftI2CResourceManager::run).bind());
+}
+
+void SoftI2CResourceManager::run()
+{
+    I2CTransaction * t = _TransactionQueue;
+    if (!t) {
+        return;
+    }
+    // A transaction without segments is a ping: the address alone
+    detail::I2CSegment * s = t->get_current();
+    bool receive = s && s->get_dir() == detail::I2CDirection::Receive;
+    uint32_t event = I2C_EVENT_TRANSFER_COMPLETE;
+
+    _bus.frequency(t->frequency());
+    _bus.start();
+    if (!_bus.write((t->address() & 0xFE) | (receive ? 1 : 0))) {
+        event = I2C_EVENT_ERROR_NO_SLAVE;
+    } else if (s) {
+        uint8_t * buf = static_cast<uint8_t *>(s->get_buf());
+        size_t len = s->get_len();
+        for (size_t i = 0; i < len; i++) {
+            if (receive) {
+                buf[i] = _bus.read(i < len - 1);
+            } else if (!_bus.write(buf[i])) {
+                event = I2C_EVENT_TRANSFER_EARLY_NACK;
+                break;
+            }
+        }
+    }
+    // Later segments follow with a repeated start
+    if (event != I2C_EVENT_TRANSFER_COMPLETE || !s || !s->get_next()) {
+        _bus.stop();
+    }
+    process_event(event);
+}
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_I2C && DEVICE_I2C_ASYNCH
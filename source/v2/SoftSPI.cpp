@@ -0,0 +1,128 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed-drivers/platform.h"
+
+#if DEVICE_SPI && DEVICE_SPI_ASYNCH
+
+#include "mbed-drivers/v2/SoftSPI.hpp"
+#include "minar/minar.h"
+#include "core-util/atomic_ops.h"
+#include "core-util/assert.h"
+
+namespace mbed {
+namespace drivers {
+namespace v2 {
+
+SoftSPIResourceManager::SoftSPIResourceManager(PinName mosi, PinName miso, PinName sclk) :
+    _bus(mosi, miso, sclk), _mosi(mosi), _miso(miso), _sclk(sclk), _references(0)
+{}
+
+SPIError SoftSPIResourceManager::init(PinName mosi, PinName miso, PinName sclk)
+{
+    CORE_UTIL_ASSERT_MSG(_mosi == mosi && _miso == miso && _sclk == sclk,
+                         "A SoftSPIResourceManager is bound to the pins it was created on");
+    if (_mosi != mosi || _miso != miso || _sclk != sclk) {
+        return SPIError::PinMismatch;
+    }
+    mbed::util::atomic_incr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1);
+    return SPIError::None;
+}
+
+void SoftSPIResourceManager::release()
+{
+    mbed::util::atomic_decr<std::uint32_t>(const_cast<std::uint32_t *>(&_references), 1);
+}
+
+SPIError SoftSPIResourceManager::start_transaction()
+{
+    SPITransaction * t = _TransactionQueue;
+    CORE_UTIL_ASSERT(t != nullptr);
+    if (!t) {
+        return SPIError::NullTransaction;
+    }
+    _bus.format(t->bits(), t->mode(), t->order());
+    _bus.frequency(t->frequency());
+    t->reset_current();
+    t->select(true);
+    schedule();
+    return SPIError::None;
+}
+
+SPIError SoftSPIResourceManager::start_segment()
+{
+    schedule();
+    return SPIError::None;
+}
+
+SPIError SoftSPIResourceManager::validate_transaction(SPITransaction *t) const
+{
+    if (t->bits() < 1 || t->bits() > 16 || t->mode() > 3) {
+        return SPIError::InvalidFormat;
+    }
+    t->reset_current();
+    if (t->get_current() == nullptr) {
+        return SPIError::NullSegment;
+    }
+    return SPIError::None;
+}
+
+void SoftSPIResourceManager::schedule()
+{
+    // start_transaction() and start_segment() may be called from IRQ context, and with interrupts disabled
+    minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &SoftSPIResourceManager::run).bind());
+}
+
+void SoftSPIResourceManager::run()
+{
+    SPITransaction * t = _TransactionQueue;
+    if (!t) {
+        return;
+    }
+    detail::SPISegment * s = t->get_current();
+    if (!s) {
+        return;
+    }
+    EphemeralBuffer & tx = s->tx();
+    EphemeralBuffer & rx = s->rx();
+    const uint8_t * out = static_cast<const uint8_t *>(tx.get_buf());
+    uint8_t * in = static_cast<uint8_t *>(rx.get_buf());
+    size_t width = t->bits() > 8 ? 2 : 1;
+    size_t len = tx.get_len() > rx.get_len() ? tx.get_len() : rx.get_len();
+    // Only whole frames are taken from or stored to either buffer, so a length that is not a multiple of the frame
+    // width never reads or writes past its end
+    for (size_t i = 0; i + width <= len; i += width) {
+        int word = SPI_FILL_WORD;
+        if (i + width <= tx.get_len()) {
+            word = width == 2 ? out[i] | (out[i + 1] << 8) : out[i];
+        }
+        word = _bus.write(word);
+        if (i + width <= rx.get_len()) {
+            in[i] = word & 0xFF;
+            if (width == 2) {
+                in[i + 1] = (word >> 8) & 0xFF;
+            }
+        }
+    }
+    process_event(SPI_EVENT_COMPLETE);
+}
+
+} // namespace v2
+} // namespace drivers
+} // namespace mbed
+
+#endif // DEVICE_SPI && DEVICE_SPI_ASYNCH
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/mbed_alloc_trace.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#include <new>
+
+#if !YOTTA_CFG_MBED_DRIVERS_ALLOC_TRACE
+  #error [NOT_SUPPORTED] Allocation tracing is not enabled
+#endif
+
+using namespace utest::v1;
+
+static unsigned trapped;
+static size_t trapped_size;
+
+// Log allocations after sealing instead of halting, so that the test can carry on
+extern "C" void mbed_alloc_sealed_hook(void *caller, size_t size) {
+    (void)caller;
+    trapped++;
+    trapped_size = size;
+}
+
+// Allocations are kept here, so that the compiler cannot pair them with their deletes and leave both out
+static uint32_t * volatile kept;
+
+static __attribute__((noinline)) uint32_t *allocate_a() {
+    kept = new uint32_t[4];
+    return kept;
+}
+
+static __attribute__((noinline)) uint32_t *allocate_b() {
+    kept = new (std::nothrow) uint32_t;
+    return kept;
+}
+
+static const mbed_alloc_site_t *find_site(uint32_t count) {
+    size_t n;
+    const mbed_alloc_site_t *s = mbed_alloc_trace_sites(&n);
+    for (size_t i = 0; i < n; i++) {
+        if (s[i].count == count) {
+            return &s[i];
+        }
+    }
+    return NULL;
+}
+
+void test_case_attribution() {
+    mbed_alloc_unseal();
+    mbed_alloc_trace_reset();
+    delete[] allocate_a();
+    delete[] allocate_a();
+    delete[] allocate_a();
+    delete allocate_b();
+
+    size_t n;
+    mbed_alloc_trace_sites(&n);
+    TEST_ASSERT_EQUAL_INT(2, n);
+    const mbed_alloc_site_t *a = find_site(3);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_UINT32(3 * 4 * sizeof(uint32_t), a->bytes);
+    const mbed_alloc_site_t *b = find_site(1);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(uint32_t), b->bytes);
+    TEST_ASSERT_TRUE(a->caller != b->caller);
+    TEST_ASSERT_EQUAL_UINT32(0, mbed_alloc_trace_untracked());
+}
+
+void test_case_sealed() {
+    mbed_alloc_trace_reset();
+    trapped = 0;
+    mbed_alloc_seal();
+    TEST_ASSERT_TRUE(mbed_alloc_sealed());
+    uint32_t *p = allocate_a();
+    mbed_alloc_unseal();
+    TEST_ASSERT_EQUAL_INT(1, trapped);
+    TEST_ASSERT_EQUAL_INT(4 * sizeof(uint32_t), trapped_size);
+    // The allocation is still made and counted
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_NOT_NULL(find_site(1));
+    delete[] p;
+
+    delete allocate_b();
+    TEST_ASSERT_EQUAL_INT(1, trapped);
+}
+
+void test_case_note() {
+    mbed_alloc_trace_reset();
+    trapped = 0;
+    mbed_alloc_seal();
+    mbed_alloc_trace_record(MBED_ALLOC_CALLER, 100);
+    mbed_alloc_unseal();
+    TEST_ASSERT_EQUAL_INT(1, trapped);
+    const mbed_alloc_site_t *s = find_site(1);
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_UINT32(100, s->bytes);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Allocation trace: allocations are counted by call site", test_case_attribution, greentea_failure_handler),
+    Case("Allocation trace: allocations after sealing are trapped", test_case_sealed, greentea_failure_handler),
+    Case("Allocation trace: allocations made outside operator new", test_case_note, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
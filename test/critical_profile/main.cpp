@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/mbed_critical_profile.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+/* A simulated clock replaces the weak profiling clock, so that durations are exact. Interrupts are disabled around
+ * each record, as they would be in a real critical section.
+ */
+static uint32_t sim_clock;
+
+extern "C" uint32_t mbed_critical_profile_clock(void) {
+    return sim_clock;
+}
+
+static mbed_critical_site_t site_a = MBED_CRITICAL_SITE_INIT;
+static mbed_critical_site_t site_b = MBED_CRITICAL_SITE_INIT;
+
+static void pass(mbed_critical_site_t *site, uint32_t ticks, void *caller) {
+    __disable_irq();
+    uint32_t start = mbed_critical_profile_clock();
+    sim_clock += ticks;
+    mbed_critical_profile_record(site, start, caller);
+    __enable_irq();
+}
+
+static bool listed(const mbed_critical_site_t *site) {
+    for (const mbed_critical_site_t *s = mbed_critical_profile_sites(); s; s = s->next) {
+        if (s == site) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void test_case_max_and_caller() {
+    mbed_critical_profile_start();
+    pass(&site_a, 5, (void *)0x100);
+    pass(&site_a, 40, (void *)0x200);
+    pass(&site_a, 7, (void *)0x300);
+    TEST_ASSERT_TRUE(listed(&site_a));
+    TEST_ASSERT_EQUAL_UINT32(3, site_a.count);
+    TEST_ASSERT_EQUAL_UINT32(40, site_a.max);
+    TEST_ASSERT_EQUAL_PTR((void *)0x200, site_a.max_caller);
+}
+
+void test_case_histogram() {
+    mbed_critical_profile_start();
+    pass(&site_b, 0, NULL);
+    pass(&site_b, 1, NULL);
+    pass(&site_b, 4, NULL);
+    pass(&site_b, 7, NULL);
+    pass(&site_b, 8, NULL);
+    pass(&site_b, 0xFFFFFFFF, NULL);
+    TEST_ASSERT_EQUAL_UINT32(2, site_b.histogram[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, site_b.histogram[1]);
+    TEST_ASSERT_EQUAL_UINT32(2, site_b.histogram[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, site_b.histogram[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, site_b.histogram[YOTTA_CFG_MBED_DRIVERS_CRITICAL_PROFILE_BINS - 1]);
+}
+
+void test_case_start_clears() {
+    mbed_critical_profile_start();
+    TEST_ASSERT_TRUE(listed(&site_a));
+    TEST_ASSERT_TRUE(listed(&site_b));
+    TEST_ASSERT_EQUAL_UINT32(0, site_a.count);
+    TEST_ASSERT_EQUAL_UINT32(0, site_a.max);
+    TEST_ASSERT_EQUAL_UINT32(0, site_b.histogram[0]);
+    // A site already listed is not listed again
+    pass(&site_a, 3, NULL);
+    uint32_t n = 0;
+    for (const mbed_critical_site_t *s = mbed_critical_profile_sites(); s; s = s->next) {
+        n += (s == &site_a);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, n);
+    mbed_critical_profile_report();
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Critical profile: max duration and caller", test_case_max_and_caller, greentea_failure_handler),
+    Case("Critical profile: histogram", test_case_histogram, greentea_failure_handler),
+    Case("Critical profile: start clears records", test_case_start_clears, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
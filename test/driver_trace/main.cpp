@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/driver_trace.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+#define TRACE_SIZE YOTTA_CFG_MBED_DRIVERS_DRIVER_TRACE_SIZE
+
+static mbed_driver_trace_record_t records[TRACE_SIZE];
+
+static void flush() {
+    uint32_t lost;
+    while (mbed_driver_trace_drain(records, TRACE_SIZE, &lost));
+}
+
+void test_case_drain_in_order() {
+    flush();
+    mbed_driver_trace(MBED_DRIVER_TRACE_USER, MBED_DRIVER_TRACE_START, 16);
+    mbed_driver_trace(MBED_DRIVER_TRACE_USER, MBED_DRIVER_TRACE_IRQ, 0x1234);
+    mbed_driver_trace(MBED_DRIVER_TRACE_USER + 1, MBED_DRIVER_TRACE_COMPLETE, 0xCAFEF00D);
+
+    uint32_t lost = 1;
+    TEST_ASSERT_EQUAL_INT(2, mbed_driver_trace_drain(records, 2, &lost));
+    TEST_ASSERT_EQUAL_UINT32(0, lost);
+    TEST_ASSERT_EQUAL_UINT8(MBED_DRIVER_TRACE_USER, records[0].driver);
+    TEST_ASSERT_EQUAL_UINT8(MBED_DRIVER_TRACE_START, records[0].event);
+    TEST_ASSERT_EQUAL_UINT32(16, records[0].arg);
+    TEST_ASSERT_EQUAL_UINT8(MBED_DRIVER_TRACE_IRQ, records[1].event);
+    TEST_ASSERT_EQUAL_UINT32(0x1234, records[1].arg);
+    TEST_ASSERT_TRUE((int32_t)(records[1].timestamp - records[0].timestamp) >= 0);
+
+    TEST_ASSERT_EQUAL_INT(1, mbed_driver_trace_drain(records, TRACE_SIZE, NULL));
+    TEST_ASSERT_EQUAL_UINT8(MBED_DRIVER_TRACE_USER + 1, records[0].driver);
+    TEST_ASSERT_EQUAL_UINT32(0xCAFEF00D, records[0].arg);
+    TEST_ASSERT_EQUAL_INT(0, mbed_driver_trace_drain(records, TRACE_SIZE, NULL));
+}
+
+void test_case_overwrite_oldest() {
+    flush();
+    for (uint32_t i = 0; i < TRACE_SIZE + 10; i++) {
+        mbed_driver_trace(MBED_DRIVER_TRACE_USER, MBED_DRIVER_TRACE_FIRE, i);
+    }
+    uint32_t lost = 0;
+    TEST_ASSERT_EQUAL_INT(TRACE_SIZE, mbed_driver_trace_drain(records, TRACE_SIZE, &lost));
+    TEST_ASSERT_EQUAL_UINT32(10, lost);
+    // The oldest records were the ones overwritten
+    TEST_ASSERT_EQUAL_UINT32(10, records[0].arg);
+    TEST_ASSERT_EQUAL_UINT32(TRACE_SIZE + 9, records[TRACE_SIZE - 1].arg);
+}
+
+void fire_from_irq() {
+    mbed_driver_trace(MBED_DRIVER_TRACE_USER, MBED_DRIVER_TRACE_FIRE, 0xABCD);
+}
+
+void test_case_record_from_irq() {
+    flush();
+    Timeout timeout;
+    timeout.attach_us(fire_from_irq, 1000);
+    wait_ms(10);
+    // The drivers record their own events too when tracing is enabled
+    size_t n = mbed_driver_trace_drain(records, TRACE_SIZE, NULL);
+    size_t found = 0;
+    for (size_t i = 0; i < n; i++) {
+        found += records[i].driver == MBED_DRIVER_TRACE_USER && records[i].arg == 0xABCD;
+    }
+    TEST_ASSERT_EQUAL_INT(1, found);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Driver trace: records drain in order", test_case_drain_in_order, greentea_failure_handler),
+    Case("Driver trace: the oldest records are overwritten", test_case_overwrite_oldest, greentea_failure_handler),
+    Case("Driver trace: records from an interrupt", test_case_record_from_irq, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/RamFileSystem.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+static uint32_t arena[256];
+static RamFileSystem ramfs("ram", arena, sizeof(arena));
+static FileHandle *fh;
+static char out[] = "asynchronous file data";
+static char in[sizeof(out)];
+
+void read_done(Buffer buffer, ssize_t n) {
+    TEST_ASSERT_EQUAL_PTR(in, buffer.buf);
+    TEST_ASSERT_EQUAL_INT(sizeof(in), n);
+    TEST_ASSERT_EQUAL_STRING(out, in);
+    fh->close();
+    Harness::validate_callback();
+}
+
+void write_done(Buffer buffer, ssize_t n) {
+    TEST_ASSERT_EQUAL_PTR(out, buffer.buf);
+    TEST_ASSERT_EQUAL_INT(sizeof(out), n);
+    TEST_ASSERT_EQUAL_INT(0, fh->lseek(0, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(0, fh->read_async(in, sizeof(in), FileHandle::io_callback_t(read_done)));
+}
+
+control_t test_case_write_read() {
+    fh = ramfs.open("async.bin", O_RDWR | O_CREAT);
+    TEST_ASSERT_NOT_NULL(fh);
+    memset(in, 0, sizeof(in));
+    TEST_ASSERT_EQUAL_INT(0, fh->write_async(out, sizeof(out), FileHandle::io_callback_t(write_done)));
+    // Nothing completes until the scheduler runs
+    TEST_ASSERT_EQUAL_INT(0, in[0]);
+    return CaseTimeout(5 * 1000);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Async file I/O: default adapter", test_case_write_read, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
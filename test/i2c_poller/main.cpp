@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/v2/I2CPoller.hpp"
+#include "minar/minar.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#if !DEVICE_I2C || !DEVICE_I2C_ASYNCH
+  #error [NOT_SUPPORTED] Asynchronous I2C is not supported
+#endif
+
+using namespace utest::v1;
+using namespace mbed::drivers::v2;
+
+/* A simulated device: writes are recorded, and reads return an incrementing pattern. Each segment completes from
+ * minar, as if the device were present.
+ */
+class SimI2C : public detail::I2CResourceManager {
+public:
+    SimI2C() : written_len(0) {}
+
+    virtual I2CError init(PinName, PinName) {
+        return I2CError::None;
+    }
+    virtual void release() {}
+
+    uint8_t written[16];
+    size_t written_len;
+
+protected:
+    virtual I2CError start_transaction() {
+        _TransactionQueue->reset_current();
+        return start_segment();
+    }
+    virtual I2CError start_segment() {
+        minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &SimI2C::complete).bind());
+        return I2CError::None;
+    }
+    virtual I2CError validate_transaction(I2CTransaction *) const {
+        return I2CError::None;
+    }
+    void complete() {
+        detail::I2CSegment *s = _TransactionQueue->get_current();
+        uint8_t *buf = static_cast<uint8_t *>(s->get_buf());
+        if (s->get_dir() == detail::I2CDirection::Transmit) {
+            written_len = s->get_len() < sizeof(written) ? s->get_len() : sizeof(written);
+            memcpy(written, buf, written_len);
+        } else {
+            for (size_t i = 0; i < s->get_len(); i++) {
+                buf[i] = i + 1;
+            }
+        }
+        process_event(I2C_EVENT_TRANSFER_COMPLETE);
+    }
+};
+
+static uint8_t xact_space[2 * sizeof(I2CTransaction)];
+static mbed::util::PoolAllocator xacts(xact_space, 2, sizeof(I2CTransaction));
+static uint8_t seg_space[4 * sizeof(detail::I2CSegment)];
+static mbed::util::PoolAllocator segs(seg_space, 4, sizeof(detail::I2CSegment));
+
+static SimI2C sim;
+static mbed::drivers::v2::I2C i2c(NC, NC, sim, &xacts, &segs);
+static I2CPoller poller(i2c, 10000);
+
+// Longer than the inline buffer of a segment, so it is sent from the caller's buffer
+static const uint8_t long_cmd[] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18};
+static I2CPoller::Entry long_entry(0x90, long_cmd, sizeof(long_cmd), 2, 1);
+
+void long_sampled(I2CPoller::Entry *e) {
+    poller.stop();
+    poller.remove(*e);
+    // A poll that was already queued may still complete
+    e->on_sample(I2CPoller::sample_callback_t());
+    TEST_ASSERT_EQUAL_INT(0, e->errors());
+    TEST_ASSERT_EQUAL_INT(sizeof(long_cmd), sim.written_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(long_cmd, sim.written, sizeof(long_cmd));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x01\x02", e->latest(), 2);
+    Harness::validate_callback();
+}
+
+control_t test_case_long_command() {
+    long_entry.on_sample(long_sampled);
+    poller.add(long_entry);
+    poller.start();
+    return CaseTimeout(5 * 1000);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("I2C poller: a command longer than a segment's inline buffer", test_case_long_command, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
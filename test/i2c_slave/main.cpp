@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/v2/I2CSlave.hpp"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#if !DEVICE_I2CSLAVE || !DEVICE_I2C_ASYNCH
+  #error [NOT_SUPPORTED] I2C slave is not supported
+#endif
+
+using namespace utest::v1;
+using namespace mbed::drivers::v2;
+
+/* A simulated bus: each poll() of the slave sees the request and data set up by the test, as if a master had
+ * addressed it.
+ */
+class SimBus : public detail::I2CSlaveBus {
+public:
+    SimBus() : addr(0), request(NoData), in_len(0), out_len(0), accept(0) {}
+
+    virtual void address(uint8_t address) { addr = address; }
+    virtual void frequency(uint32_t) {}
+    virtual int receive() {
+        int r = request;
+        request = NoData;
+        return r;
+    }
+    virtual int read(uint8_t *buf, size_t len) {
+        size_t n = in_len < len ? in_len : len;
+        memcpy(buf, in, n);
+        return n;
+    }
+    virtual int write(const uint8_t *buf, size_t len) {
+        out_len = accept < len ? accept : len;
+        memcpy(out, buf, out_len);
+        return out_len;
+    }
+
+    // The master writes data to the slave
+    void master_write(const void *data, size_t len) {
+        memcpy(in, data, len);
+        in_len = len;
+        request = WriteAddressed;
+    }
+    // The master reads len bytes from the slave
+    void master_read(size_t len) {
+        accept = len;
+        out_len = 0;
+        request = ReadAddressed;
+    }
+
+    uint8_t addr;
+    int request;
+    uint8_t in[32];
+    size_t in_len;
+    uint8_t out[32];
+    size_t out_len;
+    size_t accept;
+};
+
+static SimBus bus;
+static I2CSlave slave(&bus, 0x30);
+static uint8_t regs[16];
+static uint8_t seg_space[2 * sizeof(detail::I2CSegment)];
+static mbed::util::PoolAllocator seg_pool(seg_space, 2, sizeof(detail::I2CSegment));
+
+void write_done(uint8_t reg, size_t len, detail::I2CSegment *s) {
+    TEST_ASSERT_EQUAL_UINT8(4, reg);
+    TEST_ASSERT_EQUAL_INT(3, len);
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_INT(3, s->get_len());
+    // The segment holds the data as written, even though the map has changed since
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x01\x02\x03", s->get_buf(), 3);
+    TEST_ASSERT_EQUAL_UINT8(0xAA, regs[4]);
+    Harness::validate_callback();
+}
+
+control_t test_case_write() {
+    TEST_ASSERT_EQUAL_UINT8(0x30, bus.addr);
+    memset(regs, 0, sizeof(regs));
+    slave.registers(regs, sizeof(regs));
+    slave.segment_pool(&seg_pool);
+    slave.on_write(write_done);
+
+    bus.master_write("\x04\x01\x02\x03", 4);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x01\x02\x03", regs + 4, 3);
+    regs[4] = 0xAA;
+    return CaseTimeout(5 * 1000);
+}
+
+void read_done(uint8_t reg, size_t len) {
+    TEST_ASSERT_EQUAL_UINT8(2, reg);
+    TEST_ASSERT_EQUAL_INT(2, len);
+    Harness::validate_callback();
+}
+
+control_t test_case_read() {
+    for (size_t i = 0; i < sizeof(regs); i++) {
+        regs[i] = i;
+    }
+    slave.on_write(I2CSlave::write_callback_t());
+    slave.on_read(read_done);
+
+    // Set the register pointer, then read two bytes
+    bus.master_write("\x02", 1);
+    slave.poll();
+    bus.master_read(2);
+    slave.poll();
+    TEST_ASSERT_EQUAL_INT(2, bus.out_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x02\x03", bus.out, 2);
+    return CaseTimeout(5 * 1000);
+}
+
+void test_case_staged() {
+    slave.on_read(I2CSlave::read_callback_t());
+
+    // The register pointer continues from the previous read
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(4, bus.out[0]);
+
+    // A staged response is sent once, without moving the register pointer
+    slave.stage("\x5A\xA5", 2);
+    bus.master_read(2);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x5A\xA5", bus.out, 2);
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(5, bus.out[0]);
+
+    // Reads beyond the end of the map see 0xFF
+    bus.master_write("\x10", 1);
+    slave.poll();
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(0xFF, bus.out[0]);
+}
+
+void test_case_end_of_map() {
+    // A write that runs off the end of the map stores what fits and leaves the pointer at the end
+    bus.master_write("\x0E\x11\x22\x33\x44", 5);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x11\x22", regs + 14, 2);
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(0xFF, bus.out[0]);
+
+    // A read stops at the end of the map too
+    bus.master_write("\x0F", 1);
+    slave.poll();
+    bus.master_read(4);
+    slave.poll();
+    TEST_ASSERT_EQUAL_INT(1, bus.out_len);
+    TEST_ASSERT_EQUAL_UINT8(0x22, bus.out[0]);
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(0xFF, bus.out[0]);
+
+    // In a full 256-byte map the pointer wraps, as an 8-bit pointer would
+    static uint8_t full[256];
+    full[0] = 0xA0;
+    full[255] = 0xAF;
+    slave.registers(full, sizeof(full));
+    bus.master_write("\xFF", 1);
+    slave.poll();
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(0xAF, bus.out[0]);
+    bus.master_read(1);
+    slave.poll();
+    TEST_ASSERT_EQUAL_UINT8(0xA0, bus.out[0]);
+    slave.registers(regs, sizeof(regs));
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("I2C slave: register write", test_case_write, greentea_failure_handler),
+    Case("I2C slave: register read", test_case_read, greentea_failure_handler),
+    Case("I2C slave: staged response", test_case_staged, greentea_failure_handler),
+    Case("I2C slave: the register pointer at the end of the map", test_case_end_of_map, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/Poller.h"
+#include "mbed-drivers/RamFileSystem.h"
+#include "minar/minar.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+static uint32_t arena[128];
+static RamFileSystem ramfs("ram", arena, sizeof(arena));
+static Poller poller;
+static FileHandle *fh;
+
+void test_case_poll_file() {
+    FILE *f = fopen("/ram/poll.txt", "w+");
+    TEST_ASSERT_NOT_NULL(f);
+    struct pollfd fds[3] = {
+        { fileno(f), POLLIN | POLLOUT, 0 },
+        { -1, POLLIN, 0 },
+        { 99, POLLIN, 0 },
+    };
+    TEST_ASSERT_EQUAL_INT(2, poll(fds, 3, 100));
+    TEST_ASSERT_EQUAL_INT(POLLIN | POLLOUT, fds[0].revents);
+    TEST_ASSERT_EQUAL_INT(0, fds[1].revents);
+    TEST_ASSERT_EQUAL_INT(POLLNVAL, fds[2].revents);
+    fclose(f);
+}
+
+void test_case_poll_timeout() {
+    // Waiting on nothing can only end with the timeout
+    Timer t;
+    t.start();
+    TEST_ASSERT_EQUAL_INT(0, poll(NULL, 0, 50));
+    TEST_ASSERT_TRUE(t.read_ms() >= 50);
+}
+
+void on_ready(FileHandle *handle, short revents) {
+    TEST_ASSERT_EQUAL_PTR(fh, handle);
+    TEST_ASSERT_EQUAL_INT(POLLOUT, revents);
+    TEST_ASSERT_EQUAL_INT(0, poller.remove(handle));
+    fh->close();
+    Harness::validate_callback();
+}
+
+control_t test_case_poller() {
+    fh = ramfs.open("poller.txt", O_WRONLY | O_CREAT);
+    TEST_ASSERT_NOT_NULL(fh);
+    TEST_ASSERT_EQUAL_INT(0, poller.add(fh, POLLOUT, Poller::event_callback_t(on_ready)));
+    return CaseTimeout(5 * 1000);
+}
+
+static unsigned dispatched;
+
+void on_always_ready(FileHandle *, short) {
+    dispatched++;
+}
+
+void check_dispatched_once() {
+    // The file stays ready, but without a new sigio() it is not reported again
+    TEST_ASSERT_EQUAL_INT(1, dispatched);
+    TEST_ASSERT_EQUAL_INT(0, poller.remove(fh));
+    fh->close();
+    Harness::validate_callback();
+}
+
+control_t test_case_poller_edge() {
+    dispatched = 0;
+    fh = ramfs.open("edge.txt", O_WRONLY | O_CREAT);
+    TEST_ASSERT_NOT_NULL(fh);
+    TEST_ASSERT_EQUAL_INT(0, poller.add(fh, POLLOUT, Poller::event_callback_t(on_always_ready)));
+    minar::Scheduler::postCallback(check_dispatched_once).delay(minar::milliseconds(100));
+    return CaseTimeout(5 * 1000);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("poll: files are always ready", test_case_poll_file, greentea_failure_handler),
+    Case("poll: timeout", test_case_poll_timeout, greentea_failure_handler),
+    Case("Poller: dispatch from the scheduler", test_case_poller, greentea_failure_handler),
+    Case("Poller: a handle that stays ready is dispatched once", test_case_poller_edge, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/RamFileSystem.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+#define TEST_DATA_SIZE (3 * YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE + 17)
+
+static uint32_t arena[512];
+static RamFileSystem ramfs("ram", arena, sizeof(arena), 4);
+static uint8_t data[TEST_DATA_SIZE];
+static uint8_t check[TEST_DATA_SIZE];
+
+void test_case_write_read() {
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+    FILE *f = fopen("/ram/data.bin", "w+");
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(sizeof(data), fwrite(data, 1, sizeof(data), f));
+    TEST_ASSERT_EQUAL_INT(0, fseek(f, 0, SEEK_END));
+    TEST_ASSERT_EQUAL_INT(sizeof(data), ftell(f));
+    rewind(f);
+    TEST_ASSERT_EQUAL_INT(sizeof(check), fread(check, 1, sizeof(check), f));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, check, sizeof(data));
+    fclose(f);
+}
+
+void test_case_seek() {
+    FILE *f = fopen("/ram/data.bin", "r");
+    TEST_ASSERT_NOT_NULL(f);
+    // Read backwards across extent boundaries
+    for (long pos = sizeof(data) - 1; pos >= 0; pos -= 61) {
+        TEST_ASSERT_EQUAL_INT(0, fseek(f, pos, SEEK_SET));
+        TEST_ASSERT_EQUAL_INT(data[pos], fgetc(f));
+    }
+    fclose(f);
+}
+
+void test_case_map() {
+    size_t offset = YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE - 4;
+    size_t length = 100;
+    const uint8_t *p = (const uint8_t *)ramfs.map("data.bin", offset, &length);
+    TEST_ASSERT_NOT_NULL(p);
+    // Only the rest of the extent is contiguous
+    TEST_ASSERT_EQUAL_INT(4, length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[offset], p, length);
+
+    // Extents are pointer aligned
+    length = 4;
+    p = (const uint8_t *)ramfs.map("data.bin", 0, &length);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)p % sizeof(void *));
+
+    length = 100;
+    TEST_ASSERT_NULL(ramfs.map("data.bin", sizeof(data), &length));
+    TEST_ASSERT_NULL(ramfs.map("missing.bin", 0, &length));
+}
+
+void test_case_mmap() {
+    FileHandle *fh = ramfs.open("data.bin", O_RDONLY);
+    TEST_ASSERT_NOT_NULL(fh);
+
+    // Within one extent the contents are mapped in place
+    size_t length = 8;
+    const void *p = fh->mmap(1, length);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[1], p, length);
+    size_t map_length = length;
+    TEST_ASSERT_EQUAL_PTR(ramfs.map("data.bin", 1, &map_length), p);
+    TEST_ASSERT_EQUAL_INT(0, fh->munmap(p, length));
+
+    // Across extents they are copied, without moving the file position
+    length = 2 * YOTTA_CFG_MBED_DRIVERS_RAMFS_EXTENT_SIZE;
+    p = fh->mmap(10, length);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[10], p, length);
+    TEST_ASSERT_EQUAL_INT(0, fh->munmap(p, length));
+    TEST_ASSERT_EQUAL_INT(0, fh->lseek(0, SEEK_CUR));
+
+    TEST_ASSERT_NULL(fh->mmap(sizeof(data) - 4, 8));
+    fh->close();
+}
+
+void test_case_truncate_remove() {
+    size_t before = ramfs.free_space();
+    FILE *f = fopen("/ram/data.bin", "w");
+    TEST_ASSERT_NOT_NULL(f);
+    fclose(f);
+    TEST_ASSERT_TRUE(ramfs.free_space() > before);
+
+    f = fopen("/ram/data.bin", "r");
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(EOF, fgetc(f));
+    fclose(f);
+
+    TEST_ASSERT_EQUAL_INT(0, remove("/ram/data.bin"));
+    TEST_ASSERT_NULL(fopen("/ram/data.bin", "r"));
+}
+
+void test_case_full() {
+    size_t total = ramfs.free_space();
+    FILE *f = fopen("/ram/big.bin", "w");
+    TEST_ASSERT_NOT_NULL(f);
+    size_t written = 0;
+    while (written <= total) {
+        if (fwrite(data, 1, sizeof(data), f) != sizeof(data)) {
+            break;
+        }
+        written += sizeof(data);
+    }
+    fclose(f);
+    TEST_ASSERT_EQUAL_INT(0, ramfs.free_space());
+    TEST_ASSERT_EQUAL_INT(0, remove("/ram/big.bin"));
+    TEST_ASSERT_EQUAL_INT(total, ramfs.free_space());
+}
+
+void test_case_write_past_space() {
+    size_t total = ramfs.free_space();
+    FileHandle *fh = ramfs.open("gap.bin", O_RDWR | O_CREAT);
+    TEST_ASSERT_NOT_NULL(fh);
+    // A write that cannot begin within the free space takes none of it
+    TEST_ASSERT_EQUAL_INT(2 * total, fh->lseek(2 * total, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(0, fh->write(data, 1));
+    TEST_ASSERT_EQUAL_INT(total, ramfs.free_space());
+    fh->close();
+    TEST_ASSERT_EQUAL_INT(0, ramfs.remove("gap.bin"));
+}
+
+void test_case_dir() {
+    FILE *f = fopen("/ram/a.txt", "w");
+    TEST_ASSERT_NOT_NULL(f);
+    fclose(f);
+    TEST_ASSERT_EQUAL_INT(0, rename("/ram/a.txt", "/ram/b.txt"));
+
+    DIR *d = opendir("/ram");
+    TEST_ASSERT_NOT_NULL(d);
+    struct dirent *e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_STRING("b.txt", e->d_name);
+    TEST_ASSERT_NULL(readdir(d));
+    closedir(d);
+    TEST_ASSERT_EQUAL_INT(0, remove("/ram/b.txt"));
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("ramfs: write and read back", test_case_write_read, greentea_failure_handler),
+    Case("ramfs: seek across extents", test_case_seek, greentea_failure_handler),
+    Case("ramfs: zero-copy map", test_case_map, greentea_failure_handler),
+    Case("ramfs: mmap", test_case_mmap, greentea_failure_handler),
+    Case("ramfs: truncate and remove", test_case_truncate_remove, greentea_failure_handler),
+    Case("ramfs: fill the arena", test_case_full, greentea_failure_handler),
+    Case("ramfs: a write past the free space", test_case_write_past_space, greentea_failure_handler),
+    Case("ramfs: directory listing", test_case_dir, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/v2/RegisterMap.hpp"
+#include "minar/minar.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+using namespace mbed::drivers::v2;
+
+/* A simulated device: transfers complete from minar, as they do on a real bus, and are recorded so that the test
+ * can check which ones the register map made.
+ */
+class SimBus : public RegisterBus {
+public:
+    SimBus() : reads(0), writes(0) {
+        for (size_t i = 0; i < sizeof(dev); i++) {
+            dev[i] = i;
+        }
+    }
+    virtual int read(uint8_t reg, void *buf, size_t len, const done_t &done) {
+        reads++;
+        memcpy(buf, dev + reg, len);
+        minar::Scheduler::postCallback(done_t(done).bind(0));
+        return 0;
+    }
+    virtual int write(uint8_t reg, const void *buf, size_t len, const done_t &done) {
+        last_reg[writes % 4] = reg;
+        last_len[writes % 4] = len;
+        writes++;
+        memcpy(dev + reg, buf, len);
+        minar::Scheduler::postCallback(done_t(done).bind(0));
+        return 0;
+    }
+
+    uint8_t dev[32];
+    size_t reads;
+    size_t writes;
+    uint8_t last_reg[4];
+    size_t last_len[4];
+};
+
+static SimBus bus;
+static RegisterMap<32> regs(bus);
+static uint8_t buf[4];
+
+void refreshed(int status) {
+    TEST_ASSERT_EQUAL_INT(0, status);
+    TEST_ASSERT_EQUAL_INT(1, bus.reads);
+    uint8_t v;
+    TEST_ASSERT_EQUAL_INT(0, regs.get(0x12, &v));
+    TEST_ASSERT_EQUAL_UINT8(0x12, v);
+    // Registers that were not loaded cannot be updated without a bus read
+    TEST_ASSERT_EQUAL_INT(-1, regs.update(0x02, 0x01, 0x01));
+    Harness::validate_callback();
+}
+
+control_t test_case_refresh() {
+    regs.set_volatile(0x18);
+    TEST_ASSERT_EQUAL_INT(0, regs.refresh(0x10, 8, refreshed));
+    return CaseTimeout(5 * 1000);
+}
+
+void flushed(int status) {
+    TEST_ASSERT_EQUAL_INT(0, status);
+    TEST_ASSERT_FALSE(regs.is_dirty());
+    // 0x10-0x11 and 0x13-0x15 are written as two bursts
+    TEST_ASSERT_EQUAL_INT(2, bus.writes);
+    TEST_ASSERT_EQUAL_UINT8(0x10, bus.last_reg[0]);
+    TEST_ASSERT_EQUAL_INT(2, bus.last_len[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x13, bus.last_reg[1]);
+    TEST_ASSERT_EQUAL_INT(3, bus.last_len[1]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\xA0\x55", bus.dev + 0x10, 2);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\x77\x01\x02", bus.dev + 0x13, 3);
+    Harness::validate_callback();
+}
+
+control_t test_case_coalesce() {
+    TEST_ASSERT_EQUAL_INT(0, regs.update(0x10, 0xF0, 0xA0));
+    TEST_ASSERT_EQUAL_INT(0, regs.update(0x11, 0xFF, 0x55));
+    TEST_ASSERT_EQUAL_INT(0, regs.update(0x13, 0xFF, 0x77));
+    TEST_ASSERT_EQUAL_INT(0, regs.write(0x14, "\x01\x02", 2));
+    TEST_ASSERT_TRUE(regs.is_dirty());
+    regs.flush(flushed);
+    return CaseTimeout(5 * 1000);
+}
+
+void cached_read(int status) {
+    TEST_ASSERT_EQUAL_INT(0, status);
+    TEST_ASSERT_EQUAL_INT(1, bus.reads);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("\xA0\x55\x12\x77", buf, 4);
+    Harness::validate_callback();
+}
+
+control_t test_case_cached_read() {
+    TEST_ASSERT_EQUAL_INT(0, regs.read(0x10, buf, 4, cached_read));
+    return CaseTimeout(5 * 1000);
+}
+
+void volatile_read(int status) {
+    TEST_ASSERT_EQUAL_INT(0, status);
+    TEST_ASSERT_EQUAL_INT(2, bus.reads);
+    TEST_ASSERT_EQUAL_UINT8(0x99, buf[0]);
+    Harness::validate_callback();
+}
+
+control_t test_case_volatile_read() {
+    bus.dev[0x18] = 0x99;
+    TEST_ASSERT_EQUAL_INT(0, regs.read(0x18, buf, 1, volatile_read));
+    return CaseTimeout(5 * 1000);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Register map: refresh", test_case_refresh, greentea_failure_handler),
+    Case("Register map: coalesced writes", test_case_coalesce, greentea_failure_handler),
+    Case("Register map: cached read", test_case_cached_read, greentea_failure_handler),
+    Case("Register map: volatile read", test_case_volatile_read, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
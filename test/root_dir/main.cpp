@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/FileLike.h"
+#include "mbed-drivers/DirHandle.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+class NullFile : public FileLike {
+public:
+    NullFile(const char *name) : FileLike(name) {}
+
+    virtual ssize_t write(const void* buffer, size_t length) { (void)buffer; return length; }
+    virtual ssize_t read(void* buffer, size_t length) { (void)buffer, (void)length; return 0; }
+    virtual int close() { return 0; }
+    virtual int isatty() { return 0; }
+    virtual off_t lseek(off_t offset, int whence) { (void)offset, (void)whence; return 0; }
+    virtual int fsync() { return 0; }
+};
+
+static int count_entry(const char *name) {
+    int count = 0;
+    DIR *d = opendir("/");
+    TEST_ASSERT_NOT_NULL(d);
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (strcmp(e->d_name, name) == 0) {
+            count++;
+        }
+    }
+    closedir(d);
+    return count;
+}
+
+void test_case_list_once() {
+    NullFile a("dir_a"), b("dir_b"), c("dir_c");
+    TEST_ASSERT_EQUAL_INT(1, count_entry("dir_a"));
+    TEST_ASSERT_EQUAL_INT(1, count_entry("dir_b"));
+    TEST_ASSERT_EQUAL_INT(1, count_entry("dir_c"));
+}
+
+void test_case_destroy_during_iteration() {
+    NullFile a("dir_a");
+    NullFile *b = new NullFile("dir_b");
+    NullFile c("dir_c");
+
+    DIR *d = opendir("/");
+    TEST_ASSERT_NOT_NULL(d);
+    // entries are listed newest first, so dir_c comes first
+    struct dirent *e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_STRING("dir_c", e->d_name);
+
+    delete b;
+
+    e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_STRING("dir_a", e->d_name);
+    closedir(d);
+}
+
+void test_case_create_during_iteration() {
+    NullFile a("dir_a");
+
+    DIR *d = opendir("/");
+    TEST_ASSERT_NOT_NULL(d);
+    TEST_ASSERT_NOT_NULL(readdir(d));
+    {
+        // created after the iteration started, so it must not be listed
+        NullFile late("dir_late");
+        struct dirent *e;
+        while ((e = readdir(d)) != NULL) {
+            TEST_ASSERT_TRUE(strcmp(e->d_name, "dir_late") != 0);
+        }
+    }
+    closedir(d);
+}
+
+void test_case_seekdir() {
+    NullFile a("dir_a"), b("dir_b");
+
+    DIR *d = opendir("/");
+    TEST_ASSERT_NOT_NULL(d);
+    struct dirent *e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    long pos = telldir(d);
+    e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    char second[NAME_MAX + 1];
+    strcpy(second, e->d_name);
+
+    seekdir(d, pos);
+    e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_STRING(second, e->d_name);
+
+    rewinddir(d);
+    e = readdir(d);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_STRING("dir_b", e->d_name);
+    closedir(d);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Root directory: each entry listed once", test_case_list_once, greentea_failure_handler),
+    Case("Root directory: destroy during iteration", test_case_destroy_during_iteration, greentea_failure_handler),
+    Case("Root directory: create during iteration", test_case_create_during_iteration, greentea_failure_handler),
+    Case("Root directory: telldir/seekdir", test_case_seekdir, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
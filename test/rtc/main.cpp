@@ -40,8 +40,22 @@ void test_case_rtc_strftime() {
     }
 }
 
+void test_case_time_us() {
+    set_time(CUSTOM_TIME);
+    uint64_t start = time_us();
+    wait_ms(10);
+    uint64_t end = time_us();
+    TEST_ASSERT_TRUE(end - start >= 10000);
+    TEST_ASSERT_TRUE(end - start < 20000);
+    // The seconds may tick over between the two reads
+    uint32_t now = time(NULL);
+    uint32_t end_s = (uint32_t)(end / 1000000);
+    TEST_ASSERT_TRUE(now >= end_s && now - end_s <= 1);
+}
+
 Case cases[] = {
     Case("RTC strftime", test_case_rtc_strftime),
+    Case("RTC time_us", test_case_time_us),
 };
 
 status_t greentea_test_setup(const size_t number_of_cases) {
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/SamplingProfiler.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#if !defined(TOOLCHAIN_GCC)
+  #error [NOT_SUPPORTED] The sampling profiler needs GCC
+#endif
+
+using namespace utest::v1;
+
+#define CAPACITY 256
+
+static uint32_t samples[CAPACITY * 2];
+
+static void spin_ms(int ms) {
+    Timer t;
+    t.start();
+    while (t.read_ms() < ms);
+}
+
+void test_case_sample_rate() {
+    SamplingProfiler profiler(CAPACITY);
+    TEST_ASSERT_EQUAL_INT(0, profiler.start(1000, 0));
+    spin_ms(100);
+    profiler.stop();
+    size_t n = profiler.read(samples, CAPACITY);
+    TEST_ASSERT_TRUE(n >= 80 && n <= 101);
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.dropped());
+    for (size_t i = 0; i < n; i++) {
+        // Thumb code, so the PC is halfword aligned
+        TEST_ASSERT_EQUAL_UINT32(0, samples[i] & 1);
+    }
+
+    // A slower rate takes fewer samples
+    TEST_ASSERT_EQUAL_INT(0, profiler.start(1000, 0));
+    profiler.set_period(5000);
+    spin_ms(100);
+    profiler.stop();
+    n = profiler.read(samples, CAPACITY);
+    TEST_ASSERT_TRUE(n >= 15 && n <= 22);
+}
+
+void test_case_lr_and_overflow() {
+    SamplingProfiler profiler(16, true);
+    TEST_ASSERT_EQUAL_INT(0, profiler.start(1000, 0));
+    spin_ms(50);
+    profiler.stop();
+    TEST_ASSERT_EQUAL_INT(16, profiler.read(samples, CAPACITY));
+    TEST_ASSERT_TRUE(profiler.dropped() >= 25);
+    for (size_t i = 0; i < 16; i++) {
+        TEST_ASSERT_TRUE(samples[i * 2] != 0);
+    }
+}
+
+void test_case_exclusive() {
+    SamplingProfiler first(CAPACITY), second(CAPACITY);
+    TEST_ASSERT_EQUAL_INT(0, first.start(1000, 0));
+    TEST_ASSERT_EQUAL_INT(-1, second.start(1000, 0));
+    TEST_ASSERT_EQUAL_INT(-1, first.set_capacity(64));
+    first.stop();
+    TEST_ASSERT_EQUAL_INT(0, first.set_capacity(64));
+    TEST_ASSERT_EQUAL_INT(0, second.start(1000, 0));
+    second.stop();
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Sampling profiler: sample rate", test_case_sample_rate, greentea_failure_handler),
+    Case("Sampling profiler: LR samples and a full ring", test_case_lr_and_overflow, greentea_failure_handler),
+    Case("Sampling profiler: one profiler at a time", test_case_exclusive, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/SoftI2C.h"
+#include "mbed-drivers/SoftSPI.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+/* Simulated GPIO. Time only advances in delay(), so the recorded waveforms do not depend on the target. Each trace
+ * records the data line for every clock pulse as '0' or '1', plus 'S' and 'P' for I2C start and stop conditions. Reads by the master return the scripted response bits, as a slave would drive them.
+ */
+class SimLines {
+public:
+    SimLines() : now(0), edges(0), len(0), response(""), period(0), last_edge(0) {
+        trace[0] = 0;
+    }
+
+    void reset(const char *slave_bits) {
+        len = 0;
+        trace[0] = 0;
+        response = slave_bits;
+        edges = 0;
+        period = 0;
+    }
+
+    void record(char c) {
+        if (len < sizeof(trace) - 1) {
+            trace[len++] = c;
+            trace[len] = 0;
+        }
+    }
+
+    void edge() {
+        // Keep the shortest edge to edge time, which is the clock period
+        if (edges && (!period || now - last_edge < period)) {
+            period = now - last_edge;
+        }
+        last_edge = now;
+        edges++;
+    }
+
+    int respond() {
+        return *response ? *response++ - '0' : 1;
+    }
+
+    uint32_t now;
+    uint32_t edges;
+    char trace[96];
+    size_t len;
+    const char *response;
+    uint32_t period;
+    uint32_t last_edge;
+};
+
+static SimLines sim;
+
+class SimI2CPins {
+public:
+    SimI2CPins(PinName, PinName) : _sda(1), _scl(1), _bit(false) {}
+    void sda(int level) {
+        // SDA changing while SCL is high is a start or stop condition, not a bit
+        if (_scl && level != _sda) {
+            sim.record(level ? 'P' : 'S');
+            _bit = false;
+        }
+        _sda = level;
+    }
+    int sda() {
+        return sim.respond();
+    }
+    void scl(int level) {
+        if (level && !_scl) {
+            sim.edge();
+            _bit = true;
+        } else if (!level && _scl && _bit) {
+            sim.record('0' + _sda);
+            _bit = false;
+        }
+        _scl = level;
+    }
+    int scl() {
+        return _scl;
+    }
+    // Delays are counted in nanoseconds
+    uint32_t delay_count(uint32_t ns) {
+        return ns;
+    }
+    void delay(uint32_t count) {
+        sim.now += count;
+    }
+private:
+    int _sda;
+    int _scl;
+    bool _bit;
+};
+
+void test_case_i2c_write() {
+    SoftI2CEngine<SimI2CPins> i2c(NC, NC);
+    i2c.frequency(400000);
+    sim.reset("00");
+    TEST_ASSERT_EQUAL_INT(0, i2c.write(0x90, "\xA5", 1));
+    // Address 0x90, released for the ACK, 0xA5, released for the ACK
+    TEST_ASSERT_EQUAL_STRING("S" "10010000" "1" "10100101" "1" "P", sim.trace);
+    TEST_ASSERT_EQUAL_INT(2500, sim.period);
+}
+
+void test_case_i2c_read() {
+    SoftI2CEngine<SimI2CPins> i2c(NC, NC);
+    char data[1];
+    sim.reset("0" "00111100");
+    TEST_ASSERT_EQUAL_INT(0, i2c.read(0x91, data, 1));
+    TEST_ASSERT_EQUAL_UINT8(0x3C, data[0]);
+    // The master releases SDA for the slave's data, then NACKs the last byte
+    TEST_ASSERT_EQUAL_STRING("S" "10010001" "1" "11111111" "1" "P", sim.trace);
+    TEST_ASSERT_EQUAL_INT(10000, sim.period);
+}
+
+void test_case_i2c_nack() {
+    SoftI2CEngine<SimI2CPins> i2c(NC, NC);
+    sim.reset("1");
+    TEST_ASSERT_NOT_EQUAL(0, i2c.write(0x90, "\xA5", 1));
+    TEST_ASSERT_EQUAL_STRING("S" "10010000" "1" "P", sim.trace);
+}
+
+#if DEVICE_SPI
+class SimSPIPins {
+public:
+    SimSPIPins(PinName, PinName, PinName) : _mosi(0), _sclk(0) {}
+    void mosi(int level) {
+        _mosi = level;
+    }
+    int miso() {
+        return sim.respond();
+    }
+    void sclk(int level) {
+        // Modes 0 and 3 sample on the rising edge
+        if (level && !_sclk) {
+            sim.record('0' + _mosi);
+            sim.edge();
+        }
+        _sclk = level;
+    }
+    // Delays are counted in nanoseconds
+    uint32_t delay_count(uint32_t ns) {
+        return ns;
+    }
+    void delay(uint32_t count) {
+        sim.now += count;
+    }
+    int _mosi;
+    int _sclk;
+};
+
+class TestSPI : public SoftSPIEngine<SimSPIPins> {
+public:
+    TestSPI() : SoftSPIEngine<SimSPIPins>(NC, NC, NC) {}
+    int sclk() {
+        return _pins._sclk;
+    }
+};
+
+void test_case_spi_mode0() {
+    TestSPI spi;
+    spi.frequency(2000000);
+    sim.reset("11000011");
+    TEST_ASSERT_EQUAL_INT(0xC3, spi.write(0xA5));
+    TEST_ASSERT_EQUAL_STRING("10100101", sim.trace);
+    TEST_ASSERT_EQUAL_INT(500, sim.period);
+    TEST_ASSERT_EQUAL_INT(0, spi.sclk());
+}
+
+void test_case_spi_mode3() {
+    TestSPI spi;
+    spi.format(12, 3, SPI_LSB);
+    TEST_ASSERT_EQUAL_INT(1, spi.sclk());
+    sim.reset("101000000001");
+    TEST_ASSERT_EQUAL_INT(0x805, spi.write(0x0F1));
+    TEST_ASSERT_EQUAL_STRING("100011110000", sim.trace);
+    TEST_ASSERT_EQUAL_INT(1, spi.sclk());
+}
+#endif
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Soft I2C: write waveform", test_case_i2c_write, greentea_failure_handler),
+    Case("Soft I2C: read waveform", test_case_i2c_read, greentea_failure_handler),
+    Case("Soft I2C: address NACK", test_case_i2c_nack, greentea_failure_handler),
+#if DEVICE_SPI
+    Case("Soft SPI: mode 0", test_case_spi_mode0, greentea_failure_handler),
+    Case("Soft SPI: mode 3, LSB first", test_case_spi_mode3, greentea_failure_handler),
+#endif
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
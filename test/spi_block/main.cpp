@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "mbed-drivers/mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#if !DEVICE_SPI || !defined(YOTTA_CFG_HARDWARE_TEST_PINS_SPI_MOSI)
+  #error [NOT_SUPPORTED] No SPI test pins are configured
+#endif
+
+using namespace utest::v1;
+
+#define BLOCK_SIZE 1024
+
+// Nothing needs to be connected: the master clocks the data out whether or not a slave answers
+static SPI spi(YOTTA_CFG_HARDWARE_TEST_PINS_SPI_MOSI, YOTTA_CFG_HARDWARE_TEST_PINS_SPI_MISO,
+               YOTTA_CFG_HARDWARE_TEST_PINS_SPI_SCLK);
+static uint8_t tx[BLOCK_SIZE];
+static uint8_t rx[BLOCK_SIZE];
+
+void test_case_block_frames() {
+    spi.format(8);
+    TEST_ASSERT_EQUAL_INT(16, spi.write(tx, rx, 16));
+    TEST_ASSERT_EQUAL_INT(16, spi.write(NULL, NULL, 16));
+    spi.format(16);
+    TEST_ASSERT_EQUAL_INT(8, spi.write(tx, NULL, 16));
+    TEST_ASSERT_EQUAL_INT(-1, spi.write(tx, rx, 15));
+    // Buffers need not be aligned to the frame size
+    TEST_ASSERT_EQUAL_INT(8, spi.write(tx + 1, rx + 1, 16));
+    spi.format(8);
+}
+
+void test_case_block_throughput() {
+    Timer t;
+    spi.frequency(8000000);
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        tx[i] = i;
+    }
+
+    t.start();
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        rx[i] = spi.write(tx[i]);
+    }
+    int word_us = t.read_us();
+
+    t.reset();
+    TEST_ASSERT_EQUAL_INT(BLOCK_SIZE, spi.write(tx, rx, BLOCK_SIZE));
+    int block_us = t.read_us();
+    t.stop();
+
+    printf("MBED: per-word %d bytes/s, block %d bytes/s\r\n",
+           (int)(BLOCK_SIZE * 1000000LL / (word_us ? word_us : 1)),
+           (int)(BLOCK_SIZE * 1000000LL / (block_us ? block_us : 1)));
+    // The block write should be no slower, give or take a tenth for the timer and interrupts
+    TEST_ASSERT_TRUE(block_us <= word_us + word_us / 10);
+}
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("SPI block write: frame packing", test_case_block_frames, greentea_failure_handler),
+    Case("SPI block write: throughput against write(int)", test_case_block_throughput, greentea_failure_handler),
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}
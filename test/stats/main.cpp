@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "mbed-drivers/mbed.h"
+#include "mbed-drivers/StatsFileSystem.h"
+#include "mbed-drivers/v2/I2C.hpp"
+#include "minar/minar.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+using namespace utest::v1;
+
+static StatsFileSystem stats;
+static mbed_stats_t group = MBED_STATS_INIT("test");
+static char text[YOTTA_CFG_MBED_DRIVERS_STATS_SNAPSHOT_SIZE];
+
+void test_case_counters() {
+    TEST_ASSERT_NULL(mbed_stats_find("test"));
+    mbed_stats_add(&group, MBED_STATS_TRANSFERS, 1);
+    TEST_ASSERT_EQUAL_PTR(&group, mbed_stats_find("test"));
+    mbed_stats_add(&group, MBED_STATS_TRANSFERS, 2);
+    mbed_stats_add(&group, MBED_STATS_BYTES, 300);
+    mbed_stats_max(&group, MBED_STATS_QUEUE_HIGH_WATER, 4);
+    mbed_stats_max(&group, MBED_STATS_QUEUE_HIGH_WATER, 2);
+    mbed_stats_add(&group, MBED_STATS_LATENCY_US, 250);
+    mbed_stats_add(&group, MBED_STATS_COMPLETIONS, 2);
+    TEST_ASSERT_EQUAL_UINT32(3, group.counters[MBED_STATS_TRANSFERS]);
+    TEST_ASSERT_EQUAL_UINT32(300, group.counters[MBED_STATS_BYTES]);
+    TEST_ASSERT_EQUAL_UINT32(4, group.counters[MBED_STATS_QUEUE_HIGH_WATER]);
+
+    int n = mbed_stats_format(&group, text, sizeof(text));
+    TEST_ASSERT_EQUAL_INT(strlen(text), n);
+    TEST_ASSERT_NOT_NULL(strstr(text, "transfers 3\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "queue_high_water 4\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "latency_avg_us 125\n"));
+
+    // A short buffer is truncated, as for snprintf
+    char small[8];
+    TEST_ASSERT_EQUAL_INT(n, mbed_stats_format(&group, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("transfe", small);
+}
+
+void test_case_file() {
+    FILE *f = fopen("/stats/test", "r");
+    TEST_ASSERT_NOT_NULL(f);
+    // The file is a snapshot, so later updates are not seen
+    mbed_stats_add(&group, MBED_STATS_ERRORS, 1);
+    char line[32];
+    bool found = false;
+    while (fgets(line, sizeof(line), f)) {
+        found |= strcmp(line, "errors 0\n") == 0;
+    }
+    TEST_ASSERT_TRUE(found);
+    fclose(f);
+
+    TEST_ASSERT_NULL(fopen("/stats/missing", "r"));
+    TEST_ASSERT_NULL(fopen("/stats/test", "w"));
+}
+
+void test_case_list() {
+    DIR *d = opendir("/stats");
+    TEST_ASSERT_NOT_NULL(d);
+    bool found = false;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        found |= strcmp(e->d_name, "test") == 0;
+    }
+    closedir(d);
+    TEST_ASSERT_TRUE(found);
+}
+
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+static void fire() {
+}
+
+void test_case_ticker() {
+    Timeout timeout;
+    timeout.attach_us(fire, 1000);
+    wait_ms(10);
+    mbed_stats_t *ticker = mbed_stats_find("ticker");
+    TEST_ASSERT_NOT_NULL(ticker);
+    uint32_t fired = ticker->counters[MBED_STATS_TRANSFERS];
+    TEST_ASSERT_TRUE(fired >= 1);
+    TEST_ASSERT_TRUE(ticker->counters[MBED_STATS_QUEUE_HIGH_WATER] >= 1);
+    timeout.attach_us(fire, 1000);
+    wait_ms(10);
+    TEST_ASSERT_TRUE(ticker->counters[MBED_STATS_TRANSFERS] > fired);
+}
+
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+using namespace mbed::drivers::v2;
+
+/* A resource manager that completes every transaction from minar, as if the device were present */
+class InstantI2C : public detail::I2CResourceManager {
+public:
+    InstantI2C() {
+        strcpy(_stats_name, "i2ctest");
+    }
+    virtual I2CError init(PinName, PinName) {
+        return I2CError::None;
+    }
+    virtual void release() {}
+
+protected:
+    virtual I2CError start_transaction() {
+        _TransactionQueue->reset_current();
+        return start_segment();
+    }
+    virtual I2CError start_segment() {
+        minar::Scheduler::postCallback(mbed::util::FunctionPointer(this, &InstantI2C::complete).bind());
+        return I2CError::None;
+    }
+    virtual I2CError validate_transaction(I2CTransaction *) const {
+        return I2CError::None;
+    }
+    void complete() {
+        process_event(I2C_EVENT_TRANSFER_COMPLETE);
+    }
+};
+
+static InstantI2C instant_i2c;
+static mbed::drivers::v2::I2C instant(NC, NC, instant_i2c);
+
+void ping_done(I2CTransaction *, uint32_t event) {
+    TEST_ASSERT_EQUAL_INT(I2C_EVENT_TRANSFER_COMPLETE, event);
+    mbed_stats_t *s = mbed_stats_find("i2ctest");
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_UINT32(1, s->counters[MBED_STATS_TRANSFERS]);
+    TEST_ASSERT_EQUAL_UINT32(0, s->counters[MBED_STATS_BYTES]);
+    Harness::validate_callback();
+}
+
+control_t test_case_i2c_ping() {
+    // A transaction without segments is a ping, which has no bytes to count
+    TEST_ASSERT_TRUE(I2CError::None == instant.transfer_to(0x90).on(I2C_EVENT_ALL, ping_done).apply());
+    return CaseTimeout(5 * 1000);
+}
+#endif
+#endif
+
+status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Stats: counters and their text", test_case_counters, greentea_failure_handler),
+    Case("Stats: a group read as a file", test_case_file, greentea_failure_handler),
+    Case("Stats: the groups listed as a directory", test_case_list, greentea_failure_handler),
+#if YOTTA_CFG_MBED_DRIVERS_STATS
+    Case("Stats: the ticker queue counts events", test_case_ticker, greentea_failure_handler),
+#if DEVICE_I2C && DEVICE_I2C_ASYNCH
+    Case("Stats: an I2C ping counts no bytes", test_case_i2c_ping, greentea_failure_handler),
+#endif
+#endif
+};
+
+status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+void app_start(int, char*[]) {
+    Harness::run(specification);
+}